@@ -1,3 +1,9 @@
+if (NOT RandBLAS_PARALLEL_BACKEND STREQUAL "OpenMP")
+    # Shadow any cached value so that config.h doesn't define RandBLAS_HAS_OpenMP.
+    set(RandBLAS_HAS_OpenMP FALSE)
+    return()
+endif()
+
 message(STATUS "Checking for OpenMP ... ")
 find_package(OpenMP COMPONENTS CXX)
 
@@ -0,0 +1,9 @@
+set(RandBLAS_HAS_TBB FALSE)
+if (NOT RandBLAS_PARALLEL_BACKEND STREQUAL "TBB")
+    return()
+endif()
+
+message(STATUS "Checking for TBB ... ")
+find_package(TBB REQUIRED COMPONENTS tbb)
+set(RandBLAS_HAS_TBB TRUE)
+message(STATUS "Checking for TBB ... ${TBB_VERSION}")
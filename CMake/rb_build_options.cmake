@@ -11,6 +11,10 @@ endif()
 
 set(SANITIZE_ADDRESS OFF CACHE BOOL "Add address sanitizer flags to the library")
 
+set(RandBLAS_PARALLEL_BACKEND "OpenMP" CACHE STRING
+  "Runtime for RandBLAS' parallel loops, options are: OpenMP TBB Serial.")
+set_property(CACHE RandBLAS_PARALLEL_BACKEND PROPERTY STRINGS "OpenMP" "TBB" "Serial")
+
 include(GNUInstallDirs)
 
 set(CMAKE_ARCHIVE_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/${CMAKE_INSTALL_LIBDIR}")
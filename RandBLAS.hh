@@ -32,12 +32,25 @@
 
 #include <RandBLAS/config.h>
 #include <RandBLAS/base.hh>
+#include <RandBLAS/parallel.hh>
 #include <RandBLAS/util.hh>
 #include <RandBLAS/sparse_skops.hh>
+#include <RandBLAS/compact_skops.hh>
 #include <RandBLAS/dense_skops.hh>
 #include <RandBLAS/skge.hh>
 #include <RandBLAS/skve.hh>
 #include <RandBLAS/sksy.hh>
 #include <RandBLAS/sparse_data/sksp.hh>
+#include <RandBLAS/async.hh>
+#include <RandBLAS/skop_cache.hh>
+#include <RandBLAS/rng_streams.hh>
+#include <RandBLAS/features.hh>
+#include <RandBLAS/quantized.hh>
+#include <RandBLAS/linops.hh>
+#include <RandBLAS/leverage.hh>
+#include <RandBLAS/gram.hh>
+#include <RandBLAS/nystrom.hh>
+#include <RandBLAS/interp_decomp.hh>
+#include <RandBLAS/kaczmarz.hh>
 
 #endif
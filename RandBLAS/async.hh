@@ -0,0 +1,270 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/skge.hh"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace RandBLAS::async {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// A fixed-size pool of worker threads that runs RandBLAS' asynchronous functions.
+///
+/// Tasks run in the order they were submitted when the pool has one worker.
+/// Each task may still use several threads internally, since RandBLAS' own
+/// parallel regions follow the ExecPolicy that was passed to the asynchronous call.
+///
+/// The destructor finishes every task that was submitted before it was called,
+/// and then joins the workers.
+///
+/// @endverbatim
+class ThreadPool {
+    public:
+
+    // ---------------------------------------------------------------------------
+    /// Start a pool with num_workers threads. We require num_workers > 0.
+    explicit ThreadPool(int num_workers = 1) {
+        randblas_require(num_workers > 0);
+        workers.reserve(num_workers);
+        for (int i = 0; i < num_workers; ++i)
+            workers.emplace_back([this]() { this->work(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        // One extra token per worker; a worker that wakes to an empty queue exits.
+        pending.release((std::ptrdiff_t) workers.size());
+        for (auto &w : workers)
+            w.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // ---------------------------------------------------------------------------
+    /// Queue f for execution on a worker thread. The returned future holds f's
+    /// return value, or the exception that f threw.
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(F &&f) {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> out = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            randblas_require(!stopping);
+            tasks.emplace_back([task]() { (*task)(); });
+        }
+        pending.release();
+        return out;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of worker threads in this pool.
+    int num_workers() const { return (int) workers.size(); }
+
+    private:
+    void work() {
+        while (true) {
+            pending.acquire();
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::counting_semaphore<> pending{0};
+    bool stopping = false;
+};
+
+// -----------------------------------------------------------------------------
+/// The pool used by RandBLAS' asynchronous functions when none is given.
+/// It has a single worker, so work queued from one thread completes in order.
+inline ThreadPool &default_pool() {
+    static ThreadPool pool(1);
+    return pool;
+}
+
+// -----------------------------------------------------------------------------
+/// A policy that inherits from the calling thread's policy would lose that
+/// context on a worker thread, so we resolve it before handing off.
+inline ExecPolicy resolve(const ExecPolicy &exec) {
+    return exec.inherits() ? exec::current_policy() : exec;
+}
+
+} // end namespace RandBLAS::async
+
+
+namespace RandBLAS {
+
+// MARK: asynchronous sampling
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Asynchronous version of :math:`\ttt{fill_dense(D, buff, seed, exec)}.`
+///
+/// The returned future holds the state that :math:`\ttt{fill_dense}` would have returned.
+/// The contents of :math:`\ttt{buff}` are the same as those from a synchronous call.
+/// The caller must not access :math:`\ttt{buff}` until the future is ready.
+///
+/// If "exec" inherits its settings, then the calling thread's current ExecPolicy is used.
+/// The work runs on "pool", which defaults to async::default_pool().
+/// @endverbatim
+template <typename T, typename RNG = DefaultRNG>
+std::future<RNGState<RNG>> fill_dense_async(
+    const DenseDist &D, T *buff, const RNGState<RNG> &seed,
+    const ExecPolicy &exec = {}, async::ThreadPool &pool = async::default_pool()
+) {
+    ExecPolicy policy = async::resolve(exec);
+    return pool.submit([D, buff, seed, policy]() {
+        return fill_dense(D, buff, seed, policy);
+    });
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Asynchronous version of :math:`\ttt{fill_dense(S, exec)}.`
+///
+/// This lets the operator for a later iteration of an algorithm be sampled while
+/// the caller works with the sketch from the current iteration.
+/// The caller must keep :math:`\ttt{S}` alive, and must not access it, until the future is ready.
+/// @endverbatim
+template <typename DenseSkOp>
+std::future<void> fill_dense_async(
+    DenseSkOp &S, const ExecPolicy &exec = {}, async::ThreadPool &pool = async::default_pool()
+) {
+    ExecPolicy policy = async::resolve(exec);
+    DenseSkOp *S_ptr = &S;
+    return pool.submit([S_ptr, policy]() {
+        fill_dense(*S_ptr, policy);
+    });
+}
+
+// MARK: asynchronous sketching
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Asynchronous version of the left-sketching overload of sketch_general.
+///
+/// The arguments have the same meaning as in the synchronous call. :math:`\ttt{S},`
+/// :math:`\ttt{A},` and :math:`\ttt{B}` must remain valid until the returned future
+/// is ready, and the caller must not write to any of them (or read :math:`\ttt{B}`)
+/// before then. Exceptions raised by the sketch are rethrown by the future's get().
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+std::future<void> sketch_general_async(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *A,
+    int64_t lda,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    async::ThreadPool &pool = async::default_pool()
+) {
+    ExecPolicy policy = async::resolve(exec);
+    SKOP *S_ptr = &S;
+    return pool.submit([=]() {
+        sketch_general(layout, opS, opA, d, n, m, alpha, *S_ptr, ro_s, co_s, A, lda, beta, B, ldb, policy);
+    });
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Asynchronous version of the right-sketching overload of sketch_general.
+///
+/// The same lifetime requirements apply as for the left-sketching version.
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+std::future<void> sketch_general_async(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(submat(\mtxS)) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    const T *A,
+    int64_t lda,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    async::ThreadPool &pool = async::default_pool()
+) {
+    ExecPolicy policy = async::resolve(exec);
+    SKOP *S_ptr = &S;
+    return pool.submit([=]() {
+        sketch_general(layout, opA, opS, m, d, n, alpha, A, lda, *S_ptr, ro_s, co_s, beta, B, ldb, policy);
+    });
+}
+
+} // end namespace RandBLAS
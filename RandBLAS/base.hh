@@ -35,6 +35,9 @@
 #include "RandBLAS/random_gen.hh"
 
 #include <blas.hh>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <cstring>
 #include <cstdint>
@@ -43,6 +46,9 @@
 #if defined(RandBLAS_HAS_OpenMP)
 #include <omp.h>
 #endif
+#if defined(RandBLAS_HAS_TBB)
+#include <tbb/task_arena.h>
+#endif
 
 #include<iostream>
 
@@ -50,7 +56,28 @@
 /// code common across the project
 namespace RandBLAS {
 
+/// The CBRNG that RandBLAS uses when none is specified: Philox4x32 with 10 rounds.
 typedef r123::Philox4x32 DefaultRNG;
+
+// -----------------------------------------------------------------------------
+// Cheaper generators. Salmon et al. (SC '11) report that each of these passes
+// TestU01's BigCrush battery, but with a smaller safety margin than Random123's
+// defaults. Any of them can be used in place of DefaultRNG.
+
+/// Philox4x32 with 7 rounds instead of 10.
+typedef r123::Philox4x32_R<7> Philox4x32_7;
+
+/// Threefry4x32 with 13 rounds instead of 20.
+typedef r123::Threefry4x32_R<13> Threefry4x32_13;
+
+#if R123_USE_AES_NI
+/// Random123's ARS generator (7 rounds) built on AES-NI instructions. This is only
+/// defined when the compiler targets a CPU with AES-NI.
+typedef r123::ARS4x32_R<7> ARS4x32;
+
+/// ARS with 5 rounds, the fewest that Salmon et al. found to pass BigCrush.
+typedef r123::ARS4x32_R<5> ARS4x32_5;
+#endif
 using std::uint64_t;
 
 /// -------------------------------------------------------------------
@@ -66,8 +93,9 @@ struct RNGState {
 
     /// -------------------------------------------------------------------
     /// Type of the underlying Random123 CBRNG. Must be based on 
-    /// Philox or Threefry. We've found that Philox works best for our 
-    /// purposes, and we default to Philox4x32.
+    /// Philox, Threefry, or (when compiled with AES-NI) ARS, with any
+    /// number of rounds that Random123 supports. We default to Philox4x32.
+    /// See Philox4x32_7, Threefry4x32_13, and ARS4x32 for faster options.
     using generator = RNG;
     
     using ctr_type = typename RNG::ctr_type;
@@ -158,7 +186,7 @@ struct RNGState {
     };
 
     bool operator!=(const RNGState<RNG> &s) const {
-        return !(this == s);
+        return !(*this == s);
     };
 
 };
@@ -304,6 +332,140 @@ inline int64_t get_dim_major(Axis major_axis, int64_t n_rows, int64_t n_cols) {
 }
 
 
+// MARK: execution policy
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// Per-call control over the threading used in RandBLAS' own parallel regions,
+/// and over how sparse-times-dense products balance their work.
+///
+/// By default, RandBLAS' OpenMP regions use as many threads as OpenMP would
+/// give them (typically :math:`\ttt{OMP_NUM_THREADS}`). That's a poor choice when an
+/// application runs several independent sketches concurrently, since each
+/// sketch would try to occupy every core. Passing an ExecPolicy to a function
+/// that accepts one caps the number of threads used for that call only.
+///
+/// ExecPolicy objects are aggregates. For example, you can write
+/// :math:`\ttt{ExecPolicy\{4\}}` to request four threads, or
+/// :math:`\ttt{ExecPolicy\{0, true\}}` to request serial execution.
+///
+/// When RandBLAS is configured with its TBB backend, a positive thread count
+/// runs the call inside a :math:`\ttt{tbb::task_arena}` of that size.
+///
+/// Thread placement is left to the OpenMP runtime. Use
+/// :math:`\ttt{OMP_PLACES}` and :math:`\ttt{OMP_PROC_BIND}` if you need
+/// threads pinned to specific cores.
+///
+/// This policy has no influence on the BLAS library that RandBLAS links to.
+/// Consult your BLAS vendor's documentation for how to control its threading.
+///
+/// @endverbatim
+struct ExecPolicy {
+    // ---------------------------------------------------------------------------
+    /// The number of threads for RandBLAS' parallel regions. If zero (the default)
+    /// then we defer to the value used by OpenMP or the enclosing ExecPolicy.
+    int num_threads = 0;
+
+    // ---------------------------------------------------------------------------
+    /// If true, then all RandBLAS work runs on the calling thread,
+    /// regardless of the value of num_threads.
+    bool serial = false;
+
+    // ---------------------------------------------------------------------------
+    /// Returns true if this policy defers all decisions to its caller.
+    bool inherits() const { return num_threads <= 0 && !serial; }
+};
+
+namespace exec {
+
+inline ExecPolicy &current_policy() {
+    thread_local ExecPolicy policy{};
+    return policy;
+}
+
+/// Installs an ExecPolicy for the calling thread until the end of the
+/// enclosing scope. A policy that inherits() leaves the current one in place,
+/// so nested calls made inside RandBLAS don't undo the caller's choices.
+class ScopedPolicy {
+    public:
+    ScopedPolicy(const ExecPolicy &policy) : prev(current_policy()), active(!policy.inherits()) {
+        if (active)
+            current_policy() = policy;
+    }
+    ~ScopedPolicy() {
+        if (active)
+            current_policy() = prev;
+    }
+    ScopedPolicy(const ScopedPolicy &) = delete;
+    ScopedPolicy &operator=(const ScopedPolicy &) = delete;
+
+    private:
+    const ExecPolicy prev;
+    const bool active;
+};
+
+/// The number of threads that the next parallel region opened by the
+/// calling thread should use.
+inline int num_threads() {
+    const ExecPolicy &policy = current_policy();
+    if (policy.serial)
+        return 1;
+    #if defined(RandBLAS_HAS_TBB)
+    return (policy.num_threads > 0) ? policy.num_threads : tbb::this_task_arena::max_concurrency();
+    #elif defined(RandBLAS_HAS_OpenMP)
+    return (policy.num_threads > 0) ? policy.num_threads : omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+}
+
+} // end namespace RandBLAS::exec
+
+// MARK: lazy filling
+
+// =============================================================================
+/// Runs a sketching operator's fill routine at most once, even when many
+/// threads ask for it at the same time. The first caller does the work (using
+/// RandBLAS' usual parallel regions); the others block until it's done and then
+/// reuse the result. If the fill routine throws, the next caller tries again.
+///
+/// See enable_lazy_fill.
+class FillOnce {
+    public:
+    template <typename Fill>
+    void run(Fill &&fill) {
+        if (done.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (done.load(std::memory_order_relaxed))
+            return;
+        fill();
+        done.store(true, std::memory_order_release);
+    }
+
+    bool finished() const { return done.load(std::memory_order_acquire); }
+
+    private:
+    std::atomic<bool> done{false};
+    std::mutex mtx;
+};
+
+// =============================================================================
+/// Put a DenseSkOp or SparseSkOp into lazy-fill mode. In this mode the first
+/// RandBLAS function that needs the operator's data fills it in place, and any
+/// other threads that need it concurrently wait for that fill instead of
+/// sampling their own temporary copies. Calling this on an operator that's
+/// already filled has no effect on its data.
+///
+/// This must be called before the operator is shared between threads.
+template <typename SKOP>
+void enable_lazy_fill(SKOP &S) {
+    S.lazy_fill = std::make_shared<FillOnce>();
+    return;
+}
+
+
 #ifdef __cpp_concepts
 // =============================================================================
 /// @verbatim embed:rst:leading-slashes
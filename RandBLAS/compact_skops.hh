@@ -0,0 +1,386 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/sparse_skops.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// A compact representation of a short-axis-major SparseSkOp.
+///
+/// A SparseSkOp stores three arrays of length :math:`\ttt{full_nnz}` (row indices, column
+/// indices, and values). For a short-axis-major distribution two of those are redundant.
+/// The minor index of the :math:`\ell^{\text{th}}` nonzero is :math:`\lfloor \ell / \vecnnz \rfloor`,
+/// and every value is :math:`\pm 1.` This type stores only the major-axis indices, using
+/// index type :math:`\ttt{idx_t}` (int32_t by default), and a bitmap of signs.
+/// With double-precision values and 64-bit indices that's about six times less
+/// memory than a SparseSkOp.
+///
+/// An operator of this type represents exactly the same matrix as a SparseSkOp with the same
+/// distribution and seed state. It conforms to the SketchingOperator concept, and it's
+/// accepted by sketch_general, which applies it directly from the compact data.
+/// @endverbatim
+template <typename T, typename RNG = DefaultRNG, SignedInteger idx_t = int32_t>
+struct CompactSparseSkOp {
+
+    // ---------------------------------------------------------------------------
+    /// Type alias.
+    using distribution_t = SparseDist;
+
+    // ---------------------------------------------------------------------------
+    /// Type alias.
+    using state_t = RNGState<RNG>;
+
+    // ---------------------------------------------------------------------------
+    /// Real scalar type of the operator's nonzeros.
+    using scalar_t = T;
+
+    // ---------------------------------------------------------------------------
+    /// Signed integer type used for major-axis indices.
+    using index_t = idx_t;
+
+    // ---------------------------------------------------------------------------
+    ///  The distribution from which this operator is sampled. Its major axis must be Short.
+    const SparseDist dist;
+
+    // ---------------------------------------------------------------------------
+    ///  The state passed to random sampling functions when the full
+    ///  operator needs to be sampled from scratch.
+    const state_t seed_state;
+
+    // ---------------------------------------------------------------------------
+    ///  The state that should be used in the next call to a random sampling function
+    ///  whose output should be statistically independent from properties of this
+    ///  operator.
+    const state_t next_state;
+
+    // ---------------------------------------------------------------------------
+    ///  Alias for dist.n_rows.
+    const int64_t n_rows;
+
+    // ---------------------------------------------------------------------------
+    ///  Alias for dist.n_cols.
+    const int64_t n_cols;
+
+    // ---------------------------------------------------------------------------
+    ///  If true at destruction time, then delete [] is called on idxs_major and sign_bits.
+    bool own_memory;
+
+    // ---------------------------------------------------------------------------
+    ///  The number of structural nonzeros, or -1 if the operator hasn't been sampled yet.
+    int64_t nnz;
+
+    // ---------------------------------------------------------------------------
+    ///  The major-axis index of each nonzero. Nonzero \math{\ell} belongs to the minor-axis
+    ///  vector with index \math{\lfloor \ell / \vecnnz \rfloor.} If non-null, this must point
+    ///  to an array of length at least dist.full_nnz.
+    idx_t *idxs_major;
+
+    // ---------------------------------------------------------------------------
+    ///  Bit \math{\ell \bmod 64} of \math{\ttt{sign_bits}[\lfloor \ell / 64 \rfloor]} is set
+    ///  if nonzero \math{\ell} equals \math{-1,} and clear if it equals \math{+1.} If non-null,
+    ///  this must point to an array of length at least \math{\lceil \ttt{dist.full_nnz} / 64 \rceil.}
+    uint64_t *sign_bits;
+
+    // ---------------------------------------------------------------------------
+    ///  **Standard constructor**. own_memory is initialized to true, nnz is initialized to -1,
+    ///  and (idxs_major, sign_bits) are initialized to nullptr. Memory is attached when
+    ///  fill_sparse(CompactSparseSkOp &S) is called.
+    CompactSparseSkOp(
+        SparseDist dist,
+        const state_t &seed_state
+    ) : dist(dist),
+        seed_state(seed_state),
+        next_state(compute_next_state(dist, seed_state)),
+        n_rows(dist.n_rows), n_cols(dist.n_cols),
+        own_memory(true), nnz(-1), idxs_major(nullptr), sign_bits(nullptr) {
+        randblas_require(dist.major_axis == Axis::Short);
+        randblas_require(dist.dim_major - 1 <= (int64_t) std::numeric_limits<idx_t>::max());
+    }
+
+    //  Move constructor
+    CompactSparseSkOp(CompactSparseSkOp<T, RNG, idx_t> &&S
+    ) : dist(S.dist), seed_state(S.seed_state), next_state(S.next_state),
+        n_rows(dist.n_rows), n_cols(dist.n_cols), own_memory(S.own_memory),
+        nnz(S.nnz), idxs_major(S.idxs_major), sign_bits(S.sign_bits) {
+        S.idxs_major = nullptr;
+        S.sign_bits = nullptr;
+        S.nnz = -1;
+    }
+
+    //  Destructor
+    ~CompactSparseSkOp() {
+        if (own_memory) {
+            if (idxs_major != nullptr) delete [] idxs_major;
+            if (sign_bits  != nullptr) delete [] sign_bits;
+        }
+    }
+
+    // ---------------------------------------------------------------------------
+    ///  The number of 64-bit words needed for sign_bits.
+    int64_t num_sign_words() const {
+        return (dist.full_nnz + 63) / 64;
+    }
+};
+
+#ifdef __cpp_concepts
+static_assert(SketchingOperator<CompactSparseSkOp<float>>);
+static_assert(SketchingOperator<CompactSparseSkOp<double>>);
+#endif
+
+// =============================================================================
+/// Sample the compact representation of \math{\ttt{S}.} If \math{\ttt{S.own_memory}} is true
+/// then any null reference member is redirected to newly allocated memory. The result
+/// matches what fill_sparse would produce for a SparseSkOp with the same distribution
+/// and seed state.
+template <typename T, typename RNG, SignedInteger idx_t>
+void fill_sparse(CompactSparseSkOp<T, RNG, idx_t> &S, const ExecPolicy &exec = {}) {
+    exec::ScopedPolicy scoped_policy(exec);
+    int64_t full_nnz = S.dist.full_nnz;
+    int64_t num_words = S.num_sign_words();
+    if (S.own_memory) {
+        if (S.idxs_major == nullptr) S.idxs_major = new idx_t[full_nnz];
+        if (S.sign_bits  == nullptr) S.sign_bits  = new uint64_t[num_words];
+    }
+    randblas_require(S.idxs_major != nullptr);
+    randblas_require(S.sign_bits  != nullptr);
+    std::fill(S.sign_bits, S.sign_bits + num_words, (uint64_t) 0);
+    sparse::repeated_fisher_yates(
+        S.seed_state, S.dist.vec_nnz, S.dist.dim_major, S.dist.dim_minor,
+        S.idxs_major, (idx_t *) nullptr, (T *) nullptr, S.sign_bits
+    );
+    S.nnz = full_nnz;
+}
+
+} // end namespace RandBLAS
+
+
+namespace RandBLAS::sparse {
+
+// Compute B = alpha * op(submat(S)) * op(mat(A)) + beta * B directly from the compact
+// representation of S. The work is split across columns of B, so threads never write
+// to the same entry of B.
+template <typename T, typename CompactSkOp>
+void lskges_compact(
+    blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+    T alpha, const CompactSkOp &S, int64_t ro_s, int64_t co_s,
+    const T *A, int64_t lda, T beta, T *B, int64_t ldb
+) {
+    auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
+    randblas_require(ro_s + rows_submat_S <= S.n_rows);
+    randblas_require(co_s + cols_submat_S <= S.n_cols);
+    randblas_require(S.nnz >= 0);
+    auto [a_row, a_col] = layout_to_strides(layout, lda);
+    if (opA == blas::Op::Trans)
+        std::swap(a_row, a_col);
+    auto [b_row, b_col] = layout_to_strides(layout, ldb);
+    // Now op(mat(A))[k, j] = A[k * a_row + j * a_col] and mat(B)[i, j] = B[i * b_row + j * b_col].
+
+    const int64_t vec_nnz = S.dist.vec_nnz;
+    const int64_t dim_minor = S.dist.dim_minor;
+    const bool major_is_row = S.n_rows <= S.n_cols;
+    const typename CompactSkOp::index_t *idxs_major = S.idxs_major;
+    const uint64_t *sign_bits = S.sign_bits;
+    const bool rows_contiguous = (b_col == 1) && (a_col == 1);
+
+    // Call f(i, k, coeff) for each nonzero of op(submat(S)), where i is its row,
+    // k is its column, and coeff is alpha times its value. VEC_NNZ is either vec_nnz
+    // or zero; in the former case the loop over a major-axis vector has a compile-time
+    // trip count.
+    // Only minor-axis vectors in [v_lo, v_hi) can intersect submat(S).
+    const int64_t v_lo = (major_is_row) ? co_s : ro_s;
+    const int64_t v_hi = std::min(dim_minor, v_lo + ((major_is_row) ? cols_submat_S : rows_submat_S));
+    auto for_each_nonzero = [&]<int64_t VEC_NNZ>(std::integral_constant<int64_t, VEC_NNZ>, auto &&f) {
+        constexpr bool fixed = VEC_NNZ > 0;
+        const int64_t nnz_per_vec = (fixed) ? VEC_NNZ : vec_nnz;
+        for (int64_t v = v_lo; v < v_hi; ++v) {
+            for (int64_t t = 0; t < nnz_per_vec; ++t) {
+                int64_t ell = v * nnz_per_vec + t;
+                int64_t major = (int64_t) idxs_major[ell];
+                int64_t r = ((major_is_row) ? major : v) - ro_s;
+                int64_t c = ((major_is_row) ? v : major) - co_s;
+                if (r < 0 || r >= rows_submat_S || c < 0 || c >= cols_submat_S)
+                    continue;
+                bool negative = (sign_bits[ell / 64] >> (ell % 64)) & 1;
+                T coeff = (negative) ? -alpha : alpha;
+                if (opS == blas::Op::NoTrans) {
+                    f(r, c, coeff);
+                } else {
+                    f(c, r, coeff);
+                }
+            }
+        }
+    };
+
+    sparse_data::dispatch_fixed_nnz(vec_nnz, [&](auto K) {
+        parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+            for (int64_t j = j_start; j < j_stop; ++j) {
+                for (int64_t i = 0; i < d; ++i) {
+                    T &b = B[i * b_row + j * b_col];
+                    b = (beta == (T) 0) ? (T) 0 : beta * b;
+                }
+            }
+            if (rows_contiguous) {
+                // Rows of B and op(A) are contiguous: one short axpy per nonzero.
+                int64_t len = j_stop - j_start;
+                for_each_nonzero(K, [&](int64_t i, int64_t k, T coeff) {
+                    T *b = B + i * b_row + j_start;
+                    const T *a = A + k * a_row + j_start;
+                    for (int64_t jj = 0; jj < len; ++jj)
+                        b[jj] += coeff * a[jj];
+                });
+            } else {
+                // Columns of B and op(A) are contiguous: scatter one column at a time.
+                for (int64_t j = j_start; j < j_stop; ++j) {
+                    T *b = B + j * b_col;
+                    const T *a = A + j * a_col;
+                    for_each_nonzero(K, [&](int64_t i, int64_t k, T coeff) {
+                        b[i * b_row] += coeff * a[k * a_row];
+                    });
+                }
+            }
+        }, 16);
+    });
+}
+
+// Compute B = alpha * op(mat(A)) * op(submat(S)) + beta * B by transposing the problem
+// and calling lskges_compact.
+template <typename T, typename CompactSkOp>
+void rskges_compact(
+    blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
+    T alpha, const T *A, int64_t lda, const CompactSkOp &S, int64_t ro_s, int64_t co_s,
+    T beta, T *B, int64_t ldb
+) {
+    // B^T = alpha * op(submat(S))^T * op(mat(A))^T + beta * B^T. In the opposite layout, the
+    // buffers for A and B hold mat(A)^T and mat(B)^T, so only opS needs to be flipped.
+    auto trans_layout = (layout == blas::Layout::ColMajor) ? blas::Layout::RowMajor : blas::Layout::ColMajor;
+    auto trans_opS = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    lskges_compact(trans_layout, trans_opS, opA, d, m, n, alpha, S, ro_s, co_s, A, lda, beta, B, ldb);
+}
+
+} // end namespace RandBLAS::sparse
+
+
+namespace RandBLAS {
+
+// MARK: SKGE overloads, compact sparse operators
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch from the left with a CompactSparseSkOp, computing
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mat(A))}_{m \times n} + \beta \cdot \underbrace{\mat(B)}_{d \times n}.
+///
+/// The arguments have the same meaning as in sketch_general with a SparseSkOp. We read the
+/// nonzeros of :math:`\mtxS` directly from its major-axis indices and sign bitmap; no COO data is formed.
+/// If :math:`\mtxS` hasn't been sampled then we sample a temporary copy.
+/// @endverbatim
+template <typename T, typename RNG, SignedInteger idx_t>
+inline void sketch_general(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    CompactSparseSkOp<T, RNG, idx_t> &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *A,
+    int64_t lda,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    if (S.nnz < 0) {
+        CompactSparseSkOp<T, RNG, idx_t> shallowcopy(S.dist, S.seed_state);
+        fill_sparse(shallowcopy);
+        sparse::lskges_compact(layout, opS, opA, d, n, m, alpha, shallowcopy, ro_s, co_s, A, lda, beta, B, ldb);
+        return;
+    }
+    sparse::lskges_compact(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, lda, beta, B, ldb);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch from the right with a CompactSparseSkOp, computing
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\mat(A))}_{m \times n} \cdot \underbrace{\op(\submat(\mtxS))}_{n \times d} + \beta \cdot \underbrace{\mat(B)}_{m \times d}.
+///
+/// The arguments have the same meaning as in sketch_general with a SparseSkOp.
+/// @endverbatim
+template <typename T, typename RNG, SignedInteger idx_t>
+inline void sketch_general(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(submat(\mtxS)) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    const T *A,
+    int64_t lda,
+    CompactSparseSkOp<T, RNG, idx_t> &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    if (S.nnz < 0) {
+        CompactSparseSkOp<T, RNG, idx_t> shallowcopy(S.dist, S.seed_state);
+        fill_sparse(shallowcopy);
+        sparse::rskges_compact(layout, opA, opS, m, d, n, alpha, A, lda, shallowcopy, ro_s, co_s, beta, B, ldb);
+        return;
+    }
+    sparse::rskges_compact(layout, opA, opS, m, d, n, alpha, A, lda, S, ro_s, co_s, beta, B, ldb);
+}
+
+} // end namespace RandBLAS
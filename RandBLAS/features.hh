@@ -0,0 +1,470 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/linops.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// A random Fourier feature map for the Gaussian kernel
+///
+/// .. math::
+///
+///     k(\mtxx, \mtxy) = \exp\left(-\frac{\|\mtxx - \mtxy\|_2^2}{2\sigma^2}\right).
+///
+/// The map sends :math:`\mtxx \in \mathbb{R}^{\ttt{dim}}` to
+///
+/// .. math::
+///
+///     z(\mtxx) = \sqrt{2/D}\,\cos\left(\mtxS\mtxx/\sigma + \mathbf{b}\right),
+///
+/// where :math:`D = \ttt{num_features}`, :math:`\mtxS` is a :math:`D \times \ttt{dim}` matrix of
+/// standard normal random variables, and :math:`\mathbf{b}` is a vector of phases drawn
+/// uniformly from :math:`[0, 2\pi)`. Inner products of feature vectors are unbiased
+/// estimates of the kernel: :math:`\mathbb{E}[z(\mtxx)^T z(\mtxy)] = k(\mtxx, \mtxy)`.
+///
+/// Both :math:`\mtxS` and :math:`\mathbf{b}` are sampled once, when the map is constructed,
+/// so the map can be applied to any number of batches of data; see fourier_features.
+///
+/// @endverbatim
+template <typename T, typename RNG = DefaultRNG>
+struct FourierFeatureMap {
+    using state_t = RNGState<RNG>;
+    using scalar_t = T;
+
+    // ---------------------------------------------------------------------------
+    /// The dimension of the input vectors.
+    const int64_t dim;
+
+    // ---------------------------------------------------------------------------
+    /// The dimension of the feature vectors.
+    const int64_t num_features;
+
+    // ---------------------------------------------------------------------------
+    /// The kernel bandwidth, \math{\sigma.}
+    const T bandwidth;
+
+    // ---------------------------------------------------------------------------
+    /// The RNGState used to sample \math{\mtxS} and then \math{\mathbf{b}.}
+    const state_t seed_state;
+
+    // ---------------------------------------------------------------------------
+    /// The filled num_features-by-dim operator \math{\mtxS.}
+    DenseSkOp<T, RNG> S;
+
+    // ---------------------------------------------------------------------------
+    /// The phases \math{\mathbf{b},} of length num_features.
+    std::vector<T> phases;
+
+    // ---------------------------------------------------------------------------
+    /// The state that should be used to sample anything after this map.
+    const state_t next_state;
+
+    // ---------------------------------------------------------------------------
+    /// Sample a feature map from the given seed. "family" must be ScalarDist::Gaussian
+    /// or ScalarDist::GaussianZiggurat. The entries of \math{\mathbf{b}} are sampled
+    /// from S.next_state.
+    FourierFeatureMap(
+        int64_t dim,
+        int64_t num_features,
+        T bandwidth,
+        const state_t &seed_state,
+        ScalarDist family = ScalarDist::Gaussian,
+        const ExecPolicy &exec = {}
+    ) : dim(dim), num_features(num_features), bandwidth(bandwidth), seed_state(seed_state),
+        S(DenseDist(num_features, dim, family), seed_state),
+        phases(num_features),
+        next_state(sample_phases(num_features, phases.data(), S.next_state, exec))
+    {
+        randblas_require(dim > 0);
+        randblas_require(num_features > 0);
+        randblas_require(bandwidth > 0);
+        randblas_require(family == ScalarDist::Gaussian || family == ScalarDist::GaussianZiggurat);
+        fill_dense(S, exec);
+    }
+
+    private:
+    static state_t sample_phases(int64_t len, T *b, const state_t &seed, const ExecPolicy &exec) {
+        DenseDist D(len, 1, ScalarDist::Uniform);
+        auto next = fill_dense_unpacked(D.natural_layout, D, len, 1, 0, 0, b, seed, exec);
+        // Uniform entries lie in [-sqrt(3), sqrt(3)].
+        const T scale = (T) M_PI / std::sqrt((T) 3);
+        for (int64_t i = 0; i < len; ++i)
+            b[i] = scale * b[i] + (T) M_PI;
+        return next;
+    }
+};
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// Apply a random Fourier feature map to the :math:`n` columns of a
+/// :math:`\ttt{F.dim} \times n` matrix :math:`\mat(X)`, storing the features in the
+/// columns of a :math:`\ttt{F.num_features} \times n` matrix :math:`\mat(Z)`.
+/// That is,
+///
+/// .. math::
+///
+///     \mat(Z) = \sqrt{2/D}\,\cos\left(\mtxS \mat(X)/\sigma + \mathbf{b}\mathbf{1}^T\right).
+///
+/// We split :math:`\mat(Z)` into tiles that fit comfortably in cache. Each tile is formed
+/// by a GEMM with the corresponding rows of :math:`\mtxS` and columns of :math:`\mat(X)`,
+/// and its cosine transform is applied right away, while the tile is still in cache.
+/// Tiles are processed concurrently under "exec." Each tile's GEMM is a separate BLAS call,
+/// so a multithreaded BLAS library may add threads of its own.
+///
+/// For streaming data, construct F once and call this function on each batch as it
+/// arrives. The features of a point don't depend on the batch it's in, so the
+/// results match those of a single call on the concatenated batches.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor.
+///     - Matrix storage for \math{\mat(X)} and \math{\mat(Z)}.
+///
+/// @param[in] n
+///     A nonnegative integer.
+///     - The number of input points (columns of \math{\mat(X)}).
+///
+/// @param[in] F
+///     A FourierFeatureMap.
+///
+/// @param[in] X
+///     Pointer to a 1D array of real scalars.
+///     - Defines the F.dim-by-n matrix \math{\mat(X)}.
+///
+/// @param[in] ldx
+///     - Leading dimension of \math{\mat(X)} when reading from \math{X}.
+///
+/// @param[out] Z
+///     Pointer to a 1D array of real scalars.
+///     - On exit, defines the F.num_features-by-n matrix \math{\mat(Z)}.
+///
+/// @param[in] ldz
+///     - Leading dimension of \math{\mat(Z)} when reading from \math{Z}.
+///
+/// @param[in] exec
+///     Per-call threading control. See ExecPolicy.
+///
+template <typename T, typename RNG>
+void fourier_features(
+    blas::Layout layout,
+    int64_t n,
+    FourierFeatureMap<T, RNG> &F,
+    const T *X,
+    int64_t ldx,
+    T *Z,
+    int64_t ldz,
+    const ExecPolicy &exec = {}
+) {
+    const int64_t D = F.num_features;
+    const int64_t m = F.dim;
+    randblas_require(n >= 0);
+    if (layout == blas::Layout::ColMajor) {
+        randblas_require(ldx >= m);
+        randblas_require(ldz >= D);
+    } else {
+        randblas_require(ldx >= n);
+        randblas_require(ldz >= n);
+    }
+    if (n == 0)
+        return;
+    exec::ScopedPolicy scoped_policy(exec);
+    // Tiles of Z have at most tile_elements entries; that's 256 KiB in double precision.
+    constexpr int64_t tile_elements = 1 << 15;
+    const int64_t tile_rows = std::min(D, (int64_t) 512);
+    const int64_t tile_cols = std::clamp(tile_elements / tile_rows, (int64_t) 1, n);
+    const int64_t row_tiles = (D + tile_rows - 1) / tile_rows;
+    const int64_t col_tiles = (n + tile_cols - 1) / tile_cols;
+    const T alpha = 1 / F.bandwidth;
+    const T scale = std::sqrt((T) 2 / (T) D);
+    const T *b = F.phases.data();
+    auto [Z_inter_row, Z_inter_col] = layout_to_strides(layout, ldz);
+    int64_t X_inter_col = layout_to_strides(layout, ldx).inter_col_stride;
+
+    parallel::parallel_for(0, row_tiles * col_tiles, [&](int64_t t_start, int64_t t_stop) {
+        for (int64_t t = t_start; t < t_stop; ++t) {
+            int64_t i0 = (t % row_tiles) * tile_rows;
+            int64_t j0 = (t / row_tiles) * tile_cols;
+            int64_t nr = std::min(tile_rows, D - i0);
+            int64_t nc = std::min(tile_cols, n - j0);
+            T *Z_tile = Z + i0 * Z_inter_row + j0 * Z_inter_col;
+            lskge3(layout, blas::Op::NoTrans, blas::Op::NoTrans, nr, nc, m, alpha, F.S, i0, 0,
+                X + j0 * X_inter_col, ldx, (T) 0, Z_tile, ldz);
+            if (layout == blas::Layout::ColMajor) {
+                for (int64_t j = 0; j < nc; ++j) {
+                    T *z = Z_tile + j * ldz;
+                    for (int64_t i = 0; i < nr; ++i)
+                        z[i] = scale * std::cos(z[i] + b[i0 + i]);
+                }
+            } else {
+                for (int64_t i = 0; i < nr; ++i) {
+                    T *z = Z_tile + i * ldz;
+                    T bi = b[i0 + i];
+                    for (int64_t j = 0; j < nc; ++j)
+                        z[j] = scale * std::cos(z[j] + bi);
+                }
+            }
+        }
+    }, 1);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// Compute sign-random-projection (SimHash) signatures of the :math:`n` columns of a
+/// :math:`\ttt{S.n_cols} \times n` matrix :math:`\mat(X)`. Bit :math:`i` of the signature of column :math:`j` is
+///
+/// .. math::
+///
+///     h_i(\mat(X)[:,j]) = \begin{cases} 1 & \text{if } (\mtxS\mat(X))_{ij} \geq 0 \\ 0 & \text{otherwise.} \end{cases}
+///
+/// For Gaussian :math:`\mtxS,` two points with angle :math:`\theta` between them differ in each bit with
+/// probability :math:`\theta/\pi`, so Hamming distances between signatures (see hamming_distances)
+/// estimate angles.
+///
+/// Signatures are packed into :math:`W = \lceil \ttt{S.n_rows}/64 \rceil` words. Bit :math:`i` of column :math:`j`
+/// is bit :math:`i \bmod 64` of :math:`\ttt{sigs}[j \cdot \ttt{ldsig} + \lfloor i/64 \rfloor],` and unused bits of
+/// the last word are zero. So we need 1/32 of the memory of a single-precision :math:`\mtxS\mat(X).`
+///
+/// As in fourier_features, we split :math:`\mtxS\mat(X)` into tiles that fit in cache. Each tile is
+/// reduced to sign bits right away, so the full projection is never stored. If :math:`\mtxS` hasn't
+/// been sampled, then a DenseSkOp is sampled one panel of rows at a time (each panel is shared by every
+/// tile in its rows), and a SparseSkOp is sampled once.
+/// Tiles start on word boundaries, so concurrent tiles never write to the same word.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor.
+///     - Matrix storage for \math{\mat(X)}.
+///
+/// @param[in] n
+///     A nonnegative integer.
+///     - The number of input points (columns of \math{\mat(X)}).
+///
+/// @param[in] S
+///     A DenseSkOp or SparseSkOp. Its number of rows is the number of bits per signature.
+///
+/// @param[in] X
+///     Pointer to a 1D array of real scalars.
+///     - Defines the S.n_cols-by-n matrix \math{\mat(X)}.
+///
+/// @param[in] ldx
+///     - Leading dimension of \math{\mat(X)} when reading from \math{X}.
+///
+/// @param[out] sigs
+///     Pointer to an array of at least \math{n \cdot \ttt{ldsig}} words.
+///
+/// @param[in] ldsig
+///     - The number of words between consecutive signatures. We require \math{\ttt{ldsig} \geq W.}
+///
+/// @param[in] exec
+///     Per-call threading control. See ExecPolicy.
+///
+template <typename T, SketchingOperator SKOP>
+void simhash_signatures(
+    blas::Layout layout,
+    int64_t n,
+    SKOP &S,
+    const T *X,
+    int64_t ldx,
+    uint64_t *sigs,
+    int64_t ldsig,
+    const ExecPolicy &exec = {}
+) {
+    const int64_t D = S.n_rows;
+    const int64_t m = S.n_cols;
+    const int64_t words = (D + 63) / 64;
+    randblas_require(n >= 0);
+    randblas_require(ldsig >= words);
+    randblas_require(ldx >= ((layout == blas::Layout::ColMajor) ? m : n));
+    if (n == 0)
+        return;
+    exec::ScopedPolicy scoped_policy(exec);
+    // Tiles of S X have at most tile_elements entries, and whole words' worth of rows.
+    constexpr int64_t tile_elements = 1 << 15;
+    const int64_t tile_rows = std::min(64 * words, (int64_t) 512);
+    const int64_t tile_cols = std::clamp(tile_elements / tile_rows, (int64_t) 1, n);
+    const int64_t row_tiles = (D + tile_rows - 1) / tile_rows;
+    const int64_t col_tiles = (n + tile_cols - 1) / tile_cols;
+    int64_t X_inter_col = layout_to_strides(layout, ldx).inter_col_stride;
+    // P is a column-major nr-by-nc tile, so each column holds bits of one signature.
+    blas::Op opX = (layout == blas::Layout::ColMajor) ? blas::Op::NoTrans : blas::Op::Trans;
+    auto pack_tile = [&](const T *P, int64_t i0, int64_t j0, int64_t nr, int64_t nc) {
+        for (int64_t j = 0; j < nc; ++j) {
+            const T *p = P + j * nr;
+            uint64_t *sig = sigs + (j0 + j) * ldsig + i0 / 64;
+            for (int64_t w = 0; w * 64 < nr; ++w) {
+                int64_t len = std::min((int64_t) 64, nr - 64 * w);
+                uint64_t word = 0;
+                for (int64_t b = 0; b < len; ++b)
+                    word |= ((uint64_t) (p[64 * w + b] >= (T) 0)) << b;
+                sig[w] = word;
+            }
+        }
+    };
+
+    if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        // Each row panel of S is sampled (or found in S.buff) once and shared by
+        // every tile in its row.
+        for (int64_t i0 = 0; i0 < D; i0 += tile_rows) {
+            int64_t nr = std::min(tile_rows, D - i0);
+            linops::with_dense_submatrix<T>(blas::Layout::ColMajor, blas::Op::NoTrans, S, nr, m, i0, 0,
+                [&](blas::Op opS_eff, const T *S_i, int64_t lds) {
+                    parallel::parallel_for(0, col_tiles, [&](int64_t t_start, int64_t t_stop) {
+                        std::vector<T> P(nr * tile_cols);
+                        for (int64_t t = t_start; t < t_stop; ++t) {
+                            int64_t j0 = t * tile_cols;
+                            int64_t nc = std::min(tile_cols, n - j0);
+                            blas::gemm(blas::Layout::ColMajor, opS_eff, opX, nr, nc, m, (T) 1.0, S_i, lds,
+                                X + j0 * X_inter_col, ldx, (T) 0.0, P.data(), nr);
+                            pack_tile(P.data(), i0, j0, nr, nc);
+                        }
+                    }, 1);
+                }
+            );
+        }
+    } else {
+        // An unfilled SparseSkOp is sampled once, not once per tile.
+        sparse::with_filled(S, [&](SKOP &S_filled) {
+            parallel::parallel_for(0, row_tiles * col_tiles, [&](int64_t t_start, int64_t t_stop) {
+                std::vector<T> P(tile_rows * tile_cols);
+                for (int64_t t = t_start; t < t_stop; ++t) {
+                    int64_t i0 = (t % row_tiles) * tile_rows;
+                    int64_t j0 = (t / row_tiles) * tile_cols;
+                    int64_t nr = std::min(tile_rows, D - i0);
+                    int64_t nc = std::min(tile_cols, n - j0);
+                    sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, opX, nr, nc, m, (T) 1.0, S_filled, i0, 0,
+                        X + j0 * X_inter_col, ldx, (T) 0.0, P.data(), nr);
+                    pack_tile(P.data(), i0, j0, nr, nc);
+                }
+            }, 1);
+        });
+    }
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// Compute the Hamming distances between :math:`n_q` query signatures and :math:`n_d` database signatures,
+/// each packed into :math:`\ttt{words}` 64-bit words (for example, by simhash_signatures). On exit,
+///
+/// .. math::
+///
+///     \ttt{dist}[i \cdot \ttt{lddist} + j] = \sum_{w=0}^{\ttt{words}-1} \operatorname{popcount}(\ttt{Q}[i \cdot \ttt{ldq} + w] \oplus \ttt{D}[j \cdot \ttt{ldd} + w]).
+///
+/// The database is processed in blocks that stay in cache while every query in a block of queries
+/// is compared against them. Blocks of queries are processed concurrently under "exec."
+///
+/// @endverbatim
+/// @param[in] words
+///     The number of words per signature.
+/// @param[in] n_q
+///     The number of query signatures.
+/// @param[in] Q
+///     Pointer to the query signatures, with consecutive signatures \math{\ttt{ldq} \geq \ttt{words}} words apart.
+/// @param[in] ldq
+///     The number of words between consecutive query signatures.
+/// @param[in] n_d
+///     The number of database signatures.
+/// @param[in] D
+///     Pointer to the database signatures, with consecutive signatures \math{\ttt{ldd} \geq \ttt{words}} words apart.
+/// @param[in] ldd
+///     The number of words between consecutive database signatures.
+/// @param[out] dist
+///     Pointer to the row-major \math{n_q \times n_d} matrix of distances.
+/// @param[in] lddist
+///     Leading dimension of dist. We require \math{\ttt{lddist} \geq n_d.}
+/// @param[in] exec
+///     Per-call threading control. See ExecPolicy.
+///
+inline void hamming_distances(
+    int64_t words,
+    int64_t n_q,
+    const uint64_t *Q,
+    int64_t ldq,
+    int64_t n_d,
+    const uint64_t *D,
+    int64_t ldd,
+    int64_t *dist,
+    int64_t lddist,
+    const ExecPolicy &exec = {}
+) {
+    randblas_require(words >= 0);
+    randblas_require(ldq >= words);
+    randblas_require(ldd >= words);
+    randblas_require(lddist >= n_d);
+    exec::ScopedPolicy scoped_policy(exec);
+    // A block of the database takes up about 32 KiB.
+    const int64_t block_d = std::max((int64_t) 1, (int64_t) 4096 / std::max(ldd, (int64_t) 1));
+    constexpr int64_t block_q = 64;
+    const int64_t q_blocks = (n_q + block_q - 1) / block_q;
+    parallel::parallel_for(0, q_blocks, [&](int64_t b_start, int64_t b_stop) {
+        for (int64_t b = b_start; b < b_stop; ++b) {
+            int64_t i0 = b * block_q;
+            int64_t i1 = std::min(n_q, i0 + block_q);
+            for (int64_t j0 = 0; j0 < n_d; j0 += block_d) {
+                int64_t j1 = std::min(n_d, j0 + block_d);
+                for (int64_t i = i0; i < i1; ++i) {
+                    const uint64_t *q = Q + i * ldq;
+                    int64_t *dist_i = dist + i * lddist;
+                    for (int64_t j = j0; j < j1; ++j) {
+                        const uint64_t *d = D + j * ldd;
+                        int64_t acc = 0;
+                        for (int64_t w = 0; w < words; ++w)
+                            acc += std::popcount(q[w] ^ d[w]);
+                        dist_i[j] = acc;
+                    }
+                }
+            }
+        }
+    }, 1);
+}
+
+} // end namespace RandBLAS
@@ -0,0 +1,361 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/linops.hh"
+#include "RandBLAS/util.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute the Gram matrix of a sketch without storing the sketch. This computes one triangle of
+///
+/// .. math::
+///     \mtxG = \alpha \cdot (\underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mat(A))}_{m \times n})^T (\op(\submat(\mtxS)) \cdot \op(\mat(A))) + \beta \cdot \underbrace{\mtxG}_{n \times n},
+///
+/// which is what Cholesky QR and sketch-and-precondition methods need from the sketch.
+///
+/// We split the rows of :math:`\op(\submat(\mtxS))` into panels of :math:`\ttt{panel_rows}` rows.
+/// For each panel we compute the corresponding rows of the sketch with sketch_general and
+/// add their Gram matrix into :math:`\mtxG` with SYRK. So we only need workspace for one
+/// :math:`\ttt{panel_rows} \times n` panel, rather than the full :math:`d \times n` sketch. Panels of an
+/// unfilled DenseSkOp are generated on the fly, so :math:`\mtxS` isn't stored in full either.
+/// An unfilled SparseSkOp is sampled once, into a temporary that's shared by all panels.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(A)} and \math{\mtxG.}
+/// @param[in] uplo
+///     Uplo::Upper or Uplo::Lower. Only this triangle of \math{\mtxG} is read or written.
+/// @param[in] opS
+///     Op::NoTrans or Op::Trans, as in sketch_general.
+/// @param[in] opA
+///     Op::NoTrans or Op::Trans, as in sketch_general.
+/// @param[in] d
+///     The number of rows in the (implicit) sketch.
+/// @param[in] n
+///     The number of columns in the sketch, and the order of \math{\mtxG.}
+/// @param[in] m
+///     The number of columns in \math{\op(\submat(\mtxS))} and rows in \math{\op(\mat(A)).}
+/// @param[in] alpha
+///     A real scalar.
+/// @param[in] S
+///     A DenseSkOp or SparseSkOp that defines \math{\submat(\mtxS).}
+/// @param[in] ro_s
+///     Row offset of \math{\submat(\mtxS)} in \math{\mtxS.}
+/// @param[in] co_s
+///     Column offset of \math{\submat(\mtxS)} in \math{\mtxS.}
+/// @param[in] A
+///     Pointer to the buffer for \math{\mat(A),} read with leading dimension \math{\ttt{lda}.}
+/// @param[in] lda
+///     Leading dimension of \math{\mat(A).}
+/// @param[in] beta
+///     A real scalar. If zero, then \math{\mtxG} need not be set on input.
+/// @param[in,out] G
+///     Pointer to the buffer for the \math{n \times n} matrix \math{\mtxG.}
+/// @param[in] ldg
+///     Leading dimension of \math{\mtxG.} We require \math{\ttt{ldg} \geq n.}
+/// @param[in] panel_rows
+///     The number of rows of the sketch that are formed at a time. If zero, we pick a value
+///     that keeps the panel around a million entries.
+/// @param[in] exec
+///     An ExecPolicy (optional), used for each call to sketch_general.
+///
+template <typename T, SketchingOperator SKOP>
+void sketch_gram(
+    blas::Layout layout,
+    blas::Uplo uplo,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d,
+    int64_t n,
+    int64_t m,
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *A,
+    int64_t lda,
+    T beta,
+    T *G,
+    int64_t ldg,
+    int64_t panel_rows = 0,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    randblas_require(d >= 0);
+    randblas_require(n >= 0);
+    randblas_require(ldg >= n);
+    randblas_require(panel_rows >= 0);
+    if (panel_rows == 0)
+        panel_rows = std::max<int64_t>(64, (int64_t{1} << 20) / std::max<int64_t>(n, 1));
+    panel_rows = std::max<int64_t>(1, std::min(panel_rows, d));
+    if constexpr (!std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        if (S.nnz < 0) {
+            // Sample S once, rather than once per panel.
+            sparse::with_filled(S, [&](SKOP &S_filled) {
+                sketch_gram(layout, uplo, opS, opA, d, n, m, alpha, S_filled, ro_s, co_s, A, lda, beta, G, ldg, panel_rows, exec);
+            });
+            return;
+        }
+    }
+
+    // The panel holds rows [i, i + r) of op(submat(S)) * op(mat(A)), stored in "layout".
+    std::vector<T> panel(panel_rows * n);
+    T beta_i = beta;
+    for (int64_t i = 0; i < d; i += panel_rows) {
+        int64_t r = std::min(panel_rows, d - i);
+        int64_t ldp = (layout == blas::Layout::ColMajor) ? r : n;
+        // Rows [i, i + r) of op(submat(S)) are rows of submat(S) if opS == NoTrans, and columns otherwise.
+        int64_t ro_panel = (opS == blas::Op::NoTrans) ? ro_s + i : ro_s;
+        int64_t co_panel = (opS == blas::Op::NoTrans) ? co_s : co_s + i;
+        sketch_general(layout, opS, opA, r, n, m, (T) 1.0, S, ro_panel, co_panel, A, lda, (T) 0.0, panel.data(), ldp);
+        blas::syrk(layout, uplo, blas::Op::Trans, n, r, alpha, panel.data(), ldp, beta_i, G, ldg);
+        beta_i = (T) 1.0;
+    }
+    if (d == 0)
+        blas::syrk(layout, uplo, blas::Op::Trans, n, (int64_t) 0, alpha, panel.data(), std::max<int64_t>(n, 1), beta, G, ldg);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute one triangle of :math:`\mtxG = \alpha \cdot (\op(\mtxS)\op(\mat(A)))^T(\op(\mtxS)\op(\mat(A))) + \beta \cdot \mtxG`
+/// without storing the sketch. This is the overload of sketch_gram with
+/// :math:`\submat(\mtxS) = \mtxS.`
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+void sketch_gram(
+    blas::Layout layout,
+    blas::Uplo uplo,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d,
+    int64_t n,
+    int64_t m,
+    T alpha,
+    SKOP &S,
+    const T *A,
+    int64_t lda,
+    T beta,
+    T *G,
+    int64_t ldg,
+    int64_t panel_rows = 0,
+    const ExecPolicy &exec = {}
+) {
+    auto [rows_S, cols_S] = dims_before_op(d, m, opS);
+    randblas_require(S.n_rows == rows_S);
+    randblas_require(S.n_cols == cols_S);
+    sketch_gram(layout, uplo, opS, opA, d, n, m, alpha, S, 0, 0, A, lda, beta, G, ldg, panel_rows, exec);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Approximate :math:`\op(\mat(A))^T \op(\mat(B))` by sketching both factors with the same operator. This computes
+///
+/// .. math::
+///     \mat(C) = \alpha \cdot (\underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mat(A))}_{m \times n_a})^T (\op(\submat(\mtxS)) \cdot \underbrace{\op(\mat(B))}_{m \times n_b}) + \beta \cdot \underbrace{\mat(C)}_{n_a \times n_b}.
+///
+/// As in sketch_gram, we work through panels of :math:`\ttt{panel_rows}` rows of :math:`\op(\submat(\mtxS))`.
+/// Each panel of :math:`\mtxS` is used for both sketches before we move on to the next one. So an unfilled
+/// DenseSkOp has each panel generated once, rather than once per sketch, and an unfilled SparseSkOp is
+/// sampled once up front, as in sketch_gram. The two panels of the sketches are multiplied into
+/// :math:`\mat(C)` with GEMM.
+///
+/// If :math:`\ttt{SA}` (resp. :math:`\ttt{SB}`) is not null then the sketch
+/// :math:`\op(\submat(\mtxS))\op(\mat(A))` (resp. :math:`\op(\submat(\mtxS))\op(\mat(B))`) is written there,
+/// in the given layout with leading dimension :math:`\ttt{ldsa}` (resp. :math:`\ttt{ldsb}`). Otherwise we only
+/// keep one panel of it in workspace.
+///
+/// Arguments shared with sketch_gram have the same meaning here. The others are as follows.
+/// @endverbatim
+/// @param[in] opB
+///     Op::NoTrans or Op::Trans. Plays the role of opA for \math{\mat(B).}
+/// @param[in] n_a
+///     The number of columns in \math{\op(\mat(A)),} and rows in \math{\mat(C).}
+/// @param[in] n_b
+///     The number of columns in \math{\op(\mat(B)),} and columns in \math{\mat(C).}
+/// @param[in] B
+///     Pointer to the buffer for \math{\mat(B),} read with leading dimension \math{\ttt{ldb}.}
+/// @param[in,out] C
+///     Pointer to the buffer for the \math{n_a \times n_b} matrix \math{\mat(C).}
+/// @param[out] SA
+///     Optional. If not null, the \math{d \times n_a} sketch of \math{\op(\mat(A))} is written here.
+/// @param[out] SB
+///     Optional. If not null, the \math{d \times n_b} sketch of \math{\op(\mat(B))} is written here.
+///
+template <typename T, SketchingOperator SKOP>
+void sketch_cross_gram(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    blas::Op opB,
+    int64_t d,   // number of rows in op(submat(S))
+    int64_t n_a, // number of columns in op(mat(A))
+    int64_t n_b, // number of columns in op(mat(B))
+    int64_t m,   // number of rows in op(mat(A)) and op(mat(B))
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *A,
+    int64_t lda,
+    const T *B,
+    int64_t ldb,
+    T beta,
+    T *C,
+    int64_t ldc,
+    T *SA = nullptr,
+    int64_t ldsa = 0,
+    T *SB = nullptr,
+    int64_t ldsb = 0,
+    int64_t panel_rows = 0,
+    const ExecPolicy &exec = {}
+) {
+    using blas::Layout;
+    using blas::Op;
+    exec::ScopedPolicy scoped_policy(exec);
+    randblas_require(d >= 0);
+    randblas_require(panel_rows >= 0);
+    bool colmajor = layout == Layout::ColMajor;
+    randblas_require(ldc >= ((colmajor) ? n_a : n_b));
+    if (SA != nullptr)
+        randblas_require(ldsa >= ((colmajor) ? d : n_a));
+    if (SB != nullptr)
+        randblas_require(ldsb >= ((colmajor) ? d : n_b));
+    auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
+    randblas_require(ro_s + rows_submat_S <= S.n_rows);
+    randblas_require(co_s + cols_submat_S <= S.n_cols);
+
+    if (d == 0) {
+        for (int64_t i = 0; i < ((colmajor) ? n_b : n_a); ++i)
+            util::safe_scal((colmajor) ? n_a : n_b, beta, C + i * ldc, 1);
+        return;
+    }
+    if (panel_rows == 0)
+        panel_rows = std::max<int64_t>(64, (int64_t{1} << 20) / std::max<int64_t>(n_a + n_b, 1));
+    panel_rows = std::min(panel_rows, d);
+
+    // Workspace for panels of the sketches that the caller doesn't want returned.
+    std::vector<T> work_a((SA == nullptr) ? panel_rows * n_a : 0);
+    std::vector<T> work_b((SB == nullptr) ? panel_rows * n_b : 0);
+
+    constexpr bool is_dense = std::is_same_v<typename SKOP::distribution_t, DenseDist>;
+    if constexpr (!is_dense) {
+        if (S.nnz < 0) {
+            // Sample S once, rather than once per panel and sketch.
+            sparse::with_filled(S, [&](SKOP &S_filled) {
+                sketch_cross_gram(layout, opS, opA, opB, d, n_a, n_b, m, alpha, S_filled, ro_s, co_s,
+                    A, lda, B, ldb, beta, C, ldc, SA, ldsa, SB, ldsb, panel_rows, exec);
+            });
+            return;
+        }
+    }
+
+    T beta_i = beta;
+    for (int64_t i = 0; i < d; i += panel_rows) {
+        int64_t r = std::min(panel_rows, d - i);
+        // Rows [i, i + r) of each sketch go to the caller's buffer if provided, else to workspace.
+        T *SA_i   = (SA != nullptr) ? SA + ((colmajor) ? i : i * ldsa) : work_a.data();
+        int64_t ld_a = (SA != nullptr) ? ldsa : ((colmajor) ? r : n_a);
+        T *SB_i   = (SB != nullptr) ? SB + ((colmajor) ? i : i * ldsb) : work_b.data();
+        int64_t ld_b = (SB != nullptr) ? ldsb : ((colmajor) ? r : n_b);
+        // Rows [i, i + r) of op(submat(S)) are rows of submat(S) if opS == NoTrans, and columns otherwise.
+        int64_t ro_panel = (opS == Op::NoTrans) ? ro_s + i : ro_s;
+        int64_t co_panel = (opS == Op::NoTrans) ? co_s : co_s + i;
+        if constexpr (is_dense) {
+            auto [rows_panel, cols_panel] = dims_before_op(r, m, opS);
+            linops::with_dense_submatrix<T>(layout, opS, S, rows_panel, cols_panel, ro_panel, co_panel,
+                [&](Op opS_eff, const T *S_i, int64_t lds) {
+                    blas::gemm(layout, opS_eff, opA, r, n_a, m, (T) 1.0, S_i, lds, A, lda, (T) 0.0, SA_i, ld_a);
+                    blas::gemm(layout, opS_eff, opB, r, n_b, m, (T) 1.0, S_i, lds, B, ldb, (T) 0.0, SB_i, ld_b);
+                }
+            );
+        } else {
+            sketch_general(layout, opS, opA, r, n_a, m, (T) 1.0, S, ro_panel, co_panel, A, lda, (T) 0.0, SA_i, ld_a);
+            sketch_general(layout, opS, opB, r, n_b, m, (T) 1.0, S, ro_panel, co_panel, B, ldb, (T) 0.0, SB_i, ld_b);
+        }
+        blas::gemm(layout, Op::Trans, Op::NoTrans, n_a, n_b, r, alpha, SA_i, ld_a, SB_i, ld_b, beta_i, C, ldc);
+        beta_i = (T) 1.0;
+    }
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute :math:`\mat(C) = \alpha \cdot (\op(\mtxS)\op(\mat(A)))^T(\op(\mtxS)\op(\mat(B))) + \beta \cdot \mat(C)`
+/// with one pass over :math:`\mtxS.` This is the overload of sketch_cross_gram with
+/// :math:`\submat(\mtxS) = \mtxS.`
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+void sketch_cross_gram(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    blas::Op opB,
+    int64_t d,
+    int64_t n_a,
+    int64_t n_b,
+    int64_t m,
+    T alpha,
+    SKOP &S,
+    const T *A,
+    int64_t lda,
+    const T *B,
+    int64_t ldb,
+    T beta,
+    T *C,
+    int64_t ldc,
+    T *SA = nullptr,
+    int64_t ldsa = 0,
+    T *SB = nullptr,
+    int64_t ldsb = 0,
+    int64_t panel_rows = 0,
+    const ExecPolicy &exec = {}
+) {
+    auto [rows_S, cols_S] = dims_before_op(d, m, opS);
+    randblas_require(S.n_rows == rows_S);
+    randblas_require(S.n_cols == cols_S);
+    sketch_cross_gram(layout, opS, opA, opB, d, n_a, n_b, m, alpha, S, 0, 0, A, lda, B, ldb, beta, C, ldc, SA, ldsa, SB, ldsb, panel_rows, exec);
+}
+
+} // end namespace RandBLAS
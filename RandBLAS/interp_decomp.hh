@@ -0,0 +1,418 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/sparse_data/sksp.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+
+namespace RandBLAS::interp_decomp {
+
+// Run up to k steps of Householder QR with column pivoting on the column-major d-by-n matrix Y.
+// On exit, perm[0:n] is the column permutation (Y[:, perm] = QR), and the leading rows of Y
+// hold [R11, R12] for the permuted columns. We stop early once the trailing columns are zero
+// to working precision relative to the first pivot, since the steps taken so far already
+// capture Y. Returns the number of steps taken.
+template <typename T>
+int64_t householder_qrcp(int64_t d, int64_t n, int64_t k, T *Y, int64_t ldy, int64_t *perm) {
+    randblas_require(k <= std::min(d, n));
+    std::iota(perm, perm + n, (int64_t) 0);
+    std::vector<T> norms(n);
+    std::vector<T> w(n);
+    T tol = (T) d * std::numeric_limits<T>::epsilon();
+    T r00 = (T) 0;
+    for (int64_t j = 0; j < k; ++j) {
+        // Pivot on the trailing column with the largest norm. Norms are recomputed
+        // rather than downdated, which costs no more than the reflections themselves.
+        int64_t len = d - j;
+        for (int64_t c = j; c < n; ++c)
+            norms[c] = blas::nrm2(len, Y + j + c * ldy, 1);
+        int64_t p = std::max_element(norms.begin() + j, norms.end()) - norms.begin();
+        T norm_x = norms[p];
+        if (j == 0)
+            r00 = norm_x;
+        if (norm_x <= tol * r00 || norm_x == (T) 0)
+            return j;
+        if (p != j) {
+            blas::swap(d, Y + j * ldy, 1, Y + p * ldy, 1);
+            std::swap(perm[j], perm[p]);
+        }
+        // Same reflector as leverage::householder_r.
+        T *x = Y + j + j * ldy;
+        T r_jj = (x[0] > 0) ? -norm_x : norm_x;
+        x[0] -= r_jj;
+        T vtv = blas::dot(len, x, 1, x, 1);
+        int64_t n_trail = n - j - 1;
+        if (n_trail > 0) {
+            T *Y_trail = Y + j + (j + 1) * ldy;
+            blas::gemv(blas::Layout::ColMajor, blas::Op::Trans, len, n_trail, (T) 1.0, Y_trail, ldy, x, 1, (T) 0.0, w.data(), 1);
+            blas::ger(blas::Layout::ColMajor, len, n_trail, (T) -2.0 / vtv, x, 1, w.data(), 1, Y_trail, ldy);
+        }
+        x[0] = r_jj;
+    }
+    return k;
+}
+
+// Compute a thin Householder QR decomposition C = QR of the column-major m-by-k matrix C
+// (m >= k). On exit, C holds the m-by-k orthonormal factor Q, and the upper triangle of the
+// column-major k-by-k matrix R (leading dimension ldr) holds R. As in householder_qrcp we
+// stop early if a trailing column is zero to working precision. Returns the number of steps
+// taken; if that's r < k, then only the leading r columns of Q and the leading r-by-r block
+// of R are meaningful.
+template <typename T>
+int64_t householder_qr(int64_t m, int64_t k, T *C, int64_t ldc, T *R, int64_t ldr) {
+    randblas_require(m >= k);
+    std::vector<T> w(k);
+    std::vector<T> vtv(k);
+    T tol = (T) m * std::numeric_limits<T>::epsilon();
+    T r00 = (T) 0;
+    int64_t r = k;
+    for (int64_t j = 0; j < k; ++j) {
+        // The reflector is I - 2 v v^T / (v^T v), with v = x - r_jj e_1 stored in place of x.
+        T *x = C + j + j * ldc;
+        int64_t len = m - j;
+        T norm_x = blas::nrm2(len, x, 1);
+        if (j == 0)
+            r00 = norm_x;
+        if (norm_x <= tol * r00 || norm_x == (T) 0) {
+            r = j;
+            break;
+        }
+        T r_jj = (x[0] > 0) ? -norm_x : norm_x;
+        x[0] -= r_jj;
+        vtv[j] = blas::dot(len, x, 1, x, 1);
+        int64_t n_trail = k - j - 1;
+        if (n_trail > 0) {
+            T *C_trail = C + j + (j + 1) * ldc;
+            blas::gemv(blas::Layout::ColMajor, blas::Op::Trans, len, n_trail, (T) 1.0, C_trail, ldc, x, 1, (T) 0.0, w.data(), 1);
+            blas::ger(blas::Layout::ColMajor, len, n_trail, (T) -2.0 / vtv[j], x, 1, w.data(), 1, C_trail, ldc);
+        }
+        R[j + j * ldr] = r_jj;
+    }
+    for (int64_t j = 0; j < r; ++j) {
+        for (int64_t i = 0; i < j; ++i)
+            R[i + j * ldr] = C[i + j * ldc];
+        for (int64_t i = j + 1; i < r; ++i)
+            R[i + j * ldr] = (T) 0.0;
+    }
+    // Move the reflectors out of C, then accumulate Q = H_0 ... H_{r-1} [I; 0] in C.
+    std::vector<T> V(m * r);
+    for (int64_t j = 0; j < r; ++j)
+        blas::copy(m - j, C + j + j * ldc, 1, V.data() + j + j * m, 1);
+    for (int64_t j = 0; j < r; ++j) {
+        std::fill(C + j * ldc, C + j * ldc + m, (T) 0.0);
+        C[j + j * ldc] = (T) 1.0;
+    }
+    for (int64_t j = r - 1; j >= 0; --j) {
+        // Columns before j of the partial product are zero in rows j and below.
+        const T *v = V.data() + j + j * m;
+        int64_t len = m - j;
+        int64_t n_trail = r - j;
+        T *C_trail = C + j + j * ldc;
+        blas::gemv(blas::Layout::ColMajor, blas::Op::Trans, len, n_trail, (T) 1.0, C_trail, ldc, v, 1, (T) 0.0, w.data(), 1);
+        blas::ger(blas::Layout::ColMajor, len, n_trail, (T) -2.0 / vtv[j], v, 1, w.data(), 1, C_trail, ldc);
+    }
+    return r;
+}
+
+// Overwrite the k-by-nb matrix W (in the given layout) with R^{-1} W, where R is the
+// upper triangle of the column-major k-by-k matrix with leading dimension ldr.
+template <typename T>
+void solve_triangular(blas::Layout layout, int64_t k, int64_t nb, const T *R, int64_t ldr, T *W, int64_t ldw) {
+    // A column-major upper-triangular R is lower-triangular when read row-major.
+    bool colmajor = layout == blas::Layout::ColMajor;
+    blas::Uplo uplo_R = (colmajor) ? blas::Uplo::Upper : blas::Uplo::Lower;
+    blas::Op op_R = (colmajor) ? blas::Op::NoTrans : blas::Op::Trans;
+    blas::trsm(layout, blas::Side::Left, uplo_R, op_R, blas::Diag::NonUnit, k, nb, (T) 1.0, R, ldr, W, ldw);
+}
+
+// The steps of column_id that don't depend on how A is stored. sketch_A(Y) must write the
+// d-by-n sketch of A to Y in column-major order, gather_C(J, r, C, ldc) must write the m-by-r
+// matrix A[:, J[0:r]] to C in the given layout, and apply_Qt(Q, ldq, r, j0, nb, X_block) must
+// write Q^T A[:, j0:j0+nb] to X_block, where Q is m-by-r in the given layout. apply_Qt is
+// called on blocks of at most block_cols columns. Returns the number of columns selected.
+template <typename T, typename SKETCH, typename GATHER, typename APPLY>
+int64_t column_id_impl(
+    blas::Layout layout, int64_t m, int64_t n, int64_t k, int64_t d, int64_t *J, T *X, int64_t ldx,
+    int64_t block_cols, SKETCH &&sketch_A, GATHER &&gather_C, APPLY &&apply_Qt
+) {
+    // Select columns by pivoted QR of the sketch.
+    std::vector<T> Y(d * n);
+    sketch_A(Y.data());
+    std::vector<int64_t> perm(n);
+    int64_t r = householder_qrcp(d, n, k, Y.data(), d, perm.data());
+    if (r == 0)
+        return 0;
+
+    // Orthonormalize the selected columns. If they turn out to be numerically dependent
+    // then we keep the leading ones, which span the rest to working precision.
+    bool colmajor = layout == blas::Layout::ColMajor;
+    int64_t ldc = (colmajor) ? m : r;
+    std::vector<T> C(m * r);
+    gather_C(perm.data(), r, C.data(), ldc);
+    auto [c_row, c_col] = layout_to_strides(layout, ldc);
+    std::vector<T> Q(m * r);
+    util::omatcopy(m, r, C.data(), c_row, c_col, Q.data(), 1, m);
+    int64_t ldr = r;
+    std::vector<T> R(ldr * ldr);
+    r = householder_qr(m, r, Q.data(), m, R.data(), ldr);
+    if (r == 0)
+        return 0;
+    std::copy(perm.begin(), perm.begin() + r, J);
+    int64_t ldq = (colmajor) ? m : r;
+    auto [q_row, q_col] = layout_to_strides(layout, ldq);
+    util::omatcopy(m, r, Q.data(), 1, m, C.data(), q_row, q_col);
+
+    // Coefficients from one pass over A, in blocks of columns: X = R^{-1} Q^T A.
+    auto [x_row, x_col] = layout_to_strides(layout, ldx);
+    int64_t num_blocks = (n + block_cols - 1) / block_cols;
+    parallel::parallel_for(0, num_blocks, [&](int64_t b_start, int64_t b_stop) {
+        for (int64_t b = b_start; b < b_stop; ++b) {
+            int64_t j0 = b * block_cols;
+            int64_t nb = std::min(block_cols, n - j0);
+            T *X_block = X + j0 * x_col;
+            apply_Qt(C.data(), ldq, r, j0, nb, X_block);
+            solve_triangular(layout, r, nb, R.data(), ldr, X_block, ldx);
+        }
+    }, 1);
+    // The selected columns are reproduced exactly.
+    for (int64_t t = 0; t < r; ++t) {
+        for (int64_t i = 0; i < r; ++i)
+            X[i * x_row + J[t] * x_col] = (i == t) ? (T) 1.0 : (T) 0.0;
+    }
+    return r;
+}
+
+} // end namespace RandBLAS::interp_decomp
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute a rank-:math:`k` column interpolative decomposition :math:`\mat(A) \approx \mat(A)[:,J]\,\mat(X)` of an
+/// :math:`m \times n` matrix, where :math:`J` is a list of :math:`k` column indices and :math:`\mat(X)` is :math:`k \times n.`
+///
+///   1. Sketch :math:`\mat(A)` from the left with a :math:`d \times m` SparseSkOp :math:`\mtxS.`
+///   2. Run :math:`k` steps of column-pivoted Householder QR on the :math:`d \times n` sketch. The first :math:`k` pivots are :math:`J.`
+///   3. Set :math:`\mat(X)` to the least squares solution of :math:`\mat(A)[:,J]\,\mat(X) = \mat(A).`
+///
+/// Step 3 computes a Householder QR decomposition :math:`\mat(A)[:,J] = \mtxQ\mtxR` and makes one pass over
+/// :math:`\mat(A)` in blocks of columns. For each block we form :math:`\mtxQ^T` times the block and solve with
+/// :math:`\mtxR` while the result is in cache. Since :math:`\mtxQ` is orthonormal to working precision, the
+/// residual doesn't grow with the condition number of :math:`\mat(A)[:,J].` Columns :math:`J` of :math:`\mat(X)`
+/// are set to the identity.
+///
+/// If :math:`\mat(A)` has numerical rank :math:`r < k,` then step 2 stops after :math:`r` steps, when the trailing
+/// columns of the sketch are zero to working precision relative to its largest column. The :math:`r` columns found
+/// so far already give an accurate approximation, so we return a rank-:math:`r` decomposition and set :math:`k = r.`
+/// Step 3 does the same if :math:`\mat(A)[:,J]` turns out to be numerically rank-deficient.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(A)} and \math{\mat(X).}
+/// @param[in] m
+///     The number of rows in \math{\mat(A).}
+/// @param[in] n
+///     The number of columns in \math{\mat(A).}
+/// @param[in] A
+///     Pointer to the buffer for \math{\mat(A),} read with leading dimension \math{\ttt{lda}.}
+/// @param[in] lda
+///     Leading dimension of \math{\mat(A)} in the given layout.
+/// @param[in,out] k
+///     On entry, the number of columns to select. We require \math{k \leq \min\{m, n\}.}
+///     On exit, the number of columns selected. This is less than the entry value if
+///     the matrix has smaller numerical rank.
+/// @param[out] J
+///     Pointer to an array of length \math{k.} On exit, the selected column indices, in pivot order.
+/// @param[out] X
+///     Pointer to the buffer for the \math{k \times n} matrix \math{\mat(X).} On exit, the leading
+///     rows of \math{\mat(X)} (one for each selected column) hold the coefficients.
+/// @param[in] ldx
+///     Leading dimension of \math{\mat(X)} in the given layout, for the entry value of \math{k.}
+/// @param[in] state
+///     The RNGState used to sample \math{\mtxS.}
+/// @param[in] d
+///     The number of rows in \math{\mtxS.} We use \math{k + 10} if \math{d = 0.} Otherwise we require \math{k \leq d.}
+/// @param[in] exec
+///     Execution policy for the sketch.
+/// @returns
+///     An RNGState that should be used the next time a random sampling function is called.
+///
+template <typename T, typename state_t = RNGState<DefaultRNG>>
+state_t column_id(
+    blas::Layout layout,
+    int64_t m,
+    int64_t n,
+    const T *A,
+    int64_t lda,
+    int64_t &k,
+    int64_t *J,
+    T *X,
+    int64_t ldx,
+    const state_t &state,
+    int64_t d = 0,
+    const ExecPolicy &exec = {}
+) {
+    using blas::Layout;
+    using blas::Op;
+    bool colmajor = layout == Layout::ColMajor;
+    randblas_require(k <= std::min(m, n));
+    randblas_require(lda >= ((colmajor) ? m : n));
+    randblas_require(ldx >= ((colmajor) ? k : n));
+    if (d == 0)
+        d = k + 10;
+    randblas_require(k <= d);
+    if (k == 0)
+        return state;
+    exec::ScopedPolicy scoped_policy(exec);
+
+    SparseDist D_S(d, m, std::min((int64_t) 8, d), Axis::Short);
+    SparseSkOp<T, typename state_t::generator> S(D_S, state);
+    auto [a_row, a_col] = layout_to_strides(layout, lda);
+    k = interp_decomp::column_id_impl(layout, m, n, k, d, J, X, ldx, 256,
+        [&](T *Y) {
+            // Read in column-major order, a row-major buffer for A holds A^T.
+            Op opA = (colmajor) ? Op::NoTrans : Op::Trans;
+            sketch_general(Layout::ColMajor, Op::NoTrans, opA, d, n, m, (T) 1.0, S, A, lda, (T) 0.0, Y, d);
+        },
+        [&](const int64_t *J, int64_t r, T *C, int64_t ldc) {
+            auto [c_row, c_col] = layout_to_strides(layout, ldc);
+            for (int64_t t = 0; t < r; ++t)
+                blas::copy(m, A + J[t] * a_col, a_row, C + t * c_col, c_row);
+        },
+        [&](const T *Q, int64_t ldq, int64_t r, int64_t j0, int64_t nb, T *X_block) {
+            blas::gemm(layout, Op::Trans, Op::NoTrans, r, nb, m, (T) 1.0, Q, ldq, A + j0 * a_col, lda, (T) 0.0, X_block, ldx);
+        }
+    );
+    return S.next_state;
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute a rank-:math:`k` column interpolative decomposition :math:`\mtxA \approx \mtxA[:,J]\,\mat(X)` of a
+/// sparse matrix :math:`\mtxA.` This follows the dense overload, except that the sketching operator is a
+/// :math:`d \times m` DenseSkOp and the pass over :math:`\mtxA` in step 3 is one sparse-times-dense product
+/// rather than a loop over blocks of columns.
+/// The selected columns :math:`\mtxA[:,J]` are stored densely, so this needs :math:`O(mk)` workspace.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(X).}
+/// @param[in] A
+///     A COOMatrix, CSRMatrix, or CSCMatrix with zero-based indexing.
+/// @param[in,out] k
+///     On entry, the number of columns to select. We require \math{k \leq \min\{m, n\}.}
+///     On exit, the number of columns selected. This is less than the entry value if
+///     the matrix has smaller numerical rank.
+/// @param[out] J
+///     Pointer to an array of length \math{k.} On exit, the selected column indices, in pivot order.
+/// @param[out] X
+///     Pointer to the buffer for the \math{k \times n} matrix \math{\mat(X).} On exit, the leading
+///     rows of \math{\mat(X)} (one for each selected column) hold the coefficients.
+/// @param[in] ldx
+///     Leading dimension of \math{\mat(X)} in the given layout, for the entry value of \math{k.}
+/// @param[in] state
+///     The RNGState used to sample \math{\mtxS.}
+/// @param[in] d
+///     The number of rows in \math{\mtxS.} We use \math{k + 10} if \math{d = 0.} Otherwise we require \math{k \leq d.}
+/// @param[in] exec
+///     Execution policy for the sketch and for the pass over \math{\mtxA.}
+/// @returns
+///     An RNGState that should be used the next time a random sampling function is called.
+///
+template <SparseMatrix SpMat, typename T = SpMat::scalar_t, typename state_t = RNGState<DefaultRNG>>
+state_t column_id(
+    blas::Layout layout,
+    SpMat &A,
+    int64_t &k,
+    int64_t *J,
+    T *X,
+    int64_t ldx,
+    const state_t &state,
+    int64_t d = 0,
+    const ExecPolicy &exec = {}
+) {
+    using blas::Layout;
+    using blas::Op;
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+    randblas_require(A.index_base == IndexBase::Zero);
+    randblas_require(k <= std::min(m, n));
+    randblas_require(ldx >= ((layout == Layout::ColMajor) ? k : n));
+    if (d == 0)
+        d = k + 10;
+    randblas_require(k <= d);
+    if (k == 0)
+        return state;
+    exec::ScopedPolicy scoped_policy(exec);
+
+    DenseSkOp<T, typename state_t::generator> S(DenseDist(d, m), state);
+    // CSR and CSC matrices can't be multiplied at a nonzero column offset, so Q^T A
+    // is formed with one sparse-times-dense product rather than in blocks.
+    k = interp_decomp::column_id_impl(layout, m, n, k, d, J, X, ldx, n,
+        [&](T *Y) {
+            sketch_sparse(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, n, m, (T) 1.0, S, 0, 0, A, (T) 0.0, Y, d);
+        },
+        [&](const int64_t *J, int64_t r, T *C, int64_t ldc) {
+            std::vector<int64_t> pos(n, -1);
+            for (int64_t t = 0; t < r; ++t)
+                pos[J[t]] = t;
+            auto [c_row, c_col] = layout_to_strides(layout, ldc);
+            std::fill(C, C + m * r, (T) 0.0);
+            sparse_data::for_each_in_window(A, 0, 0, m, n, [&](int64_t i, int64_t j, int64_t ell) {
+                if (pos[j] >= 0)
+                    C[i * c_row + pos[j] * c_col] += A.vals[ell];
+            });
+        },
+        [&](const T *Q, int64_t ldq, int64_t r, int64_t j0, int64_t nb, T *X_block) {
+            randblas_require(j0 == 0 && nb == n);
+            sparse_data::right_spmm(layout, Op::Trans, Op::NoTrans, r, n, m, (T) 1.0, Q, ldq, A, 0, 0, (T) 0.0, X_block, ldx);
+        }
+    );
+    return S.next_state;
+}
+
+} // end namespace RandBLAS
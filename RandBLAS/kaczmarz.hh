@@ -0,0 +1,219 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/nystrom.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace RandBLAS::kaczmarz {
+
+// Workspace for one block Kaczmarz step with at most s rows, for a system with n columns.
+template <typename T>
+struct BlockWork {
+    std::vector<T> rows;  // s-by-n, row-major
+    std::vector<T> gram;  // s-by-s, column-major
+    std::vector<T> resid; // length s
+    BlockWork(int64_t s, int64_t n) : rows(s * n), gram(s * s), resid(s) {}
+};
+
+// Compute the update dx = pinv(A[idxs, :]) (b[idxs] - A[idxs, :] x) for the rows listed in idxs
+// and write it to dx. Repeated indices are dropped. We gather the block, form its Gram matrix
+// with SYRK, and solve with a Cholesky factor. If the Gram matrix is singular to working
+// precision then we add a small multiple of its trace to the diagonal.
+template <typename T>
+void block_update(
+    int64_t n, const T *A, int64_t a_row, int64_t a_col, const T *b,
+    std::vector<int64_t> &idxs, const T *x, T *dx, BlockWork<T> &work
+) {
+    std::sort(idxs.begin(), idxs.end());
+    idxs.erase(std::unique(idxs.begin(), idxs.end()), idxs.end());
+    int64_t s = (int64_t) idxs.size();
+    T *rows = work.rows.data();
+    T *gram = work.gram.data();
+    T *resid = work.resid.data();
+    for (int64_t t = 0; t < s; ++t) {
+        blas::copy(n, A + idxs[t] * a_row, a_col, rows + t * n, 1);
+        resid[t] = b[idxs[t]];
+    }
+    // resid = b[idxs] - rows * x.
+    blas::gemv(blas::Layout::RowMajor, blas::Op::NoTrans, s, n, (T) -1.0, rows, n, x, 1, (T) 1.0, resid, 1);
+    // gram = rows * rows^T, upper triangle. In column-major terms rows is n-by-s.
+    blas::syrk(blas::Layout::ColMajor, blas::Uplo::Upper, blas::Op::Trans, s, n, (T) 1.0, rows, n, (T) 0.0, gram, s);
+    if (!util::cholesky_upper(s, gram, s)) {
+        blas::syrk(blas::Layout::ColMajor, blas::Uplo::Upper, blas::Op::Trans, s, n, (T) 1.0, rows, n, (T) 0.0, gram, s);
+        T trace = 0;
+        for (int64_t t = 0; t < s; ++t)
+            trace += gram[t + t * s];
+        T shift = (T) s * std::numeric_limits<T>::epsilon() * trace;
+        for (int64_t t = 0; t < s; ++t)
+            gram[t + t * s] += shift;
+        bool posdef = util::cholesky_upper(s, gram, s);
+        randblas_error_if_msg(!posdef, "A sampled block of rows is zero.");
+    }
+    // Solve R^T R y = resid, then dx = rows^T y.
+    blas::trsm(blas::Layout::ColMajor, blas::Side::Left, blas::Uplo::Upper, blas::Op::Trans, blas::Diag::NonUnit, s, 1, (T) 1.0, gram, s, resid, s);
+    blas::trsm(blas::Layout::ColMajor, blas::Side::Left, blas::Uplo::Upper, blas::Op::NoTrans, blas::Diag::NonUnit, s, 1, (T) 1.0, gram, s, resid, s);
+    blas::gemv(blas::Layout::RowMajor, blas::Op::Trans, s, n, (T) 1.0, rows, n, resid, 1, (T) 0.0, dx, 1);
+}
+
+} // end namespace RandBLAS::kaczmarz
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Run :math:`\ttt{num_iters}` steps of block randomized Kaczmarz on the :math:`m \times n` system
+/// :math:`\mat(A)\,x = b.` Each step samples :math:`\ttt{block_size}` row indices :math:`\tau` independently,
+/// with probability proportional to the squared row norms of :math:`\mat(A),` and sets
+///
+/// .. math::
+///     x \leftarrow x + \mat(A)[\tau,:]^{\dagger}\,(b[\tau] - \mat(A)[\tau,:]\,x).
+///
+/// Repeated indices within a block are dropped. Row indices are drawn with Walker's alias method
+/// (see weights_to_alias), so each draw takes :math:`O(1)` time after an :math:`O(m n)` setup.
+/// Each step gathers the rows of :math:`\mat(A)[\tau,:]` into a contiguous buffer, forms their Gram
+/// matrix with SYRK, and solves with its Cholesky factor.
+///
+/// If the system is consistent then :math:`x` converges to a solution. If it's inconsistent then
+/// :math:`x` converges to a neighborhood of the least squares solution whose size shrinks as
+/// :math:`\ttt{block_size}` grows.
+///
+/// If :math:`\ttt{hogwild}` is true then steps run concurrently, as many as the current ExecPolicy
+/// allows, and update :math:`x` without locks in the style of Hogwild!. Each step works from a
+/// snapshot of :math:`x` that may be missing updates from other in-flight steps. Reads and updates
+/// of :math:`x` are relaxed atomic operations, so the result depends on scheduling but there are no
+/// data races. The sampled indices don't depend on scheduling.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(A).}
+/// @param[in] m
+///     The number of rows in \math{\mat(A).}
+/// @param[in] n
+///     The number of columns in \math{\mat(A).}
+/// @param[in] A
+///     Pointer to the buffer for \math{\mat(A),} read with leading dimension \math{\ttt{lda}.}
+/// @param[in] lda
+///     Leading dimension of \math{\mat(A)} in the given layout.
+/// @param[in] b
+///     Pointer to an array of length \math{m.}
+/// @param[in,out] x
+///     Pointer to an array of length \math{n.} On entry, the starting point. On exit, the last iterate.
+/// @param[in] block_size
+///     The number of rows sampled per step. We require \math{1 \leq \ttt{block_size} \leq m.}
+/// @param[in] num_iters
+///     The number of steps.
+/// @param[in] state
+///     The RNGState used to sample row indices.
+/// @param[in] hogwild
+///     If true, then run steps concurrently with asynchronous updates to \math{x.}
+/// @param[in] exec
+///     Execution policy. In Hogwild mode, this bounds the number of concurrent steps.
+/// @returns
+///     An RNGState that should be used the next time a random sampling function is called.
+///
+template <typename T, typename state_t = RNGState<DefaultRNG>>
+state_t block_kaczmarz(
+    blas::Layout layout,
+    int64_t m,
+    int64_t n,
+    const T *A,
+    int64_t lda,
+    const T *b,
+    T *x,
+    int64_t block_size,
+    int64_t num_iters,
+    const state_t &state,
+    bool hogwild = false,
+    const ExecPolicy &exec = {}
+) {
+    randblas_require(1 <= block_size && block_size <= m);
+    randblas_require(num_iters >= 0);
+    randblas_require(lda >= ((layout == blas::Layout::ColMajor) ? m : n));
+    exec::ScopedPolicy scoped_policy(exec);
+    auto [a_row, a_col] = layout_to_strides(layout, lda);
+
+    // Sampling probabilities proportional to squared row norms.
+    std::vector<T> prob(m);
+    std::vector<int64_t> alias(m);
+    for (int64_t i = 0; i < m; ++i) {
+        T norm_i = blas::nrm2(n, A + i * a_row, a_col);
+        prob[i] = norm_i * norm_i;
+    }
+    weights_to_alias(m, prob.data(), alias.data());
+
+    // Draw every index up front, so the samples are the same whether or not steps run concurrently.
+    std::vector<int64_t> samples(num_iters * block_size);
+    auto next_state = sample_indices_iid_alias(m, prob.data(), alias.data(), num_iters * block_size, samples.data(), state);
+
+    if (!hogwild) {
+        kaczmarz::BlockWork<T> work(block_size, n);
+        std::vector<int64_t> idxs(block_size);
+        std::vector<T> dx(n);
+        for (int64_t it = 0; it < num_iters; ++it) {
+            idxs.assign(samples.begin() + it * block_size, samples.begin() + (it + 1) * block_size);
+            kaczmarz::block_update(n, A, a_row, a_col, b, idxs, x, dx.data(), work);
+            blas::axpy(n, (T) 1.0, dx.data(), 1, x, 1);
+        }
+        return next_state;
+    }
+
+    parallel::parallel_for(0, num_iters, [&](int64_t it_start, int64_t it_stop) {
+        kaczmarz::BlockWork<T> work(block_size, n);
+        std::vector<int64_t> idxs(block_size);
+        std::vector<T> x_snap(n);
+        std::vector<T> dx(n);
+        for (int64_t it = it_start; it < it_stop; ++it) {
+            for (int64_t j = 0; j < n; ++j)
+                x_snap[j] = std::atomic_ref<T>(x[j]).load(std::memory_order_relaxed);
+            idxs.assign(samples.begin() + it * block_size, samples.begin() + (it + 1) * block_size);
+            kaczmarz::block_update(n, A, a_row, a_col, b, idxs, x_snap.data(), dx.data(), work);
+            for (int64_t j = 0; j < n; ++j)
+                std::atomic_ref<T>(x[j]).fetch_add(dx[j], std::memory_order_relaxed);
+        }
+    }, 1);
+    return next_state;
+}
+
+} // end namespace RandBLAS
@@ -0,0 +1,220 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace RandBLAS::leverage {
+
+// Overwrite the upper triangle of the column-major d-by-n matrix A (d >= n) with the
+// triangular factor R from a Householder QR decomposition of A. The strict lower
+// triangle is left in an unspecified state. Returns false if some diagonal entry
+// of R is zero to within working precision.
+template <typename T>
+bool householder_r(int64_t d, int64_t n, T *A, int64_t lda) {
+    randblas_require(d >= n);
+    std::vector<T> w(n);
+    T tol = (T) d * std::numeric_limits<T>::epsilon();
+    T r00 = (T) 0;
+    for (int64_t j = 0; j < n; ++j) {
+        T *x = A + j + j * lda;
+        int64_t len = d - j;
+        T norm_x = blas::nrm2(len, x, 1);
+        if (j == 0)
+            r00 = norm_x;
+        if (norm_x <= tol * r00 || norm_x == (T) 0)
+            return false;
+        // The reflector is I - 2 v v^T / (v^T v), with v = x - r_jj e_1 stored in place of x.
+        T r_jj = (x[0] > 0) ? -norm_x : norm_x;
+        x[0] -= r_jj;
+        T vtv = blas::dot(len, x, 1, x, 1);
+        int64_t n_trail = n - j - 1;
+        if (n_trail > 0) {
+            T *A_trail = A + j + (j + 1) * lda;
+            blas::gemv(blas::Layout::ColMajor, blas::Op::Trans, len, n_trail, (T) 1.0, A_trail, lda, x, 1, (T) 0.0, w.data(), 1);
+            blas::ger(blas::Layout::ColMajor, len, n_trail, (T) -2.0 / vtv, x, 1, w.data(), 1, A_trail, lda);
+        }
+        x[0] = r_jj;
+    }
+    return true;
+}
+
+} // end namespace RandBLAS::leverage
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Approximate the leverage scores of a tall matrix :math:`\mat(A)` with :math:`m \geq n` rows and
+/// full column rank. The :math:`i^{\text{th}}` leverage score is :math:`\|\mtxQ[i,:]\|_2^2`, where the
+/// columns of :math:`\mtxQ` are an orthonormal basis for the range of :math:`\mat(A).`
+///
+/// We follow the method of Drineas, Magdon-Ismail, Mahoney, and Woodruff (2012).
+///
+///   1. Sketch :math:`\mat(A)` with a :math:`d \times m` SparseSkOp :math:`\mtxS.`
+///   2. Compute the triangular factor :math:`\mtxR` of a QR decomposition of :math:`\mtxS\mat(A).`
+///   3. Form the :math:`n \times k` matrix :math:`\Omega = \mtxR^{-1}\mtxG / \sqrt{k},` where :math:`\mtxG` is Gaussian.
+///   4. Set :math:`\ttt{lev}[i] = \|\mat(A)[i,:]\,\Omega\|_2^2.`
+///
+/// Steps 3 and 4 replace the two products :math:`\mat(A)\mtxR^{-1}` and :math:`(\mat(A)\mtxR^{-1})\mtxG`
+/// by a single pass over :math:`\mat(A)` in blocks of rows. Each block is multiplied by :math:`\Omega`
+/// and reduced to squared row norms while it is in cache, so no :math:`m \times n` or :math:`m \times k`
+/// intermediate is formed. If :math:`k \geq n` then we skip the Gaussian projection and use
+/// :math:`\Omega = \mtxR^{-1}.`
+///
+/// On exit, :math:`\ttt{lev}` holds nonnegative weights that can be passed to weights_to_cdf
+/// and then to sample_indices_iid.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor.
+/// @param[in] m
+///     The number of rows in \math{\mat(A).}
+/// @param[in] n
+///     The number of columns in \math{\mat(A).} We require \math{n \leq m.}
+/// @param[in] A
+///     Pointer to the buffer for \math{\mat(A),} read with leading dimension \math{\ttt{lda}.}
+/// @param[in] lda
+///     Leading dimension of \math{\mat(A)} in the given layout.
+/// @param[out] lev
+///     Pointer to an array of length \math{m.}
+/// @param[in] state
+///     The RNGState used to sample \math{\mtxS} and \math{\mtxG.}
+/// @param[in] d
+///     The number of rows in \math{\mtxS.} We use \math{\min\{4n, m\}} if \math{d = 0.}
+///     Otherwise we require \math{n \leq d.}
+/// @param[in] k
+///     The number of columns in \math{\mtxG.} If \math{k = 0} then we use
+///     \math{\max\{8, \lceil 4 \log m \rceil\}.}
+/// @param[in] exec
+///     Execution policy for the pass over \math{\mat(A).}
+/// @returns
+///     An RNGState that should be used the next time a random sampling function is called.
+///
+template <typename T, typename state_t = RNGState<DefaultRNG>>
+state_t approx_leverage_scores(
+    blas::Layout layout,
+    int64_t m,
+    int64_t n,
+    const T *A,
+    int64_t lda,
+    T *lev,
+    const state_t &state,
+    int64_t d = 0,
+    int64_t k = 0,
+    const ExecPolicy &exec = {}
+) {
+    randblas_require(n <= m);
+    randblas_require(lda >= ((layout == blas::Layout::ColMajor) ? m : n));
+    if (n == 0) {
+        std::fill(lev, lev + m, (T) 0.0);
+        return state;
+    }
+    if (d == 0)
+        d = std::min(4 * n, m);
+    randblas_require(n <= d);
+    if (k == 0)
+        k = std::max((int64_t) 8, (int64_t) std::ceil(4.0 * std::log((double) m)));
+    bool use_jl = k < n;
+    if (!use_jl)
+        k = n;
+    exec::ScopedPolicy scoped_policy(exec);
+
+    // Steps 1 and 2: R from a QR decomposition of S * A, with S sparse.
+    int64_t vec_nnz = std::min((int64_t) 8, d);
+    SparseDist D_S(d, m, vec_nnz, Axis::Short);
+    SparseSkOp<T, typename state_t::generator> S(D_S, state);
+    std::vector<T> SA(d * n);
+    int64_t ldsa = (layout == blas::Layout::ColMajor) ? d : n;
+    T iso = (T) D_S.isometry_scale;
+    sketch_general(layout, blas::Op::NoTrans, blas::Op::NoTrans, d, n, m, iso, S, A, lda, (T) 0.0, SA.data(), ldsa);
+    if (layout == blas::Layout::RowMajor) {
+        std::vector<T> SA_rowmajor(SA);
+        util::omatcopy(d, n, SA_rowmajor.data(), n, 1, SA.data(), 1, d);
+    }
+    bool full_rank = leverage::householder_r(d, n, SA.data(), d);
+    randblas_error_if_msg(!full_rank, "The sketch of A is rank-deficient to working precision.");
+
+    // Step 3: Omega = R^{-1} G / sqrt(k), stored column-major.
+    std::vector<T> Omega(n * k, (T) 0.0);
+    auto next_state = S.next_state;
+    if (use_jl) {
+        next_state = fill_dense(DenseDist(n, k), Omega.data(), next_state);
+    } else {
+        for (int64_t i = 0; i < n; ++i)
+            Omega[i + i * n] = (T) 1.0;
+    }
+    T scale = (use_jl) ? (T) 1.0 / std::sqrt((T) k) : (T) 1.0;
+    blas::trsm(blas::Layout::ColMajor, blas::Side::Left, blas::Uplo::Upper, blas::Op::NoTrans, blas::Diag::NonUnit,
+        n, k, scale, SA.data(), d, Omega.data(), n);
+
+    // Step 4: one pass over A, in blocks of rows. Read in column-major order, a row-major
+    // buffer for a block of A holds the block's transpose.
+    blas::Op opA_block = (layout == blas::Layout::ColMajor) ? blas::Op::NoTrans : blas::Op::Trans;
+    int64_t block_rows = 256;
+    int64_t num_blocks = (m + block_rows - 1) / block_rows;
+    int64_t A_inter_row = layout_to_strides(layout, lda).inter_row_stride;
+    parallel::parallel_for(0, num_blocks, [&](int64_t b_start, int64_t b_stop) {
+        std::vector<T> W(block_rows * k);
+        for (int64_t b = b_start; b < b_stop; ++b) {
+            int64_t i0 = b * block_rows;
+            int64_t nb = std::min(block_rows, m - i0);
+            // W = A[i0:i0+nb, :] * Omega, stored column-major with leading dimension nb.
+            blas::gemm(blas::Layout::ColMajor, opA_block, blas::Op::NoTrans, nb, k, n, (T) 1.0, A + i0 * A_inter_row, lda,
+                Omega.data(), n, (T) 0.0, W.data(), nb);
+            for (int64_t i = 0; i < nb; ++i)
+                lev[i0 + i] = (T) 0.0;
+            for (int64_t j = 0; j < k; ++j) {
+                const T *w = W.data() + j * nb;
+                for (int64_t i = 0; i < nb; ++i)
+                    lev[i0 + i] += w[i] * w[i];
+            }
+        }
+    }, 1);
+    return next_state;
+}
+
+} // end namespace RandBLAS
@@ -0,0 +1,566 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+
+namespace RandBLAS {
+
+#ifdef __cpp_concepts
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// A linear operator is a matrix :math:`\mtxA` that we can only access through
+/// block products with dense matrices. An object :math:`\ttt{A}` of type :math:`\ttt{LinOp}`
+/// has the following attributes.
+///
+/// .. list-table::
+///    :widths: 25 30 40
+///    :header-rows: 1
+///
+///    * -
+///      - type
+///      - description
+///    * - :math:`\ttt{A.n_rows}`
+///      - :math:`\ttt{const int64_t}`
+///      - number of rows
+///    * - :math:`\ttt{A.n_cols}`
+///      - :math:`\ttt{const int64_t}`
+///      - number of columns
+///
+/// It also has a function call operator with the following signature.
+///
+/// .. code:: c++
+///
+///     void operator()(
+///         blas::Layout layout, blas::Op opA, blas::Op opX, int64_t m, int64_t n, int64_t k,
+///         T alpha, const T *X, int64_t ldx, T beta, T *C, int64_t ldc
+///     );
+///
+/// A call to this function must overwrite :math:`\mat(C)` with
+///
+/// .. math::
+///     \mat(C) = \alpha \cdot \underbrace{\op(\mtxA)}_{m \times k} \cdot \underbrace{\op(\mat(X))}_{k \times n} + \beta \cdot \underbrace{\mat(C)}_{m \times n},
+///
+/// where :math:`\mat(X)` and :math:`\mat(C)` are read with the given layout, exactly as in GEMM.
+///
+/// @endverbatim
+template<typename LinOp>
+concept LinearOperator = requires(LinOp A) {
+    typename LinOp::scalar_t;
+    { A.n_rows } -> std::convertible_to<const int64_t>;
+    { A.n_cols } -> std::convertible_to<const int64_t>;
+} && requires(
+    LinOp A, blas::Layout layout, blas::Op op, int64_t i, typename LinOp::scalar_t a,
+    const typename LinOp::scalar_t *X, typename LinOp::scalar_t *C
+) {
+    { A(layout, op, op, i, i, i, a, X, i, a, C, i) } -> std::same_as<void>;
+};
+#else
+#define LinearOperator typename
+#endif
+
+// =============================================================================
+/// A LinearOperator whose block products are computed by a user-provided callback.
+/// The callback has the same signature and semantics as the function call operator
+/// described in the LinearOperator concept.
+template <typename T>
+struct CallbackOperator {
+    using scalar_t = T;
+    using callback_t = std::function<void(
+        blas::Layout, blas::Op, blas::Op, int64_t, int64_t, int64_t, T, const T*, int64_t, T, T*, int64_t
+    )>;
+
+    // ---------------------------------------------------------------------------
+    ///  Number of rows of \math{\mtxA.}
+    const int64_t n_rows;
+
+    // ---------------------------------------------------------------------------
+    ///  Number of columns of \math{\mtxA.}
+    const int64_t n_cols;
+
+    // ---------------------------------------------------------------------------
+    ///  Computes \math{\mat(C) = \alpha \cdot \op(\mtxA) \cdot \op(\mat(X)) + \beta \cdot \mat(C).}
+    callback_t apply;
+
+    CallbackOperator(int64_t n_rows, int64_t n_cols, callback_t apply)
+        : n_rows(n_rows), n_cols(n_cols), apply(std::move(apply)) { };
+
+    void operator()(
+        blas::Layout layout, blas::Op opA, blas::Op opX, int64_t m, int64_t n, int64_t k,
+        T alpha, const T *X, int64_t ldx, T beta, T *C, int64_t ldc
+    ) {
+        apply(layout, opA, opX, m, n, k, alpha, X, ldx, beta, C, ldc);
+    }
+};
+
+// =============================================================================
+/// Says how a ProductOperator applies itself to a block of vectors.
+enum class ProductOrder : char {
+    // ---------------------------------------------------------------------------
+    ///  Pick Sequential or FormFirst, whichever needs fewer flops according to
+    ///  product_flops. Ties go to Sequential, which needs less workspace when the
+    ///  block has few columns.
+    Auto = 'A',
+
+    // ---------------------------------------------------------------------------
+    ///  Compute \math{(P \cdot Q) \cdot X} as \math{P \cdot (Q \cdot X).}
+    Sequential = 'S',
+
+    // ---------------------------------------------------------------------------
+    ///  Form \math{P \cdot Q} explicitly, then multiply it by \math{X.}
+    FormFirst = 'F'
+};
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Returns the number of flops needed to compute :math:`(P \cdot Q) \cdot X`, where :math:`P` is
+/// :math:`m \times r,` :math:`Q` is :math:`r \times k,` and :math:`X` is :math:`k \times n,`
+/// when the product is associated as specified by :math:`\ttt{order}.`
+/// If :math:`\ttt{order}` is ProductOrder::Auto, this returns the smaller of the two counts.
+///
+/// When sketching :math:`\mtxS \cdot (\mtxB \cdot \mtxC)` from the left with a :math:`d \times m`
+/// operator :math:`\mtxS,` the roles are :math:`P = \mtxC^{T},` :math:`Q = \mtxB^{T},` and :math:`X = \mtxS^{T},`
+/// so Sequential evaluates :math:`(\mtxS \cdot \mtxB) \cdot \mtxC.`
+/// @endverbatim
+inline int64_t product_flops(ProductOrder order, int64_t m, int64_t r, int64_t k, int64_t n) {
+    int64_t sequential = 2 * r * k * n + 2 * m * r * n;
+    int64_t form_first = 2 * m * r * k + 2 * m * k * n;
+    if (order == ProductOrder::Sequential)
+        return sequential;
+    if (order == ProductOrder::FormFirst)
+        return form_first;
+    return std::min(sequential, form_first);
+}
+
+// =============================================================================
+/// Resolves ProductOrder::Auto for a product \math{(P \cdot Q) \cdot X} with the dimensions
+/// described in product_flops. Other values of \math{\ttt{order}} are returned unchanged.
+inline ProductOrder resolve_product_order(ProductOrder order, int64_t m, int64_t r, int64_t k, int64_t n) {
+    if (order != ProductOrder::Auto)
+        return order;
+    int64_t sequential = product_flops(ProductOrder::Sequential, m, r, k, n);
+    int64_t form_first = product_flops(ProductOrder::FormFirst, m, r, k, n);
+    return (form_first < sequential) ? ProductOrder::FormFirst : ProductOrder::Sequential;
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// A LinearOperator representing the product of two dense matrices
+///
+/// .. math::
+///     \mtxA = \underbrace{\op_1(\mat(F_1))}_{\ttt{n_rows} \times \ttt{inner}} \cdot \underbrace{\op_2(\mat(F_2))}_{\ttt{inner} \times \ttt{n_cols}},
+///
+/// where both factors are read with the same layout, as in GEMM. For example, the Gram
+/// matrix :math:`\mtxA^{T}\mtxA` of an :math:`m \times n` matrix is a ProductOperator with
+/// :math:`\ttt{n_rows} = \ttt{n_cols} = n,` :math:`\ttt{inner} = m,` :math:`\op_1 = \ttt{Trans},`
+/// :math:`\op_2 = \ttt{NoTrans},` and :math:`F_1 = F_2 = A.`
+///
+/// The product is never formed when the object is constructed. Each block product decides
+/// whether to apply the factors one after another or to form :math:`\mtxA` first, based on
+/// the dimensions of the block; see ProductOrder and product_flops. This object does not
+/// own the memory of its factors.
+/// @endverbatim
+template <typename T>
+struct ProductOperator {
+    using scalar_t = T;
+
+    // ---------------------------------------------------------------------------
+    ///  Number of rows of \math{\mtxA.}
+    const int64_t n_rows;
+
+    // ---------------------------------------------------------------------------
+    ///  Number of columns of \math{\mtxA.}
+    const int64_t n_cols;
+
+    // ---------------------------------------------------------------------------
+    ///  Number of columns of \math{\op_1(\mat(F_1))} and rows of \math{\op_2(\mat(F_2)).}
+    const int64_t inner;
+
+    const blas::Layout layout;
+    const blas::Op op1;
+    const T *F1;
+    const int64_t ld1;
+    const blas::Op op2;
+    const T *F2;
+    const int64_t ld2;
+
+    // ---------------------------------------------------------------------------
+    ///  The association order used by block products.
+    ProductOrder order;
+
+    ProductOperator(
+        int64_t n_rows, int64_t n_cols, int64_t inner, blas::Layout layout,
+        blas::Op op1, const T *F1, int64_t ld1, blas::Op op2, const T *F2, int64_t ld2,
+        ProductOrder order = ProductOrder::Auto
+    ) : n_rows(n_rows), n_cols(n_cols), inner(inner), layout(layout),
+        op1(op1), F1(F1), ld1(ld1), op2(op2), F2(F2), ld2(ld2), order(order) {
+        auto [rows_F1, cols_F1] = dims_before_op(n_rows, inner, op1);
+        auto [rows_F2, cols_F2] = dims_before_op(inner, n_cols, op2);
+        if (layout == blas::Layout::ColMajor) {
+            randblas_require(ld1 >= rows_F1);
+            randblas_require(ld2 >= rows_F2);
+        } else {
+            randblas_require(ld1 >= cols_F1);
+            randblas_require(ld2 >= cols_F2);
+        }
+    };
+
+    void operator()(
+        blas::Layout layout_X, blas::Op opA, blas::Op opX, int64_t m, int64_t n, int64_t k,
+        T alpha, const T *X, int64_t ldx, T beta, T *C, int64_t ldc
+    ) {
+        auto [rows_A, cols_A] = dims_before_op(m, k, opA);
+        randblas_require(rows_A == n_rows);
+        randblas_require(cols_A == n_cols);
+        // A buffer that holds F in one layout holds F^T in the other, so we can
+        // read the factors in layout_X if we flip their transposition flags.
+        blas::Op op1_x = op1;
+        blas::Op op2_x = op2;
+        if (layout != layout_X) {
+            op1_x = (op1 == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+            op2_x = (op2 == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+        }
+        // Write op(A) = P * Q, where P is m-by-inner and Q is inner-by-k.
+        blas::Op opP = op1_x, opQ = op2_x;
+        const T *P = F1, *Q = F2;
+        int64_t ldp = ld1, ldq = ld2;
+        if (opA == blas::Op::Trans) {
+            opP = (op2_x == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+            opQ = (op1_x == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+            P = F2; ldp = ld2;
+            Q = F1; ldq = ld1;
+        }
+        int64_t r = inner;
+        bool is_colmajor = layout_X == blas::Layout::ColMajor;
+        if (resolve_product_order(order, m, r, k, n) == ProductOrder::Sequential) {
+            int64_t ldw = (is_colmajor) ? r : n;
+            std::vector<T> W(r * n);
+            blas::gemm(layout_X, opQ, opX, r, n, k, (T) 1.0, Q, ldq, X, ldx, (T) 0.0, W.data(), ldw);
+            blas::gemm(layout_X, opP, blas::Op::NoTrans, m, n, r, alpha, P, ldp, W.data(), ldw, beta, C, ldc);
+        } else {
+            int64_t ldw = (is_colmajor) ? m : k;
+            std::vector<T> W(m * k);
+            blas::gemm(layout_X, opP, opQ, m, k, r, (T) 1.0, P, ldp, Q, ldq, (T) 0.0, W.data(), ldw);
+            blas::gemm(layout_X, blas::Op::NoTrans, opX, m, n, k, alpha, W.data(), ldw, X, ldx, beta, C, ldc);
+        }
+    }
+};
+
+} // end namespace RandBLAS
+
+namespace RandBLAS::linops {
+
+// Call f(opS_eff, buff, lds), where buff is a dense representation of submat(S) that
+// must be read in the given layout and op(submat(S)) = opS_eff(mat(buff)). We point
+// into S.buff if S is filled; otherwise we build a temporary copy. SparseSkOps go
+// through for_each_dense_panel instead, so they're never densified all at once.
+template <typename T, typename SKOP, typename FUNC>
+void with_dense_submatrix(
+    blas::Layout layout, blas::Op opS, SKOP &S, int64_t rows_submat_S, int64_t cols_submat_S,
+    int64_t ro_s, int64_t co_s, FUNC &&f
+) {
+    static_assert(std::is_same_v<typename SKOP::distribution_t, DenseDist>);
+    randblas_require(ro_s + rows_submat_S <= S.n_rows);
+    randblas_require(co_s + cols_submat_S <= S.n_cols);
+    blas::Op flipped = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    dense::fill_if_lazy(S);
+    blas::Op opS_eff = (S.layout == layout) ? opS : flipped;
+    if (S.buff != nullptr) {
+        auto [pos, lds] = offset_and_ldim(S.layout, S.n_rows, S.n_cols, ro_s, co_s);
+        f(opS_eff, (const T *) S.buff + pos, lds);
+    } else {
+        auto submat_S = scaled_submatrix_as_blackbox<BLASFriendlyOperator<T>>(
+            S, rows_submat_S, cols_submat_S, ro_s, co_s, (const T *) nullptr, (const T *) nullptr
+        );
+        f(opS_eff, (const T *) submat_S.buff, submat_S.ldim);
+    }
+}
+
+// Call f(opS_eff, buff, lds, i, r) for consecutive panels of rows [i, i + r) of the
+// d-by-m matrix op(submat(S)). Here buff is a dense representation of the panel, read
+// as in with_dense_submatrix. A DenseSkOp is passed as a single panel. A SparseSkOp is
+// densified one panel at a time, with panels of about 2^20 entries.
+template <typename T, typename SKOP, typename FUNC>
+void for_each_dense_panel(
+    blas::Layout layout, blas::Op opS, SKOP &S, int64_t d, int64_t m,
+    int64_t ro_s, int64_t co_s, FUNC &&f
+) {
+    auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
+    if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        with_dense_submatrix<T>(layout, opS, S, rows_submat_S, cols_submat_S, ro_s, co_s,
+            [&](blas::Op opS_eff, const T *buff, int64_t lds) { f(opS_eff, buff, lds, (int64_t) 0, d); }
+        );
+    } else {
+        randblas_require(ro_s + rows_submat_S <= S.n_rows);
+        randblas_require(co_s + cols_submat_S <= S.n_cols);
+        sparse::fill_if_lazy(S);
+        if (S.nnz < 0) {
+            SKOP shallowcopy(S.dist, S.seed_state);
+            fill_sparse(shallowcopy);
+            for_each_dense_panel<T>(layout, opS, shallowcopy, d, m, ro_s, co_s, f);
+            return;
+        }
+        if (d == 0)
+            return;
+        int64_t panel_rows = std::max<int64_t>(64, (int64_t{1} << 20) / std::max<int64_t>(m, 1));
+        panel_rows = std::min(panel_rows, d);
+        int64_t num_panels = (d + panel_rows - 1) / panel_rows;
+        // Bucket the nonzeros in the window by panel, so that each panel is densified
+        // in time proportional to its own nonzeros.
+        bool trans = (opS == blas::Op::Trans);
+        std::vector<int64_t> start(num_panels + 1, 0);
+        auto op_coords = [&](int64_t ell) {
+            int64_t i = (int64_t) S.rows[ell] - ro_s;
+            int64_t j = (int64_t) S.cols[ell] - co_s;
+            bool in_window = (0 <= i && i < rows_submat_S && 0 <= j && j < cols_submat_S);
+            return std::make_tuple(in_window, (trans) ? j : i, (trans) ? i : j);
+        };
+        for (int64_t ell = 0; ell < S.nnz; ++ell) {
+            auto [in_window, i, j] = op_coords(ell);
+            if (in_window)
+                ++start[i / panel_rows + 1];
+        }
+        for (int64_t p = 0; p < num_panels; ++p)
+            start[p + 1] += start[p];
+        std::vector<int64_t> order(start[num_panels]);
+        std::vector<int64_t> next(start.begin(), start.end() - 1);
+        for (int64_t ell = 0; ell < S.nnz; ++ell) {
+            auto [in_window, i, j] = op_coords(ell);
+            if (in_window)
+                order[next[i / panel_rows]++] = ell;
+        }
+        std::vector<T> panel(panel_rows * m);
+        for (int64_t p = 0; p < num_panels; ++p) {
+            int64_t i0 = p * panel_rows;
+            int64_t r = std::min(panel_rows, d - i0);
+            int64_t lds = std::max<int64_t>(1, (layout == blas::Layout::ColMajor) ? r : m);
+            auto [s_row, s_col] = layout_to_strides(layout, lds);
+            std::fill(panel.begin(), panel.end(), (T) 0.0);
+            for (int64_t t = start[p]; t < start[p + 1]; ++t) {
+                int64_t ell = order[t];
+                auto [in_window, i, j] = op_coords(ell);
+                panel[(i - i0) * s_row + j * s_col] += S.vals[ell];
+            }
+            f(blas::Op::NoTrans, (const T *) panel.data(), lds, i0, r);
+        }
+    }
+}
+
+} // end namespace RandBLAS::linops
+
+namespace RandBLAS {
+
+// MARK: SKGE overloads, linear operators
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch an implicitly defined matrix from the left in a GEMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mtxA)}_{m \times n} + \beta \cdot \underbrace{\mat(B)}_{d \times n},    \tag{$\star$}
+///
+/// where :math:`\mtxA` is a LinearOperator. We compute :math:`(\star)` through calls to
+/// :math:`\mtxA`'s function call operator, using the transposed identity
+/// :math:`\mat(B)^{T} = \alpha \cdot \op(\mtxA)^{T} \cdot \op(\submat(\mtxS))^{T} + \beta \cdot \mat(B)^{T}.`
+/// If :math:`\mtxS` is a DenseSkOp then there's a single call, which receives a pointer into
+/// :math:`\mtxS`'s buffer when :math:`\mtxS` is filled and a temporary copy otherwise. If
+/// :math:`\mtxS` is a SparseSkOp then we densify panels of rows of :math:`\op(\submat(\mtxS))`
+/// one at a time, with about :math:`2^{20}` entries each, and make one call per panel.
+///
+/// The arguments that this function shares with sketch_general have the same meaning here.
+/// The only exception is :math:`\mtxA`, which must have :math:`m` rows and :math:`n` columns if
+/// opA is NoTrans, and :math:`n` rows and :math:`m` columns otherwise.
+///
+/// @endverbatim
+template <typename T, SketchingOperator SKOP, LinearOperator LINOP>
+void sketch_general(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    LINOP &A,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    static_assert(std::is_same_v<typename LINOP::scalar_t, T>);
+    auto [rows_A, cols_A] = dims_before_op(m, n, opA);
+    randblas_require(A.n_rows == rows_A);
+    randblas_require(A.n_cols == cols_A);
+    randblas_require(ldb >= ((layout == blas::Layout::ColMajor) ? d : n));
+    exec::ScopedPolicy scoped_policy(exec);
+    blas::Layout layout_t = (layout == blas::Layout::ColMajor) ? blas::Layout::RowMajor : blas::Layout::ColMajor;
+    blas::Op opA_t = (opA == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    linops::for_each_dense_panel<T>(layout, opS, S, d, m, ro_s, co_s,
+        [&](blas::Op opS_eff, const T *buff_S, int64_t lds, int64_t i, int64_t r) {
+            // In layout_t, the buffer for a panel of op(submat(S)) holds its transpose. So
+            // the panel's transpose is opS_eff applied to that buffer. The panel maps to
+            // rows [i, i + r) of B.
+            T *B_i = B + ((layout == blas::Layout::ColMajor) ? i : i * ldb);
+            A(layout_t, opA_t, opS_eff, n, r, m, alpha, buff_S, lds, beta, B_i, ldb);
+        }
+    );
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch an implicitly defined matrix from the right in a GEMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\mtxA)}_{m \times n} \cdot \underbrace{\op(\submat(\mtxS))}_{n \times d} + \beta \cdot \underbrace{\mat(B)}_{m \times d},    \tag{$\star$}
+///
+/// where :math:`\mtxA` is a LinearOperator. This is a single call to :math:`\mtxA`'s function call
+/// operator, with a dense representation of :math:`\submat(\mtxS)` as the right-hand factor. If
+/// :math:`\mtxS` is a SparseSkOp then we instead densify panels of columns of
+/// :math:`\op(\submat(\mtxS))` one at a time and make one call per panel.
+///
+/// @endverbatim
+template <typename T, SketchingOperator SKOP, LinearOperator LINOP>
+void sketch_general(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(submat(\mtxS)) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    LINOP &A,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    static_assert(std::is_same_v<typename LINOP::scalar_t, T>);
+    auto [rows_A, cols_A] = dims_before_op(m, n, opA);
+    randblas_require(A.n_rows == rows_A);
+    randblas_require(A.n_cols == cols_A);
+    randblas_require(ldb >= ((layout == blas::Layout::ColMajor) ? m : d));
+    exec::ScopedPolicy scoped_policy(exec);
+    // Columns [i, i + r) of op(submat(S)) are rows of its transpose, which we visit in panels.
+    blas::Op opS_t = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    linops::for_each_dense_panel<T>(layout, opS_t, S, d, n, ro_s, co_s,
+        [&](blas::Op opS_t_eff, const T *buff_S, int64_t lds, int64_t i, int64_t r) {
+            blas::Op opS_eff = (opS_t_eff == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+            T *B_i = B + ((layout == blas::Layout::ColMajor) ? i * ldb : i);
+            A(layout, opA, opS_eff, m, r, n, alpha, buff_S, lds, beta, B_i, ldb);
+        }
+    );
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch an implicitly defined matrix from the left, using all of :math:`\mtxS.`
+/// This is the same as the overload that takes :math:`(\ttt{ro_s}, \ttt{co_s})`, with both set to zero.
+/// We require that :math:`\op(\mtxS)` is :math:`d \times m.`
+/// @endverbatim
+template <typename T, SketchingOperator SKOP, LinearOperator LINOP>
+void sketch_general(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(S) is d-by-m
+    T alpha,
+    SKOP &S,
+    LINOP &A,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    if (opS == blas::Op::NoTrans) {
+        randblas_require(S.n_rows == d);
+        randblas_require(S.n_cols == m);
+    } else {
+        randblas_require(S.n_rows == m);
+        randblas_require(S.n_cols == d);
+    }
+    sketch_general(layout, opS, opA, d, n, m, alpha, S, 0, 0, A, beta, B, ldb, exec);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch an implicitly defined matrix from the right, using all of :math:`\mtxS.`
+/// This is the same as the overload that takes :math:`(\ttt{ro_s}, \ttt{co_s})`, with both set to zero.
+/// We require that :math:`\op(\mtxS)` is :math:`n \times d.`
+/// @endverbatim
+template <typename T, SketchingOperator SKOP, LinearOperator LINOP>
+void sketch_general(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(S) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    LINOP &A,
+    SKOP &S,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    if (opS == blas::Op::NoTrans) {
+        randblas_require(S.n_rows == n);
+        randblas_require(S.n_cols == d);
+    } else {
+        randblas_require(S.n_rows == d);
+        randblas_require(S.n_cols == n);
+    }
+    sketch_general(layout, opA, opS, m, d, n, alpha, A, S, 0, 0, beta, B, ldb, exec);
+}
+
+} // end namespace RandBLAS
@@ -0,0 +1,233 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/linops.hh"
+#include "RandBLAS/sparse_data/spmm_dispatch.hh"
+
+#include <blas.hh>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace RandBLAS::nystrom {
+
+// Given Y = A * Omega in F, where Omega is n-by-k and A is PSD, overwrite F with the
+// factor of a shifted Nyström approximation and return the shift. Omega and F are
+// stored in the given layout.
+template <typename T>
+T factor_from_sketch(blas::Layout layout, int64_t n, int64_t k, const T *Omega, int64_t ldo, T *F, int64_t ldf) {
+    using blas::Layout;
+    using blas::Op;
+    bool colmajor = layout == Layout::ColMajor;
+    // Shift by nu = sqrt(n) * eps * ||Y||_F, and set Y = Y + nu * Omega.
+    T norm_Y = (T) 0.0;
+    for (int64_t j = 0; j < ((colmajor) ? k : n); ++j) {
+        T norm_j = blas::nrm2((colmajor) ? n : k, F + j * ldf, 1);
+        norm_Y = std::hypot(norm_Y, norm_j);
+    }
+    T nu = std::sqrt((T) n) * std::numeric_limits<T>::epsilon() * norm_Y;
+    for (int64_t j = 0; j < ((colmajor) ? k : n); ++j)
+        blas::axpy((colmajor) ? n : k, nu, Omega + j * ldo, 1, F + j * ldf, 1);
+
+    // The core matrix M = Omega^T Y is symmetric, so its buffer reads the same in
+    // either layout. We factor it as M = R^T R with R stored column-major.
+    std::vector<T> M(k * k);
+    blas::gemm(layout, Op::Trans, Op::NoTrans, k, k, n, (T) 1.0, Omega, ldo, F, ldf, (T) 0.0, M.data(), k);
+    bool posdef = util::cholesky_upper(k, M.data(), k);
+    randblas_error_if_msg(!posdef, "The Nyström core matrix isn't positive definite. A may not be PSD.");
+
+    // F = Y R^{-1}. A column-major upper-triangular R is lower-triangular when read row-major.
+    blas::Uplo uplo_R = (colmajor) ? blas::Uplo::Upper : blas::Uplo::Lower;
+    Op op_R = (colmajor) ? Op::NoTrans : Op::Trans;
+    blas::trsm(layout, blas::Side::Right, uplo_R, op_R, blas::Diag::NonUnit, n, k, (T) 1.0, M.data(), k, F, ldf);
+    return nu;
+}
+
+// Write the n-by-k operator S to Omega in the given layout, with leading dimension ldo.
+template <typename T, typename SKOP>
+void materialize(blas::Layout layout, int64_t n, int64_t k, SKOP &S, T *Omega, int64_t ldo) {
+    auto [o_row, o_col] = layout_to_strides(layout, ldo);
+    linops::for_each_dense_panel<T>(layout, blas::Op::NoTrans, S, n, k, 0, 0,
+        [&](blas::Op opS_eff, const T *buff, int64_t lds, int64_t i, int64_t r) {
+            auto [s_row, s_col] = layout_to_strides(layout, lds);
+            if (opS_eff == blas::Op::NoTrans)
+                util::omatcopy(r, k, buff, s_row, s_col, Omega + i * o_row, o_row, o_col);
+            else
+                util::omatcopy(r, k, buff, s_col, s_row, Omega + i * o_row, o_row, o_col);
+        }
+    );
+}
+
+} // end namespace RandBLAS::nystrom
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute a rank-:math:`k` Nyström approximation :math:`\mat(A) \approx \mat(F)\mat(F)^T` of a symmetric
+/// positive semidefinite matrix :math:`\mat(A)` of order :math:`n`, using the test matrix :math:`\Omega = \mtxS.`
+///
+/// We follow the stabilized method of Tropp, Yurtsever, Udell, and Cevher (2017).
+///
+///   1. Compute :math:`\mtxY = \mat(A)\,\Omega` with SYMM, reading only the :math:`\ttt{uplo}` triangle of :math:`\mat(A).`
+///   2. Pick a shift :math:`\nu = \sqrt{n}\,\epsilon\,\|\mtxY\|_F` and set :math:`\mtxY_\nu = \mtxY + \nu\,\Omega.`
+///   3. Factor the core matrix :math:`\Omega^T\mtxY_\nu = \mtxR^T\mtxR` by Cholesky.
+///   4. Set :math:`\mat(F) = \mtxY_\nu \mtxR^{-1}.`
+///
+/// So :math:`\mat(F)\mat(F)^T` is the Nyström approximation of :math:`\mat(A) + \nu \mtxI,` and :math:`\mat(A)` is
+/// touched once. Unlike sketch_symmetric, this doesn't scan :math:`\mat(A)` to check that it's symmetric.
+/// The shift is returned. Callers that need the eigendecomposition of the approximation of :math:`\mat(A)`
+/// itself can take the SVD :math:`\mat(F) = \mtxU\Sigma\mtxV^T` and use eigenvalues :math:`\max\{\sigma_i^2 - \nu, 0\}.`
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(A)} and \math{\mat(F).}
+/// @param[in] uplo
+///     Uplo::Upper or Uplo::Lower. Only this triangle of \math{\mat(A)} is read.
+/// @param[in] n
+///     The order of \math{\mat(A).}
+/// @param[in] k
+///     The rank of the approximation.
+/// @param[in] A
+///     Pointer to the buffer for \math{\mat(A),} read with leading dimension \math{\ttt{lda}.}
+/// @param[in] lda
+///     Leading dimension of \math{\mat(A).} We require \math{\ttt{lda} \geq n.}
+/// @param[in] S
+///     An \math{n \times k} DenseSkOp or SparseSkOp.
+/// @param[out] F
+///     Pointer to the buffer for the \math{n \times k} matrix \math{\mat(F).}
+/// @param[in] ldf
+///     Leading dimension of \math{\mat(F)} in the given layout.
+/// @param[in] exec
+///     Execution policy for the products with \math{\mat(A)} and the factorization.
+/// @returns
+///     The shift \math{\nu.}
+///
+template <typename T, SketchingOperator SKOP>
+T nystrom_factor(
+    blas::Layout layout,
+    blas::Uplo uplo,
+    int64_t n,
+    int64_t k,
+    const T *A,
+    int64_t lda,
+    SKOP &S,
+    T *F,
+    int64_t ldf,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    bool colmajor = layout == blas::Layout::ColMajor;
+    randblas_require(S.n_rows == n);
+    randblas_require(S.n_cols == k);
+    randblas_require(lda >= n);
+    randblas_require(ldf >= ((colmajor) ? n : k));
+    if (n == 0 || k == 0)
+        return (T) 0.0;
+    int64_t ldo = (colmajor) ? n : k;
+    std::vector<T> Omega(n * k);
+    nystrom::materialize(layout, n, k, S, Omega.data(), ldo);
+    blas::symm(layout, blas::Side::Left, uplo, n, k, (T) 1.0, A, lda, Omega.data(), ldo, (T) 0.0, F, ldf);
+    return nystrom::factor_from_sketch(layout, n, k, Omega.data(), ldo, F, ldf);
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Compute a rank-:math:`k` Nyström approximation :math:`\mat(A) \approx \mat(F)\mat(F)^T` of a sparse
+/// symmetric positive semidefinite matrix :math:`\mat(A)`, using the :math:`n \times k` test matrix :math:`\Omega = \mtxS.`
+///
+/// :math:`\mat(A)` is given by one of its triangles, including the diagonal: the sparse matrix :math:`\ttt{A}`
+/// must not have nonzeros on both sides of the diagonal. We compute :math:`\mat(A)\,\Omega` as
+/// :math:`\ttt{A}\,\Omega + \ttt{A}^T\Omega - \operatorname{diag}(\ttt{A})\,\Omega` with two sparse-times-dense
+/// products. The rest is the same as the dense overload, and the shift :math:`\nu` is returned.
+///
+/// @endverbatim
+/// @param[in] layout
+///     Layout::ColMajor or Layout::RowMajor. Applies to \math{\mat(F).}
+/// @param[in] A
+///     A COOMatrix, CSRMatrix, or CSCMatrix with zero-based indexing that holds one triangle of \math{\mat(A).}
+/// @param[in] S
+///     An \math{n \times k} DenseSkOp or SparseSkOp.
+/// @param[out] F
+///     Pointer to the buffer for the \math{n \times k} matrix \math{\mat(F).}
+/// @param[in] ldf
+///     Leading dimension of \math{\mat(F)} in the given layout.
+/// @param[in] exec
+///     Execution policy for the products with \math{\mat(A)} and the factorization.
+/// @returns
+///     The shift \math{\nu.}
+///
+template <SparseMatrix SpMat, SketchingOperator SKOP, typename T = SpMat::scalar_t>
+T nystrom_factor(
+    blas::Layout layout,
+    SpMat &A,
+    SKOP &S,
+    T *F,
+    int64_t ldf,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    using blas::Op;
+    bool colmajor = layout == blas::Layout::ColMajor;
+    int64_t n = A.n_rows;
+    int64_t k = S.n_cols;
+    randblas_require(A.n_cols == n);
+    randblas_require(A.index_base == IndexBase::Zero);
+    randblas_require(S.n_rows == n);
+    randblas_require(ldf >= ((colmajor) ? n : k));
+    if (n == 0 || k == 0)
+        return (T) 0.0;
+    int64_t ldo = (colmajor) ? n : k;
+    std::vector<T> Omega(n * k);
+    nystrom::materialize(layout, n, k, S, Omega.data(), ldo);
+    spmm(layout, Op::NoTrans, Op::NoTrans, n, k, n, (T) 1.0, A, Omega.data(), ldo, (T) 0.0, F, ldf);
+    spmm(layout, Op::Trans, Op::NoTrans, n, k, n, (T) 1.0, A, Omega.data(), ldo, (T) 1.0, F, ldf);
+    // The diagonal was added twice.
+    auto [o_row, o_col] = layout_to_strides(layout, ldo);
+    auto [f_row, f_col] = layout_to_strides(layout, ldf);
+    sparse_data::for_each_in_window(A, 0, 0, n, n, [&](int64_t i, int64_t j, int64_t ell) {
+        if (i == j)
+            blas::axpy(k, -A.vals[ell], Omega.data() + i * o_row, o_col, F + i * f_row, f_col);
+    });
+    return nystrom::factor_from_sketch(layout, n, k, Omega.data(), ldo, F, ldf);
+}
+
+} // end namespace RandBLAS
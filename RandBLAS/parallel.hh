@@ -0,0 +1,159 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(RandBLAS_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#elif defined(RandBLAS_HAS_OpenMP)
+#include <omp.h>
+#endif
+
+
+/// Backend-neutral parallel loops.
+///
+/// Every parallel loop in RandBLAS goes through parallel_for. Which runtime
+/// executes those loops is decided when RandBLAS is configured:
+///
+///     RandBLAS_HAS_TBB defined     -->  oneTBB's parallel_for.
+///     RandBLAS_HAS_OpenMP defined  -->  OpenMP parallel regions.
+///     neither defined              -->  serial execution on the calling thread.
+///
+/// In all cases the calling thread's ExecPolicy determines how many workers
+/// may participate (see exec::num_threads()).
+namespace RandBLAS::parallel {
+
+// -----------------------------------------------------------------------------
+/// Returns the name of the backend that executes parallel_for.
+inline const char* backend_name() {
+    #if defined(RandBLAS_HAS_TBB)
+    return "TBB";
+    #elif defined(RandBLAS_HAS_OpenMP)
+    return "OpenMP";
+    #else
+    return "Serial";
+    #endif
+}
+
+// -----------------------------------------------------------------------------
+/// Partition [begin, end) into num_blocks contiguous pieces whose lengths differ
+/// by at most one, and return the bounds of the piece with index "block."
+inline std::pair<int64_t, int64_t> static_block(int64_t begin, int64_t end, int64_t block, int64_t num_blocks) {
+    int64_t len  = end - begin;
+    int64_t base = len / num_blocks;
+    int64_t rem  = len % num_blocks;
+    int64_t lo = begin + block * base + std::min(block, rem);
+    int64_t hi = lo + base + ((block < rem) ? 1 : 0);
+    return {lo, hi};
+}
+
+// =============================================================================
+/// Split the index range [begin, end) into disjoint contiguous blocks and
+/// call body(block_begin, block_end) once for each block. Calls for different
+/// blocks may run concurrently.
+///
+/// If grain is nonpositive then the range is split statically into (at most)
+/// one block per worker. If grain is positive then blocks contain at most
+/// grain indices and are handed to workers dynamically; this is meant for
+/// loops whose iterations have uneven cost.
+///
+/// The body is responsible for any per-block workspace it needs. It must not
+/// throw.
+///
+template <typename Body>
+void parallel_for(int64_t begin, int64_t end, const Body &body, int64_t grain = 0) {
+    if (end <= begin)
+        return;
+    const ExecPolicy &policy = exec::current_policy();
+    if (policy.serial) {
+        body(begin, end);
+        return;
+    }
+    #if defined(RandBLAS_HAS_TBB)
+    auto run = [&]() {
+        if (grain <= 0) {
+            tbb::parallel_for(
+                tbb::blocked_range<int64_t>(begin, end),
+                [&](const tbb::blocked_range<int64_t> &r) { body(r.begin(), r.end()); },
+                tbb::static_partitioner()
+            );
+        } else {
+            tbb::parallel_for(
+                tbb::blocked_range<int64_t>(begin, end, grain),
+                [&](const tbb::blocked_range<int64_t> &r) { body(r.begin(), r.end()); },
+                tbb::simple_partitioner()
+            );
+        }
+    };
+    if (policy.num_threads > 0) {
+        tbb::task_arena arena(policy.num_threads);
+        arena.execute(run);
+    } else {
+        run();
+    }
+    #elif defined(RandBLAS_HAS_OpenMP)
+    int num_threads = exec::num_threads();
+    if (num_threads <= 1) {
+        body(begin, end);
+        return;
+    }
+    if (grain <= 0) {
+        #pragma omp parallel num_threads(num_threads)
+        {
+            auto bounds = static_block(begin, end, omp_get_thread_num(), omp_get_num_threads());
+            if (bounds.first < bounds.second)
+                body(bounds.first, bounds.second);
+        }
+    } else {
+        int64_t num_blocks = (end - begin + grain - 1) / grain;
+        #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+        for (int64_t b = 0; b < num_blocks; ++b) {
+            int64_t lo = begin + b * grain;
+            body(lo, std::min(end, lo + grain));
+        }
+    }
+    #else
+    (void) grain;
+    body(begin, end);
+    #endif
+    return;
+}
+
+} // end namespace RandBLAS::parallel
@@ -0,0 +1,287 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+
+#include <blas.hh>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// Says how the scale factors of a quantized matrix are laid out.
+enum class ScaleAxis : char {
+    // ---------------------------------------------------------------------------
+    ///  One scale factor per row: \math{A_{ij} = \ttt{scales}[i] \cdot Q_{ij}.}
+    Rows = 'R',
+
+    // ---------------------------------------------------------------------------
+    ///  One scale factor per column: \math{A_{ij} = \ttt{scales}[j] \cdot Q_{ij}.}
+    Cols = 'C'
+};
+
+namespace quantized {
+
+// Write the kb-by-nb block of op(mat(A)) starting at (k0, j0), dequantized, into P.
+// P is stored in "layout" with leading dimension ldp.
+template <typename T, typename Q>
+void dequantize_panel(
+    blas::Layout layout, blas::Op opA, const Q *A, int64_t lda, const T *scales, ScaleAxis scale_axis,
+    int64_t k0, int64_t j0, int64_t kb, int64_t nb, T *P, int64_t ldp
+) {
+    auto [a_row, a_col] = layout_to_strides(layout, lda);
+    if (opA == blas::Op::Trans)
+        std::swap(a_row, a_col);
+    // Now op(mat(A))[i, j] = A[i * a_row + j * a_col], and its scale factor is
+    // scales[i] or scales[j], depending on scale_axis and opA.
+    bool scale_by_row = (scale_axis == ScaleAxis::Rows) == (opA == blas::Op::NoTrans);
+    bool colmajor = layout == blas::Layout::ColMajor;
+    int64_t outer = colmajor ? nb : kb;
+    int64_t inner = colmajor ? kb : nb;
+    parallel::parallel_for(0, outer, [&](int64_t o_start, int64_t o_stop) {
+        for (int64_t o = o_start; o < o_stop; ++o) {
+            T *p = P + o * ldp;
+            if (colmajor) {
+                // P[:, o] is column j0 + o of the block.
+                const Q *a = A + (j0 + o) * a_col + k0 * a_row;
+                if (scale_by_row) {
+                    for (int64_t t = 0; t < inner; ++t)
+                        p[t] = scales[k0 + t] * (T) a[t * a_row];
+                } else {
+                    T s = scales[j0 + o];
+                    for (int64_t t = 0; t < inner; ++t)
+                        p[t] = s * (T) a[t * a_row];
+                }
+            } else {
+                // P[o, :] is row k0 + o of the block.
+                const Q *a = A + (k0 + o) * a_row + j0 * a_col;
+                if (scale_by_row) {
+                    T s = scales[k0 + o];
+                    for (int64_t t = 0; t < inner; ++t)
+                        p[t] = s * (T) a[t * a_col];
+                } else {
+                    for (int64_t t = 0; t < inner; ++t)
+                        p[t] = scales[j0 + t] * (T) a[t * a_col];
+                }
+            }
+        }
+    });
+}
+
+// Apply a filled operator (a DenseSkOp, BLASFriendlyOperator, or SparseSkOp) to
+// op(mat(A)) one dequantized panel at a time. Arguments are as in sketch_quantized.
+template <bool dense_op, typename T, typename Q, typename SKOP>
+void lskgeq(
+    blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+    T alpha, SKOP &S, int64_t ro_s, int64_t co_s, const Q *A, int64_t lda,
+    const T *scales, ScaleAxis scale_axis, T beta, T *B, int64_t ldb
+) {
+    // Panels of op(mat(A)) have at most tile_elements entries; that's 2 MiB in double precision.
+    constexpr int64_t tile_elements = 1 << 18;
+    int64_t kb, nb;
+    if constexpr (dense_op) {
+        nb = std::min(n, (int64_t) 256);
+        kb = std::clamp(tile_elements / nb, (int64_t) 1, m);
+    } else {
+        kb = m;
+        nb = std::clamp(tile_elements / m, (int64_t) 1, n);
+    }
+    auto b_col = layout_to_strides(layout, ldb).inter_col_stride;
+    std::vector<T> panel(kb * nb);
+    for (int64_t j0 = 0; j0 < n; j0 += nb) {
+        int64_t nc = std::min(nb, n - j0);
+        T *B_panel = B + j0 * b_col;
+        for (int64_t k0 = 0; k0 < m; k0 += kb) {
+            int64_t kc = std::min(kb, m - k0);
+            int64_t ldp = (layout == blas::Layout::ColMajor) ? kc : nc;
+            dequantize_panel(layout, opA, A, lda, scales, scale_axis, k0, j0, kc, nc, panel.data(), ldp);
+            int64_t ro = (opS == blas::Op::NoTrans) ? ro_s : ro_s + k0;
+            int64_t co = (opS == blas::Op::NoTrans) ? co_s + k0 : co_s;
+            T beta_k = (k0 == 0) ? beta : (T) 1;
+            if constexpr (dense_op) {
+                dense::lskge3(layout, opS, blas::Op::NoTrans, d, nc, kc, alpha, S, ro, co, panel.data(), ldp, beta_k, B_panel, ldb);
+            } else {
+                sparse::lskges(layout, opS, blas::Op::NoTrans, d, nc, kc, alpha, S, ro, co, panel.data(), ldp, beta_k, B_panel, ldb);
+            }
+        }
+    }
+}
+
+} // end namespace RandBLAS::quantized
+
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a quantized matrix from the left in a GEMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mat(A))}_{m \times n} + \beta \cdot \underbrace{\mat(B)}_{d \times n},    \tag{$\star$}
+///
+/// where :math:`\mat(A)` is stored as 8-bit integers :math:`Q` with per-row or
+/// per-column scale factors. That is, :math:`\mat(A)_{ij} = \ttt{scales}[i] \cdot Q_{ij}`
+/// if scale_axis is ScaleAxis::Rows, and :math:`\mat(A)_{ij} = \ttt{scales}[j] \cdot Q_{ij}`
+/// if scale_axis is ScaleAxis::Cols. Rows and columns refer to :math:`\mat(A)`, not :math:`\op(\mat(A))`.
+///
+/// The dequantized matrix is never formed in full. We dequantize :math:`\op(\mat(A))`
+/// one panel at a time into a workspace of a few megabytes, and apply the
+/// sketch to each panel while the panel is in cache. When :math:`\mtxS` is a DenseSkOp
+/// we split both dimensions of :math:`\op(\mat(A))` and accumulate into :math:`\mat(B)`
+/// across panels of rows. When :math:`\mtxS` is a SparseSkOp, panels span
+/// all :math:`m` rows, so each nonzero of :math:`\mtxS` is visited once per panel of columns.
+///
+/// The arguments that this function shares with sketch_general have the same meaning here.
+/// The remaining arguments are as follows.
+///
+///      A - [in]
+///       * Pointer to a 1D array of int8_t or uint8_t values.
+///       * Defines :math:`Q`, using layout and :math:`\lda` in the same way as sketch_general.
+///
+///      scales - [in]
+///       * Pointer to an array of real scalars.
+///       * Its length is the number of rows of :math:`\mat(A)` if scale_axis is ScaleAxis::Rows,
+///         and the number of columns of :math:`\mat(A)` otherwise.
+///
+///      scale_axis - [in]
+///       * ScaleAxis::Rows or ScaleAxis::Cols.
+///
+/// @endverbatim
+template <typename T, typename Q, SketchingOperator SKOP>
+void sketch_quantized(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const Q *A,
+    int64_t lda,
+    const T *scales,
+    ScaleAxis scale_axis,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    static_assert(std::is_same_v<Q, int8_t> || std::is_same_v<Q, uint8_t>);
+    auto [rows_A, cols_A] = dims_before_op(m, n, opA);
+    if (layout == blas::Layout::ColMajor) {
+        randblas_require(lda >= rows_A);
+        randblas_require(ldb >= d);
+    } else {
+        randblas_require(lda >= cols_A);
+        randblas_require(ldb >= n);
+    }
+    exec::ScopedPolicy scoped_policy(exec);
+    if (m == 0) {
+        auto [b_row, b_col] = layout_to_strides(layout, ldb);
+        for (int64_t i = 0; i < d; ++i) {
+            for (int64_t j = 0; j < n; ++j) {
+                T &b = B[i * b_row + j * b_col];
+                b = (beta == (T) 0) ? (T) 0 : beta * b;
+            }
+        }
+        return;
+    }
+    if (n == 0)
+        return;
+    if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        dense::fill_if_lazy(S);
+        if (!S.buff) {
+            // Sample the submatrix once, rather than once per panel.
+            auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
+            auto submat_S = submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s);
+            quantized::lskgeq<true>(layout, opS, opA, d, n, m, alpha, submat_S, 0, 0, A, lda, scales, scale_axis, beta, B, ldb);
+        } else {
+            quantized::lskgeq<true>(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, lda, scales, scale_axis, beta, B, ldb);
+        }
+    } else {
+        sparse::fill_if_lazy(S);
+        if (S.nnz < 0) {
+            SKOP shallowcopy(S.dist, S.seed_state);
+            fill_sparse(shallowcopy);
+            quantized::lskgeq<false>(layout, opS, opA, d, n, m, alpha, shallowcopy, ro_s, co_s, A, lda, scales, scale_axis, beta, B, ldb);
+        } else {
+            quantized::lskgeq<false>(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, lda, scales, scale_axis, beta, B, ldb);
+        }
+    }
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a quantized matrix from the left, using all of :math:`\mtxS.`
+/// This is the same as the overload that takes :math:`(\ttt{ro_s}, \ttt{co_s})`, with both set to zero.
+/// We require that :math:`\op(\mtxS)` is :math:`d \times m.`
+/// @endverbatim
+template <typename T, typename Q, SketchingOperator SKOP>
+void sketch_quantized(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(S) is d-by-m
+    T alpha,
+    SKOP &S,
+    const Q *A,
+    int64_t lda,
+    const T *scales,
+    ScaleAxis scale_axis,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    if (opS == blas::Op::NoTrans) {
+        randblas_require(S.n_rows == d);
+        randblas_require(S.n_cols == m);
+    } else {
+        randblas_require(S.n_rows == m);
+        randblas_require(S.n_cols == d);
+    }
+    sketch_quantized(layout, opS, opA, d, n, m, alpha, S, 0, 0, A, lda, scales, scale_axis, beta, B, ldb, exec);
+}
+
+} // end namespace RandBLAS
@@ -38,7 +38,12 @@
 #if !defined(_GNU_SOURCE)
 #define _GNU_SOURCE
 #endif
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
 
 #if !defined(R123_NO_SINCOS) && defined(__APPLE__)
 /* MacOS X 10.10.5 (2015) doesn't have sincosf */
@@ -75,7 +80,11 @@ static inline void sincospi(double x, double *s, double *c) {
 #include <Random123/array.h>
 #include <Random123/philox.h>
 #include <Random123/threefry.h>
-// NOTE: we do not support Random123's AES or ARS generators.
+#include <Random123/ars.h>
+// ^ ars.h is empty unless R123_USE_AES_NI is nonzero, which Random123 decides
+//   from the compiler's target flags (e.g., -maes or -march=native).
+//   We don't support Random123's AES generator; it needs a key schedule
+//   that doesn't fit RNGState.
 
 RandBLAS_OPTIMIZE_OFF
 #include <Random123/boxmuller.hpp>
@@ -118,6 +127,35 @@ auto boxmulall(
     return ro;
 }
 
+/** Split each element of ri into 32-bit words, least significant word first.
+ * When CTR has 32-bit elements this just copies ri into a std::array.
+ *
+ * @tparam CTR a random123 CBRNG ctr_type
+ *
+ * @param[in] ri a sequence of N random values generated using random123 CBRNG
+ *               type RNG.
+ *
+ * @returns a std::array<uint32_t, N*W/32> where W is the number of bits in
+ *          an element of ri.
+ */
+template <typename CTR>
+auto split32all(
+    CTR const &ri
+) {
+    using word_t = typename CTR::value_type;
+    constexpr int words_per_elem = sizeof(word_t) / sizeof(uint32_t);
+    std::array<uint32_t, CTR::static_size * words_per_elem> ro;
+    for (int i = 0; i < (int) CTR::static_size; ++i) {
+        word_t w = ri[i];
+        for (int j = 0; j < words_per_elem; ++j) {
+            ro[words_per_elem*i + j] = (uint32_t) w;
+            if constexpr (words_per_elem > 1)
+                w >>= 32;
+        }
+    }
+    return ro;
+}
+
 /** @defgroup generators
  * Generators take CBRNG, counter,and key instances and return a sequence of
  * random floating point numbers in a std::array. The length of the squence is
@@ -181,7 +219,416 @@ struct uneg11
     }
 };
 
+/// Generate a sequence of random values, split each into 32-bit words, and
+/// apply a Box-Muller transform to produce single-precision values.
+struct boxmul_split
+{
+    /** Generate a sequence of random values, split each into 32-bit words, and
+     * apply a Box-Muller transform to produce single-precision values.
+     *
+     * For CBRNGs with 64-bit counter elements this returns twice as many
+     * values per counter as boxmul. For 32-bit counter elements it's
+     * equivalent to boxmul.
+     *
+     * @tparam RNG a random123 CBRNG type
+     *
+     * @param[in] rng: a random123 CBRNG instance used to generate the sequence
+     * @param[in] c: CBRNG counter
+     * @param[in] k: CBRNG key
+     *
+     * @returns a std::array<float,N*W/32> where N is the CBRNG's ctr_type::static_size
+     *          and W is the number of bits in a counter element. For example when
+     *          RNG is Philox4x64 the return is a std::array<float,8>.
+     */
+    template <typename RNG>
+    static
+    auto generate(
+        RNG &rng,
+        typename RNG::ctr_type const &c,
+        typename RNG::key_type const &k
+    ) {
+        auto ri = split32all(rng(c,k));
+        constexpr size_t len = std::tuple_size_v<decltype(ri)>;
+        std::array<float, len> ro;
+        for (size_t i = 0; i < len / 2; ++i) {
+            auto [v0, v1] = r123::boxmuller(ri[2*i], ri[2*i + 1]);
+            ro[2*i    ] = v0;
+            ro[2*i + 1] = v1;
+        }
+        return ro;
+    }
+};
+
+/// Generate a sequence of random values, split each into 32-bit words, and
+/// transform to single-precision values in -1.0 to 1.0.
+struct uneg11_split
+{
+    /** Generate a sequence of random values, split each into 32-bit words, and
+     * transform to single-precision values in -1.0 to 1.0.
+     *
+     * For CBRNGs with 64-bit counter elements this returns twice as many
+     * values per counter as uneg11. For 32-bit counter elements it's
+     * equivalent to uneg11.
+     *
+     * @tparam RNG a random123 CBRNG type
+     *
+     * @param[in] rng: a random123 CBRNG instance used to generate the sequence
+     * @param[in] c: CBRNG counter
+     * @param[in] k: CBRNG key
+     *
+     * @returns a std::array<float,N*W/32> where N is the CBRNG's ctr_type::static_size
+     *          and W is the number of bits in a counter element. For example when
+     *          RNG is Philox4x64 the return is a std::array<float,8>.
+     */
+    template <typename RNG>
+    static
+    auto generate(
+        RNG &rng,
+        typename RNG::ctr_type const &c,
+        typename RNG::key_type const &k
+    ) {
+        auto ri = split32all(rng(c,k));
+        constexpr size_t len = std::tuple_size_v<decltype(ri)>;
+        std::array<float, len> ro;
+        for (size_t i = 0; i < len; ++i)
+            ro[i] = r123::uneg11<float>(ri[i]);
+        return ro;
+    }
+};
+
+/** Tables for a counter-aligned ziggurat sampler of the standard normal distribution.
+ *
+ * We use the 128-layer ziggurat of Marsaglia and Tsang (2000) for the half-normal
+ * density f(x) = exp(-x^2/2). A 32-bit word supplies a layer (7 bits), a sign (1 bit),
+ * and a uniform u in [0, 1) (24 bits). If u is below layer's acceptance ratio then
+ * u times the layer width is returned, which happens with probability about 0.972.
+ * The remaining 2.8% of words (p_reject below) take the slow path described next.
+ *
+ * The classic ziggurat retries with fresh random numbers when that test fails,
+ * so the number of random words per sample isn't fixed. Instead, we map the rejected
+ * part of the word's range to a uniform V in [0, 1) and return the inverse CDF of the
+ * "leftover" distribution at V. The leftover distribution is what's needed for the
+ * mixture with the fast path to be exactly normal. Its CDF is
+ *
+ *      G(x) = (erf(x/sqrt(2)) - Q(x)) / p_reject,
+ *
+ * where Q is the (piecewise linear) CDF of the fast path's output on [0, inf).
+ * We invert G by safeguarded Newton iteration.
+ */
+struct ZigguratTables {
+    static constexpr int layers = 128;
+    static constexpr double r = 3.442619855899;
+    static constexpr double v = 9.91256303526217e-3;
+    // ^ Marsaglia and Tsang's rightmost layer boundary and per-layer area.
+
+    // x[0] = v/f(r) is the width of the base layer (including the tail),
+    // x[1] = r, and x[i] for i >= 1 is the width of layer i. x[layers] = 0.
+    std::array<double, layers + 1> x;
+    // accept[i] = x[i+1]/x[i] is the fraction of layer i that's under the curve for all heights in the layer.
+    std::array<double, layers> accept;
+    // reject_cum[i] = sum_{j < i} (1 - accept[j]).
+    std::array<double, layers + 1> reject_cum;
+    // On (x[m+1], x[m]], the fast path's output has density fast_density[m] (times 2, since we ignore the sign).
+    std::array<double, layers> fast_density;
+    // fast_cdf[m] = Q(x[m]) and leftover_cdf[m] = G(x[m]).
+    std::array<double, layers + 1> fast_cdf;
+    std::array<double, layers + 1> leftover_cdf;
+    // Probability that the fast path fails.
+    double p_reject;
+    // Data for leftover_inverse. We split each (x[m+1], x[m]] into `subknots` equal
+    // pieces and list the resulting knots in order of increasing t, so knot_x[i] and
+    // knot_V[i] = G(knot_x[i]) are both increasing. knot_x[0] = 0 and knot_x[knots] = r.
+    // On piece i the fast path's density is knot_q[i], and knot_taylor[i][k] is the
+    // k-th Taylor coefficient of the half-normal density sqrt(2/pi) exp(-t^2/2) about
+    // t = knot_x[i]. knot_taylor_int[i][k] = knot_taylor[i][k] / (k+1) is used to integrate it.
+    // guide[g] is the largest i with knot_V[i] <= g / guide_size.
+    static constexpr int subknots = 16;
+    static constexpr int knots = (layers - 1) * subknots;
+    static constexpr int taylor_terms = 6;
+    static constexpr int guide_size = 4096;
+    std::array<double, knots + 1> knot_x;
+    std::array<double, knots + 1> knot_V;
+    std::array<double, knots> knot_q;
+    std::array<std::array<double, taylor_terms>, knots> knot_taylor;
+    std::array<std::array<double, taylor_terms>, knots> knot_taylor_int;
+    std::array<int, guide_size> guide;
+
+    ZigguratTables() {
+        auto f = [](double t) { return std::exp(-0.5*t*t); };
+        x[0] = v / f(r);
+        x[1] = r;
+        for (int i = 1; i < layers - 1; ++i)
+            x[i+1] = std::sqrt(-2.0 * std::log(v / x[i] + f(x[i])));
+        x[layers] = 0.0;
+        reject_cum[0] = 0.0;
+        for (int i = 0; i < layers; ++i) {
+            accept[i] = x[i+1] / x[i];
+            reject_cum[i+1] = reject_cum[i] + (1.0 - accept[i]);
+        }
+        p_reject = reject_cum[layers] / layers;
+        double inv_width_sum = 0.0;
+        fast_density[0] = 0.0;
+        for (int m = 1; m < layers; ++m) {
+            inv_width_sum += 1.0 / x[m-1];
+            fast_density[m] = inv_width_sum / layers;
+        }
+        fast_cdf[layers] = 0.0;
+        leftover_cdf[layers] = 0.0;
+        for (int m = layers - 1; m >= 1; --m) {
+            fast_cdf[m] = fast_cdf[m+1] + fast_density[m] * (x[m] - x[m+1]);
+            leftover_cdf[m] = (std::erf(x[m] / std::sqrt(2.0)) - fast_cdf[m]) / p_reject;
+        }
+        fast_cdf[0] = fast_cdf[1];
+        leftover_cdf[0] = 1.0;
+        const double rt2_over_pi = std::sqrt(2.0 / M_PI);
+        int i = 0;
+        for (int m = layers - 1; m >= 1; --m) {
+            double a = x[m+1], h = (x[m] - a) / subknots;
+            for (int j = 0; j < subknots; ++j, ++i) {
+                double t = a + j*h;
+                knot_x[i] = t;
+                knot_V[i] = (j == 0) ? leftover_cdf[m+1] :
+                    (std::erf(t / std::sqrt(2.0)) - fast_cdf[m+1] - fast_density[m] * (t - a)) / p_reject;
+                knot_q[i] = fast_density[m];
+                // The k-th derivative of exp(-t^2/2) is (-1)^k He_k(t) exp(-t^2/2), where He_k
+                // is the k-th probabilists' Hermite polynomial.
+                double phi = rt2_over_pi * std::exp(-0.5*t*t);
+                double he_prev = 1.0, he = t, k_factorial = 1.0;
+                knot_taylor[i][0] = phi;
+                for (int k = 1; k < taylor_terms; ++k) {
+                    k_factorial *= k;
+                    knot_taylor[i][k] = ((k % 2) ? -1.0 : 1.0) * he * phi / k_factorial;
+                    double he_next = t * he - k * he_prev;
+                    he_prev = he;
+                    he = he_next;
+                }
+                for (int k = 0; k < taylor_terms; ++k)
+                    knot_taylor_int[i][k] = knot_taylor[i][k] / (k + 1);
+            }
+        }
+        knot_x[knots] = r;
+        knot_V[knots] = leftover_cdf[1];
+        i = 0;
+        for (int g = 0; g < guide_size; ++g) {
+            double Vg = ((double) g) / guide_size;
+            while (i < knots - 1 && knot_V[i+1] <= Vg)
+                ++i;
+            guide[g] = i;
+        }
+    }
+
+    // Find t in [lo, hi] where F(t) = 0, given F(lo) <= 0 <= F(hi), F' = dF, and a starting point t.
+    template <typename FUNC, typename DFUNC>
+    static double solve(FUNC F, DFUNC dF, double lo, double hi, double t) {
+        for (int iter = 0; iter < 100; ++iter) {
+            double Ft = F(t);
+            if (Ft == 0.0)
+                return t;
+            if (Ft < 0.0) { lo = t; } else { hi = t; }
+            double d = dF(t);
+            double t_next = (d > 0.0) ? t - Ft / d : lo - 1.0;
+            if (!(lo < t_next && t_next < hi))
+                t_next = 0.5 * (lo + hi);
+            if (std::abs(t_next - t) <= 1e-12 * std::max(1.0, t))
+                return t_next;
+            t = t_next;
+        }
+        return t;
+    }
+
+    /// Inverse CDF of the leftover distribution on [0, inf), evaluated at V in [0, 1).
+    double leftover_inverse(double V) const {
+        if (V >= leftover_cdf[1]) {
+            // Tail: G(t) = 1 - erfc(t/sqrt(2)) / p_reject for t > r. This is rare enough
+            // that we don't mind calling erfc in each Newton step.
+            const double rt2 = std::sqrt(2.0);
+            double target = (1.0 - V) * p_reject;
+            double hi = 2.0 * r;
+            while (std::erfc(hi / rt2) > target)
+                hi *= 2.0;
+            return solve(
+                [&](double t) { return target - std::erfc(t / rt2); },
+                [&](double t) { return std::sqrt(2.0 / M_PI) * std::exp(-0.5*t*t); },
+                r, hi, r + 0.5
+            );
+        }
+        int i = guide[(int) (V * guide_size)];
+        while (i < knots - 1 && knot_V[i+1] <= V)
+            ++i;
+        // Solve G(knot_x[i] + d) = V for d in [0, knot_x[i+1] - knot_x[i]]. Over that
+        // short interval we expand the normal density in a Taylor series, so this
+        // needs no calls to erf or exp.
+        const auto &c = knot_taylor[i];
+        const auto &ci = knot_taylor_int[i];
+        double q = knot_q[i];
+        double target = (V - knot_V[i]) * p_reject;
+        double width = knot_x[i+1] - knot_x[i];
+        // Start from the root of the quadratic part of G(knot_x[i] + d) - V, using one
+        // fixed-point step. The density (c[0] - q) is positive at the left of each piece.
+        double d0 = target / (c[0] - q);
+        d0 = target / (c[0] - q + ci[1] * d0);
+        double d = (d0 > 0.0 && d0 < width) ? d0 : 0.5 * width;
+        double lo = 0.0, hi = width;
+        for (int iter = 0; iter < 100; ++iter) {
+            double F = 0.0, dF = 0.0;
+            for (int k = taylor_terms - 1; k >= 0; --k) {
+                F = F * d + ci[k];
+                dF = dF * d + c[k];
+            }
+            F = (F - q) * d - target;
+            dF = dF - q;
+            if (F == 0.0)
+                break;
+            if (F < 0.0) { lo = d; } else { hi = d; }
+            double d_next = d - F / dF;
+            if (!(lo < d_next && d_next < hi))
+                d_next = 0.5 * (lo + hi);
+            // Newton converges quadratically here, so once a step is this small the
+            // next iterate is accurate to roughly 1e-14 * width.
+            bool done = std::abs(d_next - d) <= 1e-7 * width;
+            d = d_next;
+            if (done)
+                break;
+        }
+        return knot_x[i] + d;
+    }
+
+    /// Map a 32-bit word to a standard normal random variable.
+    double sample(uint32_t w) const {
+        int layer = (int) (w & (layers - 1));
+        bool neg = (w >> 7) & 1;
+        double u = ((double) (w >> 8) + 0.5) * 0x1p-24;
+        return sample(layer, neg, u);
+    }
+
+    /// Map a 64-bit word to a standard normal random variable. This uses 53 bits
+    /// for u rather than 24.
+    double sample(uint64_t w) const {
+        int layer = (int) (w & (layers - 1));
+        bool neg = (w >> 7) & 1;
+        double u = ((double) (w >> 11) + 0.5) * 0x1p-53;
+        return sample(layer, neg, u);
+    }
+
+    double sample(int layer, bool neg, double u) const {
+        double t;
+        if (u < accept[layer]) {
+            t = u * x[layer];
+        } else {
+            double V = (reject_cum[layer] + (u - accept[layer])) / reject_cum[layers];
+            t = leftover_inverse(V);
+        }
+        return neg ? -t : t;
+    }
+};
+
+inline const ZigguratTables &ziggurat_tables() {
+    static const ZigguratTables tables{};
+    return tables;
+}
+
+/// Generate a sequence of random values and map each one to a standard
+/// normal random variable with a counter-aligned ziggurat method.
+struct ziggurat
+{
+    /** Generate a sequence of random values and map each one to a standard
+     * normal random variable with a counter-aligned ziggurat method.
+     *
+     * Unlike the classic ziggurat algorithm, this consumes exactly one counter
+     * element per output, so it can be used wherever boxmul is used without
+     * changing how counters map to matrix entries. See ZigguratTables.
+     *
+     * @tparam RNG a random123 CBRNG type
+     *
+     * @param[in] rng: a random123 CBRNG instance used to generate the sequence
+     * @param[in] c: CBRNG counter
+     * @param[in] k: CBRNG key
+     *
+     * @returns a std::array<double,N> where N is the CBRNG's ctr_type::static_size.
+     */
+    template <typename RNG>
+    static
+    auto generate(
+        RNG &rng,
+        typename RNG::ctr_type const &c,
+        typename RNG::key_type const &k
+    ) {
+        auto ri = rng(c,k);
+        constexpr size_t len = RNG::ctr_type::static_size;
+        const ZigguratTables &zt = ziggurat_tables();
+        std::array<double, len> ro;
+        for (size_t i = 0; i < len; ++i)
+            ro[i] = zt.sample(ri[i]);
+        return ro;
+    }
+};
+
+/// Generate a sequence of random values, split each into 32-bit words, and
+/// map each word to a standard normal random variable with a counter-aligned
+/// ziggurat method.
+struct ziggurat_split
+{
+    /** Generate a sequence of random values, split each into 32-bit words, and
+     * map each word to a standard normal random variable with a counter-aligned
+     * ziggurat method. For 32-bit counter elements it's equivalent to ziggurat.
+     *
+     * @tparam RNG a random123 CBRNG type
+     *
+     * @param[in] rng: a random123 CBRNG instance used to generate the sequence
+     * @param[in] c: CBRNG counter
+     * @param[in] k: CBRNG key
+     *
+     * @returns a std::array<double,N*W/32> where N is the CBRNG's ctr_type::static_size
+     *          and W is the number of bits in a counter element.
+     */
+    template <typename RNG>
+    static
+    auto generate(
+        RNG &rng,
+        typename RNG::ctr_type const &c,
+        typename RNG::key_type const &k
+    ) {
+        auto ri = split32all(rng(c,k));
+        constexpr size_t len = std::tuple_size_v<decltype(ri)>;
+        const ZigguratTables &zt = ziggurat_tables();
+        std::array<double, len> ro;
+        for (size_t i = 0; i < len; ++i)
+            ro[i] = zt.sample(ri[i]);
+        return ro;
+    }
+};
+
 /// @}
 
+/** Buffers the bits of a CBRNG's output so that each call to next() consumes
+ * a single bit. This lets sign-valued samples (e.g., Rademachers) use every bit
+ * of a counter element rather than a full element per sign.
+ *
+ * @tparam RNG a random123 CBRNG type
+ */
+template <typename RNG>
+struct bit_stream
+{
+    using word_t = typename RNG::ctr_type::value_type;
+    static constexpr int bits_per_word = 8 * sizeof(word_t);
+
+    word_t bits = 0;
+    int remaining = 0;
+
+    /// Returns true if a new word is needed before the next call to next().
+    bool empty() const { return remaining == 0; }
+
+    /// Load a fresh word of random bits.
+    void refill(word_t w) { bits = w; remaining = bits_per_word; }
+
+    /// Consume one bit. Requires !empty().
+    bool next() {
+        bool b = bits & 1;
+        bits >>= 1;
+        --remaining;
+        return b;
+    }
+};
+
 } // end of namespace r123ext
 
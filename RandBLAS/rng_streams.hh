@@ -0,0 +1,132 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// A thread-safe source of non-overlapping RNGStates for concurrent workers.
+///
+/// Applications that run many sketches at once need a distinct random stream for
+/// each of them. A RNGStreamAllocator hands out such streams in two ways.
+///
+///  * next_key() returns a state whose key hasn't been handed out before. Different
+///    keys induce statistically independent sequences, so the caller may consume
+///    as much of that stream as it likes.
+///
+///  * reserve_counters(n) returns a state that shares the base key but starts at a
+///    counter offset that no other caller receives. The caller may consume the
+///    :math:`n` counter values that follow it. This is useful when keys are a scarce
+///    resource, or when every stream should come from a single key for
+///    reproducibility.
+///
+/// Both are a single atomic update on a 64-bit integer, so they never block.
+/// The streams they hand out depend only on the order in which the calls are made.
+///
+/// The two kinds of streams never overlap: next_key() skips the base key, which
+/// is reserved for reserve_counters().
+///
+/// @endverbatim
+template <typename RNG = DefaultRNG>
+class RNGStreamAllocator {
+    public:
+    using state_t = RNGState<RNG>;
+
+    // ---------------------------------------------------------------------------
+    /// Every stream handed out by this allocator is derived from this state.
+    const state_t base;
+
+    // ---------------------------------------------------------------------------
+    /// Create an allocator whose streams are derived from "base."
+    explicit RNGStreamAllocator(const state_t &base = state_t()) : base(base) {}
+
+    RNGStreamAllocator(const RNGStreamAllocator &) = delete;
+    RNGStreamAllocator &operator=(const RNGStreamAllocator &) = delete;
+
+    // ---------------------------------------------------------------------------
+    /// Return a state whose counter equals base.counter and whose key is
+    /// base.key incremented by \math{i + 1,} where \math{i} is the number of
+    /// earlier calls to this function.
+    state_t next_key() {
+        uint64_t i = num_keys.fetch_add(1, std::memory_order_relaxed);
+        randblas_require(i < std::numeric_limits<uint64_t>::max());
+        state_t out(base);
+        out.key.incr(i + 1);
+        return out;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// Reserve \math{n} counter values in the stream of base.key. Return a state
+    /// whose key is base.key and whose counter is base.counter incremented by the
+    /// total size of all earlier reservations. The caller may use counters up to
+    /// (but not including) that counter incremented by \math{n.}
+    ///
+    /// The number of counters that a sketching operator needs is
+    /// the difference between its next_state and seed_state counters.
+    state_t reserve_counters(uint64_t n) {
+        uint64_t start = num_counters.load(std::memory_order_relaxed);
+        do {
+            randblas_require(n <= std::numeric_limits<uint64_t>::max() - start);
+        } while (!num_counters.compare_exchange_weak(start, start + n, std::memory_order_relaxed));
+        state_t out(base);
+        out.counter.incr(start);
+        return out;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of keys handed out by next_key().
+    uint64_t keys_issued() const {
+        return num_keys.load(std::memory_order_relaxed);
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The total number of counters reserved by reserve_counters().
+    uint64_t counters_reserved() const {
+        return num_counters.load(std::memory_order_relaxed);
+    }
+
+    private:
+    std::atomic<uint64_t> num_keys{0};
+    std::atomic<uint64_t> num_counters{0};
+};
+
+} // end namespace RandBLAS
@@ -41,6 +41,7 @@
 
 #include <cmath>
 #include <typeinfo>
+#include <vector>
 
 
 namespace RandBLAS::dense {
@@ -149,6 +150,12 @@ using RandBLAS::fill_dense;
 ///    - Leading dimension of \math{\mat(B)} when reading from \math{B}.
 ///    - Refer to documentation for \math{\lda} for details. 
 ///
+/// @param[in] diag
+///    - Optional pointer to an array of length \math{m.}
+///    - If provided, then \math{\op(\mat(A))} in \math{(\star)} is replaced by
+///      \math{\operatorname{diag}(\ttt{diag}) \cdot \op(\mat(A)).}
+///      We apply the scaling to a copy of \math{\op(\submat(\mtxS)),} never to \math{A.}
+///
 template <typename T, typename DenseSkOp>
 void lskge3(
     blas::Layout layout,
@@ -165,11 +172,23 @@ void lskge3(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr
 ){
     auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
     constexpr bool maybe_denseskop = !std::is_same_v<std::remove_cv_t<DenseSkOp>, BLASFriendlyOperator<T>>;
+    if (diag != nullptr) {
+        // op(submat(S)) * diag(diag) scales the columns of op(submat(S)).
+        if constexpr (maybe_denseskop)
+            RandBLAS::dense::fill_if_lazy(S);
+        bool scale_rows = (opS == blas::Op::Trans);
+        auto submat_S = scaled_submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s,
+            scale_rows ? diag : nullptr, scale_rows ? nullptr : diag);
+        lskge3(layout, opS, opA, d, n, m, alpha, submat_S, 0, 0, A, lda, beta, B, ldb);
+        return;
+    }
     if constexpr (maybe_denseskop) {
+        RandBLAS::dense::fill_if_lazy(S);
         if (!S.buff) {
             // DenseSkOp doesn't permit defining a "black box" distribution, so we have to pack the submatrix
             // into an equivalent datastructure ourselves.
@@ -302,6 +321,12 @@ void lskge3(
 ///    - Leading dimension of \math{\mat(B)} when reading from \math{B}.
 ///    - Refer to documentation for \math{\lda} for details. 
 ///
+/// @param[in] diag
+///    - Optional pointer to an array of length \math{n.}
+///    - If provided, then \math{\op(\mat(A))} in \math{(\star)} is replaced by
+///      \math{\op(\mat(A)) \cdot \operatorname{diag}(\ttt{diag}).}
+///      We apply the scaling to a copy of \math{\op(\submat(\mtxS)),} never to \math{A.}
+///
 template <typename T, typename DenseSkOp>
 void rskge3(
     blas::Layout layout,
@@ -318,11 +343,23 @@ void rskge3(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr
 ){
     auto [rows_submat_S, cols_submat_S] = dims_before_op(n, d, opS);
     constexpr bool maybe_denseskop = !std::is_same_v<std::remove_cv_t<DenseSkOp>, BLASFriendlyOperator<T>>;
+    if (diag != nullptr) {
+        // diag(diag) * op(submat(S)) scales the rows of op(submat(S)).
+        if constexpr (maybe_denseskop)
+            RandBLAS::dense::fill_if_lazy(S);
+        bool scale_rows = (opS == blas::Op::NoTrans);
+        auto submat_S = scaled_submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s,
+            scale_rows ? diag : nullptr, scale_rows ? nullptr : diag);
+        rskge3(layout, opA, opS, m, d, n, alpha, A, lda, submat_S, 0, 0, beta, B, ldb);
+        return;
+    }
     if constexpr (maybe_denseskop) {
+        RandBLAS::dense::fill_if_lazy(S);
         if (!S.buff) {
             // DenseSkOp doesn't permit defining a "black box" distribution, so we have to pack the submatrix
             // into an equivalent datastructure ourselves.
@@ -460,6 +497,12 @@ namespace RandBLAS::sparse {
 ///    - Leading dimension of \math{\mat(B)} when reading from \math{B}.
 ///    - Refer to documentation for \math{\lda} for details. 
 ///
+/// @param[in] diag
+///    - Optional pointer to an array of length \math{m.}
+///    - If provided, then \math{\op(\mat(A))} in \math{(\star)} is replaced by
+///      \math{\operatorname{diag}(\ttt{diag}) \cdot \op(\mat(A)).}
+///      We scale a copy of the nonzeros of \math{S,} never \math{A.}
+///
 template <typename T, typename RNG, SignedInteger sint_t>
 void lskges(
     blas::Layout layout,
@@ -476,15 +519,33 @@ void lskges(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr
 ) {
+    RandBLAS::sparse::fill_if_lazy(S);
     if (S.nnz < 0) {
         SparseSkOp<T,RNG,sint_t> shallowcopy(S.dist, S.seed_state); // shallowcopy.own_memory = true.
         fill_sparse(shallowcopy);
-        lskges(layout, opS, opA, d, n, m, alpha, shallowcopy, ro_s, co_s, A, lda, beta, B, ldb);
+        lskges(layout, opS, opA, d, n, m, alpha, shallowcopy, ro_s, co_s, A, lda, beta, B, ldb, diag);
         return;
     }
     auto Scoo = coo_view_of_skop(S);
+    if (diag != nullptr) {
+        // op(submat(S)) * diag(diag) scales the columns of op(submat(S)).
+        std::vector<T> vals(S.nnz);
+        if (opS == blas::Op::NoTrans) {
+            scaled_skop_vals(S, S.cols, co_s, m, diag, vals.data());
+        } else {
+            scaled_skop_vals(S, S.rows, ro_s, m, diag, vals.data());
+        }
+        // The SpMM kernels may reorder the nonzeros in place, so the index arrays must
+        // be copied along with the values to keep S intact.
+        std::vector<sint_t> rows(S.rows, S.rows + S.nnz);
+        std::vector<sint_t> cols(S.cols, S.cols + S.nnz);
+        COOMatrix<T, sint_t> Scoo_scaled(S.n_rows, S.n_cols, S.nnz, vals.data(), rows.data(), cols.data());
+        left_spmm(layout, opS, opA, d, n, m, alpha, Scoo_scaled, ro_s, co_s, A, lda, beta, B, ldb);
+        return;
+    }
     left_spmm(layout, opS, opA, d, n, m, alpha, Scoo, ro_s, co_s, A, lda, beta, B, ldb);
     return;
 }
@@ -593,6 +654,12 @@ void lskges(
 ///    - Leading dimension of \math{\mat(B)} when reading from \math{B}.
 ///    - Refer to documentation for \math{\lda} for details. 
 ///
+/// @param[in] diag
+///    - Optional pointer to an array of length \math{n.}
+///    - If provided, then \math{\op(\mat(A))} in \math{(\star)} is replaced by
+///      \math{\op(\mat(A)) \cdot \operatorname{diag}(\ttt{diag}).}
+///      We scale a copy of the nonzeros of \math{S,} never \math{A.}
+///
 template <typename T, typename RNG, SignedInteger sint_t>
 inline void rskges(
     blas::Layout layout,
@@ -609,14 +676,33 @@ inline void rskges(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr
 ) { 
+    RandBLAS::sparse::fill_if_lazy(S);
     if (S.nnz < 0) {
         SparseSkOp<T,RNG,sint_t> shallowcopy(S.dist, S.seed_state); // shallowcopy.own_memory = true.
         fill_sparse(shallowcopy);
-        rskges(layout, opA, opS, m, d, n, alpha, A, lda, shallowcopy, ro_s, co_s, beta, B, ldb);
+        rskges(layout, opA, opS, m, d, n, alpha, A, lda, shallowcopy, ro_s, co_s, beta, B, ldb, diag);
+        return;
     }
     auto Scoo = coo_view_of_skop(S);
+    if (diag != nullptr) {
+        // diag(diag) * op(submat(S)) scales the rows of op(submat(S)).
+        std::vector<T> vals(S.nnz);
+        if (opS == blas::Op::NoTrans) {
+            scaled_skop_vals(S, S.rows, ro_s, n, diag, vals.data());
+        } else {
+            scaled_skop_vals(S, S.cols, co_s, n, diag, vals.data());
+        }
+        // The SpMM kernels may reorder the nonzeros in place, so the index arrays must
+        // be copied along with the values to keep S intact.
+        std::vector<sint_t> rows(S.rows, S.rows + S.nnz);
+        std::vector<sint_t> cols(S.cols, S.cols + S.nnz);
+        COOMatrix<T, sint_t> Scoo_scaled(S.n_rows, S.n_cols, S.nnz, vals.data(), rows.data(), cols.data());
+        right_spmm(layout, opA, opS, m, d, n, alpha, A, lda, Scoo_scaled, ro_s, co_s, beta, B, ldb);
+        return;
+    }
     right_spmm(
         layout, opA, opS, m, d, n, alpha, A, lda, Scoo, ro_s, co_s, beta, B, ldb
     );
@@ -636,7 +722,8 @@ using namespace RandBLAS::sparse;
 // =============================================================================
 /// \fn sketch_general(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d,
 ///     int64_t n, int64_t m, T alpha, SKOP &S, int64_t ro_s, int64_t co_s,
-///     const T *A, int64_t lda, T beta, T *B, int64_t ldb
+///     const T *A, int64_t lda, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the left in a GEMM-like operation
@@ -750,6 +837,10 @@ using namespace RandBLAS::sparse;
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B.`
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
 /// @endverbatim
 template <typename T, SketchingOperator SKOP>
 inline void sketch_general(
@@ -767,7 +858,8 @@ inline void sketch_general(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 );
 
 template <typename T, typename RNG>
@@ -786,8 +878,10 @@ inline void sketch_general(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
+    exec::ScopedPolicy scoped_policy(exec);
     return sparse::lskges(
         layout, opS, opA, d, n, m, alpha, S,
         ro_s, co_s, A, lda, beta, B, ldb
@@ -810,8 +904,10 @@ inline void sketch_general(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
+    exec::ScopedPolicy scoped_policy(exec);
     return dense::lskge3(
         layout, opS, opA, d, n, m, alpha, S,
         ro_s, co_s, A, lda, beta, B, ldb
@@ -822,7 +918,8 @@ inline void sketch_general(
 // =============================================================================
 /// \fn sketch_general(blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
 ///    T alpha, const T *A, int64_t lda, SKOP &S,
-///    int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb
+///    int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb,
+///    const ExecPolicy &exec
 /// )
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the right in a GEMM-like operation
@@ -922,6 +1019,10 @@ inline void sketch_general(
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B.`
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
 /// @endverbatim
 template <typename T, SketchingOperator SKOP>
 inline void sketch_general(
@@ -939,7 +1040,8 @@ inline void sketch_general(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 );
 
 template <typename T, typename RNG>
@@ -958,8 +1060,10 @@ inline void sketch_general(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
+    exec::ScopedPolicy scoped_policy(exec);
     return dense::rskge3(layout, opA, opS, m, d, n, alpha, A, lda,
         S, ro_s, co_s, beta, B, ldb
     );
@@ -982,8 +1086,10 @@ inline void sketch_general(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
+    exec::ScopedPolicy scoped_policy(exec);
     return sparse::rskges(layout, opA, opS, m, d, n, alpha, A, lda,
         S, ro_s, co_s, beta, B, ldb
     );
@@ -994,7 +1100,8 @@ inline void sketch_general(
 
 // =============================================================================
 /// \fn sketch_general(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d,
-///     int64_t n, int64_t m, T alpha, SKOP &S, const T *A, int64_t lda, T beta, T *B, int64_t ldb
+///     int64_t n, int64_t m, T alpha, SKOP &S, const T *A, int64_t lda, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the left in a GEMM-like operation
@@ -1067,6 +1174,10 @@ inline void sketch_general(
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B.`
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
 /// @endverbatim
 template <typename T, SketchingOperator SKOP>
 inline void sketch_general(
@@ -1082,7 +1193,8 @@ inline void sketch_general(
     int64_t lda,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
     if (opS == blas::Op::NoTrans) {
         randblas_require(S.n_rows == d);
@@ -1091,13 +1203,14 @@ inline void sketch_general(
         randblas_require(S.n_rows == m);
         randblas_require(S.n_cols == d);
     }
-    return sketch_general(layout, opS, opA, d, n, m, alpha, S, 0, 0, A, lda, beta, B, ldb);
+    return sketch_general(layout, opS, opA, d, n, m, alpha, S, 0, 0, A, lda, beta, B, ldb, exec);
 };
 
 
 // =============================================================================
 /// \fn sketch_general(blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
-///    T alpha, const T *A, int64_t lda, SKOP &S, T beta, T *B, int64_t ldb
+///    T alpha, const T *A, int64_t lda, SKOP &S, T beta, T *B, int64_t ldb,
+///    const ExecPolicy &exec
 /// )
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the right in a GEMM-like operation
@@ -1169,6 +1282,10 @@ inline void sketch_general(
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B.`
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
 /// @endverbatim
 template <typename T, SketchingOperator SKOP>
 inline void sketch_general(
@@ -1184,7 +1301,8 @@ inline void sketch_general(
     SKOP &S,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {}
 ) {
     if (opS == blas::Op::NoTrans) {
         randblas_require(S.n_rows == n);
@@ -1193,7 +1311,104 @@ inline void sketch_general(
         randblas_require(S.n_rows == d);
         randblas_require(S.n_cols == n);
     }
-    return sketch_general(layout, opA, opS, m, d, n, alpha, A, lda, S, 0, 0, beta, B, ldb);
+    return sketch_general(layout, opA, opS, m, d, n, alpha, A, lda, S, 0, 0, beta, B, ldb, exec);
 };
 
+// MARK: SKGE overloads, diagonal scaling
+
+// =============================================================================
+/// \fn sketch_general(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+///    T alpha, SKOP &S, int64_t ro_s, int64_t co_s, const T *diag, const T *A, int64_t lda, T beta, T *B, int64_t ldb,
+///    const ExecPolicy &exec
+/// )
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a row-scaled matrix from the left in a GEMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\operatorname{diag}(\ttt{diag})}_{m \times m} \cdot \underbrace{\op(\mat(A))}_{m \times n} + \beta \cdot \underbrace{\mat(B)}_{d \times n}.    \tag{$\star$}
+///
+/// This is useful for weighted least squares and for reweighting rows by
+/// leverage scores. No scaled copy of :math:`A` is ever made. Instead we scale a copy of
+/// :math:`\op(\submat(\mtxS))`. For a DenseSkOp that hasn't been filled, the copy is scaled
+/// as it's generated. For a SparseSkOp, we copy its nonzeros (values and indices) and scale the values.
+///
+/// The parameter :math:`\ttt{diag}` is a pointer to an array of :math:`m` real scalars. All other
+/// parameters are as in the overload of sketch_general that omits :math:`\ttt{diag}`.
+///
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+inline void sketch_general(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(A) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *diag,
+    const T *A,
+    int64_t lda,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    randblas_require(diag != nullptr);
+    exec::ScopedPolicy scoped_policy(exec);
+    if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        dense::lskge3(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, lda, beta, B, ldb, diag);
+    } else {
+        sparse::lskges(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, lda, beta, B, ldb, diag);
+    }
+}
+
+// =============================================================================
+/// \fn sketch_general(blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
+///    T alpha, const T *A, int64_t lda, const T *diag, SKOP &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb,
+///    const ExecPolicy &exec
+/// )
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a column-scaled matrix from the right in a GEMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\mat(A))}_{m \times n} \cdot \underbrace{\operatorname{diag}(\ttt{diag})}_{n \times n} \cdot \underbrace{\op(\submat(\mtxS))}_{n \times d} + \beta \cdot \underbrace{\mat(B)}_{m \times d}.    \tag{$\star$}
+///
+/// As with the left-sketching variant, we scale a copy of :math:`\op(\submat(\mtxS))` rather than :math:`A`.
+///
+/// The parameter :math:`\ttt{diag}` is a pointer to an array of :math:`n` real scalars. All other
+/// parameters are as in the overload of sketch_general that omits :math:`\ttt{diag}`.
+///
+/// @endverbatim
+template <typename T, SketchingOperator SKOP>
+inline void sketch_general(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(submat(\mtxS)) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    const T *A,
+    int64_t lda,
+    const T *diag,
+    SKOP &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {}
+) {
+    randblas_require(diag != nullptr);
+    exec::ScopedPolicy scoped_policy(exec);
+    if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+        dense::rskge3(layout, opA, opS, m, d, n, alpha, A, lda, S, ro_s, co_s, beta, B, ldb, diag);
+    } else {
+        sparse::rskges(layout, opA, opS, m, d, n, alpha, A, lda, S, ro_s, co_s, beta, B, ldb, diag);
+    }
+}
+
 }  // end namespace RandBLAS
@@ -0,0 +1,226 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// @file
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+
+namespace RandBLAS {
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+///
+/// A memory-bounded, thread-safe cache of filled sketching operators.
+///
+/// Independent components of an application often construct the same
+/// sketching operator from the same distribution and seed. Each of them would
+/// normally pay for sampling that operator. A SkOpCache lets them share a single
+/// filled copy instead.
+///
+/// Operators are looked up by their (distribution, seed_state) pair. When several
+/// threads request an operator that isn't cached yet, exactly one of them samples it
+/// and the others wait for it to finish. Once the total size of the cached
+/// operators exceeds the capacity, the least recently used operators are dropped.
+/// Dropping an operator from the cache doesn't invalidate it for callers that still
+/// hold it, since operators are handed out through :math:`\ttt{std::shared_ptr}.`
+///
+/// Operators returned by the cache are shared. Callers must treat them as read-only;
+/// passing them to sketching functions such as sketch_general is fine.
+///
+/// SKOP should be a DenseSkOp or a SparseSkOp.
+///
+/// @endverbatim
+template <typename SKOP>
+class SkOpCache {
+    public:
+    using distribution_t = typename SKOP::distribution_t;
+    using state_t = typename SKOP::state_t;
+    using scalar_t = typename SKOP::scalar_t;
+
+    // ---------------------------------------------------------------------------
+    /// The largest total size, in bytes, of the operators that this cache retains.
+    const int64_t capacity_bytes;
+
+    // ---------------------------------------------------------------------------
+    /// Create an empty cache that retains at most capacity_bytes bytes of operator
+    /// data. We require capacity_bytes >= 0.
+    explicit SkOpCache(int64_t capacity_bytes) : capacity_bytes(capacity_bytes) {
+        randblas_require(capacity_bytes >= 0);
+    }
+
+    SkOpCache(const SkOpCache &) = delete;
+    SkOpCache &operator=(const SkOpCache &) = delete;
+
+    // ---------------------------------------------------------------------------
+    /// Return a filled operator sampled from D with the given seed.
+    ///
+    /// If no such operator is cached then the calling thread samples one,
+    /// with its parallel regions following "exec." If sampling throws, the
+    /// exception propagates to every caller waiting on that operator and
+    /// nothing is cached.
+    std::shared_ptr<SKOP> get(const distribution_t &D, const state_t &seed, const ExecPolicy &exec = {}) {
+        std::promise<std::shared_ptr<SKOP>> promise;
+        std::shared_future<std::shared_ptr<SKOP>> cached;
+        uint64_t ticket = 0;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->dist == D && it->seed == seed) {
+                    entries.splice(entries.begin(), entries, it);
+                    cached = it->result;
+                    break;
+                }
+            }
+            if (cached.valid()) {
+                ++num_hits;
+            } else {
+                ++num_misses;
+                ticket = next_ticket++;
+                int64_t bytes = operator_bytes(D);
+                entries.push_front(Entry{D, seed, bytes, ticket, promise.get_future().share()});
+                bytes_used += bytes;
+                evict();
+            }
+        }
+        if (cached.valid()) {
+            // Blocks if another thread is still sampling this operator.
+            return cached.get();
+        }
+        try {
+            auto S = std::make_shared<SKOP>(D, seed);
+            if constexpr (std::is_same_v<distribution_t, DenseDist>) {
+                fill_dense(*S, exec);
+            } else {
+                fill_sparse(*S, exec);
+            }
+            promise.set_value(S);
+            return S;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->ticket == ticket) {
+                    bytes_used -= it->bytes;
+                    entries.erase(it);
+                    break;
+                }
+            }
+            throw;
+        }
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The total size, in bytes, of the operators currently retained.
+    int64_t bytes_in_use() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return bytes_used;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of operators currently retained.
+    int64_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return (int64_t) entries.size();
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of calls to get() that found their operator in the cache.
+    int64_t hits() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return num_hits;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of calls to get() that had to sample their operator.
+    int64_t misses() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return num_misses;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// Drop every operator from the cache.
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries.clear();
+        bytes_used = 0;
+    }
+
+    // ---------------------------------------------------------------------------
+    /// The number of bytes that a filled operator sampled from D occupies.
+    static int64_t operator_bytes(const distribution_t &D) {
+        if constexpr (std::is_same_v<distribution_t, DenseDist>) {
+            return D.n_rows * D.n_cols * (int64_t) sizeof(scalar_t);
+        } else {
+            using sint_t = typename SKOP::index_t;
+            return D.full_nnz * (int64_t) (sizeof(scalar_t) + 2 * sizeof(sint_t));
+        }
+    }
+
+    private:
+    struct Entry {
+        const distribution_t dist;
+        const state_t seed;
+        const int64_t bytes;
+        const uint64_t ticket;
+        std::shared_future<std::shared_ptr<SKOP>> result;
+    };
+
+    // Drop least recently used entries until we're within capacity. Entries whose
+    // operators are still being sampled can be dropped too; the threads waiting on
+    // them hold their own reference to the result.
+    void evict() {
+        while (bytes_used > capacity_bytes && !entries.empty()) {
+            bytes_used -= entries.back().bytes;
+            entries.pop_back();
+        }
+    }
+
+    mutable std::mutex mtx;
+    std::list<Entry> entries; // most recently used first
+    int64_t bytes_used = 0;
+    int64_t num_hits = 0;
+    int64_t num_misses = 0;
+    uint64_t next_ticket = 0;
+};
+
+} // end namespace RandBLAS
@@ -32,6 +32,7 @@
 #include "RandBLAS/base.hh"
 #include <blas.hh>
 #include <concepts>
+#include <type_traits>
 
 
 namespace RandBLAS::sparse_data {
@@ -90,6 +91,22 @@ static inline void sorted_nonzero_locations_to_pointer_array(
     return;
 }
 
+// Call f(std::integral_constant<int64_t, K>{}) with K == nnz when nnz is 1, 2, 4, or 8,
+// and with K == 0 otherwise. Kernels that loop over a fixed number of nonzeros per
+// column can use K as a compile-time trip count (so the loop is fully unrolled) and
+// fall back to a runtime trip count when K == 0. The intended use is to call this
+// once, outside of any loop over columns.
+template <typename FUNC>
+static inline void dispatch_fixed_nnz(int64_t nnz, FUNC &&f) {
+    switch (nnz) {
+        case 1: f(std::integral_constant<int64_t, 1>{}); break;
+        case 2: f(std::integral_constant<int64_t, 2>{}); break;
+        case 4: f(std::integral_constant<int64_t, 4>{}); break;
+        case 8: f(std::integral_constant<int64_t, 8>{}); break;
+        default: f(std::integral_constant<int64_t, 0>{});
+    }
+}
+
 // Idea: change all "const" attributes to for SpMatrix to return values from inlined functions. 
 // Looks like there'd be no collision with function/property names for sparse matrix
 // types in Eigen, SuiteSparse, OneMKL, etc.. These inlined functions could return
@@ -183,6 +200,39 @@ concept SparseMatrix = requires(SpMat A) {
 #define SparseMatrix typename
 #endif
 
+// Call f(i, k, ell) for each structural nonzero A.vals[ell] that lies in the
+// d-by-m submatrix of A at offset (ro_a, co_a), where (i, k) are its indices
+// relative to that submatrix. A can be a COO, CSR, or CSC matrix with zero-based
+// indices. CSR and CSC matrices are only scanned over the rows (resp. columns)
+// that intersect the submatrix.
+template <SparseMatrix SpMat, typename FUNC>
+void for_each_in_window(const SpMat &A, int64_t ro_a, int64_t co_a, int64_t d, int64_t m, FUNC &&f) {
+    if constexpr (requires { A.rowptr; A.colidxs; }) {
+        for (int64_t i = 0; i < d; ++i) {
+            for (int64_t ell = A.rowptr[ro_a + i]; ell < A.rowptr[ro_a + i + 1]; ++ell) {
+                int64_t k = ((int64_t) A.colidxs[ell]) - co_a;
+                if (0 <= k && k < m)
+                    f(i, k, ell);
+            }
+        }
+    } else if constexpr (requires { A.colptr; A.rowidxs; }) {
+        for (int64_t k = 0; k < m; ++k) {
+            for (int64_t ell = A.colptr[co_a + k]; ell < A.colptr[co_a + k + 1]; ++ell) {
+                int64_t i = ((int64_t) A.rowidxs[ell]) - ro_a;
+                if (0 <= i && i < d)
+                    f(i, k, ell);
+            }
+        }
+    } else {
+        for (int64_t ell = 0; ell < A.nnz; ++ell) {
+            int64_t i = ((int64_t) A.rows[ell]) - ro_a;
+            int64_t k = ((int64_t) A.cols[ell]) - co_a;
+            if (0 <= i && i < d && 0 <= k && k < m)
+                f(i, k, ell);
+        }
+    }
+}
+
 } // end namespace RandBLAS::sparse_data
 
 namespace RandBLAS {
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "RandBLAS/base.hh"
+#include "RandBLAS/parallel.hh"
 #include "RandBLAS/exceptions.hh"
 #include "RandBLAS/sparse_data/base.hh"
 #include "RandBLAS/sparse_data/coo_matrix.hh"
@@ -48,14 +49,17 @@ void coo_to_csc(COOMatrix<T, sint_t1> &coo, CSCMatrix<T, sint_t2> &csc) {
     randblas_require(coo.index_base == IndexBase::Zero);
     sort_coo_data(NonzeroSort::CSC, coo);
     reserve_csc(coo.nnz, csc);
+    parallel::parallel_for(0, coo.nnz, [&](int64_t start, int64_t stop) {
+        for (int64_t ell = start; ell < stop; ++ell) {
+            csc.rowidxs[ell] = (sint_t2) coo.rows[ell];
+            csc.vals[ell] = coo.vals[ell];
+        }
+    });
     csc.colptr[0] = 0;
     int64_t ell = 0;
     for (int64_t j = 0; j < coo.n_cols; ++j) {
-        while (ell < coo.nnz && coo.cols[ell] == j) {
-            csc.rowidxs[ell] = (sint_t2) coo.rows[ell];
-            csc.vals[ell] = coo.vals[ell];
+        while (ell < coo.nnz && coo.cols[ell] == j)
             ++ell;
-        }
         csc.colptr[j+1] = (sint_t2) ell;
     }
     return;
@@ -68,15 +72,15 @@ void csc_to_coo(CSCMatrix<T, sint_t1> &csc, COOMatrix<T, sint_t2> &coo) {
     randblas_require(csc.index_base == IndexBase::Zero);
     randblas_require(coo.index_base == IndexBase::Zero);
     reserve_coo(csc.nnz, coo);
-    int64_t ell = 0;
-    for (int64_t j = 0; j < csc.n_cols; ++j) {
-        for (int64_t i = csc.colptr[j]; i < csc.colptr[j+1]; ++i) {
-            coo.vals[ell] = csc.vals[ell];
-            coo.rows[ell] = (sint_t2) i;
-            coo.cols[ell] = (sint_t2) j;
-            ++ell;
+    parallel::parallel_for(0, csc.n_cols, [&](int64_t j_start, int64_t j_stop) {
+        for (int64_t j = j_start; j < j_stop; ++j) {
+            for (int64_t ell = csc.colptr[j]; ell < csc.colptr[j+1]; ++ell) {
+                coo.vals[ell] = csc.vals[ell];
+                coo.rows[ell] = (sint_t2) csc.rowidxs[ell];
+                coo.cols[ell] = (sint_t2) j;
+            }
         }
-    }
+    });
     coo.sort = NonzeroSort::CSC;
     return;
 }
@@ -89,14 +93,17 @@ void coo_to_csr(COOMatrix<T, sint_t1> &coo, CSRMatrix<T, sint_t2> &csr) {
     randblas_require(coo.index_base == IndexBase::Zero);
     sort_coo_data(NonzeroSort::CSR, coo);
     reserve_csr(coo.nnz, csr);
+    parallel::parallel_for(0, coo.nnz, [&](int64_t start, int64_t stop) {
+        for (int64_t ell = start; ell < stop; ++ell) {
+            csr.colidxs[ell] = (sint_t2) coo.cols[ell];
+            csr.vals[ell] = coo.vals[ell];
+        }
+    });
     csr.rowptr[0] = (sint_t2) 0;
     int64_t ell = 0;
     for (int64_t i = 0; i < coo.n_rows; ++i) {
-        while (ell < coo.nnz && coo.rows[ell] == i) {
-            csr.colidxs[ell] = (sint_t2) coo.cols[ell];
-            csr.vals[ell] = coo.vals[ell];
+        while (ell < coo.nnz && coo.rows[ell] == i)
             ++ell;
-        }
         csr.rowptr[i+1] = (sint_t2) ell;
     }
     return;
@@ -109,15 +116,15 @@ void csr_to_coo(CSRMatrix<T, sint_t1> &csr, COOMatrix<T, sint_t2> &coo) {
     randblas_require(csr.index_base == IndexBase::Zero);
     randblas_require(coo.index_base == IndexBase::Zero);
     reserve_coo(csr.nnz, coo);
-    int64_t ell = 0;
-    for (int64_t i = 0; i < csr.n_rows; ++i) {
-        for (int64_t j = csr.rowptr[i]; j < csr.rowptr[i+1]; ++j) {
-            coo.vals[ell] = csr.vals[ell];
-            coo.rows[ell] = (sint_t2) i;
-            coo.cols[ell] = (sint_t2) j;
-            ++ell;
+    parallel::parallel_for(0, csr.n_rows, [&](int64_t i_start, int64_t i_stop) {
+        for (int64_t i = i_start; i < i_stop; ++i) {
+            for (int64_t ell = csr.rowptr[i]; ell < csr.rowptr[i+1]; ++ell) {
+                coo.vals[ell] = csr.vals[ell];
+                coo.rows[ell] = (sint_t2) i;
+                coo.cols[ell] = (sint_t2) csr.colidxs[ell];
+            }
         }
-    }
+    });
     coo.sort = NonzeroSort::CSR;
     return;
 }
@@ -131,10 +138,12 @@ CSRMatrix<T, sint_t> transpose_as_csr(CSCMatrix<T, sint_t> &A, bool share_memory
         CSRMatrix<T, sint_t> At(A.n_cols, A.n_rows);
         At.index_base = A.index_base;
         reserve_csr(A.nnz, At);
-        for (int64_t i = 0; i < A.nnz; ++i) {
-            At.colidxs[i] = A.rowidxs[i];
-            At.vals[i] = A.vals[i];
-        }
+        parallel::parallel_for(0, A.nnz, [&](int64_t start, int64_t stop) {
+            for (int64_t i = start; i < stop; ++i) {
+                At.colidxs[i] = A.rowidxs[i];
+                At.vals[i] = A.vals[i];
+            }
+        });
         for (int64_t i = 0; i < A.n_cols + 1; ++i)
             At.rowptr[i] = A.colptr[i];
         return At;
@@ -150,10 +159,12 @@ CSCMatrix<T, sint_t> transpose_as_csc(CSRMatrix<T, sint_t> &A, bool share_memory
         CSCMatrix<T, sint_t> At(A.n_cols, A.n_rows);
         At.index_base = A.index_base;
         reserve_csc(A.nnz, At);
-        for (int64_t i = 0; i < A.nnz; ++i) {
-            At.rowidxs[i] = A.colidxs[i];
-            At.vals[i] = A.vals[i];
-        }
+        parallel::parallel_for(0, A.nnz, [&](int64_t start, int64_t stop) {
+            for (int64_t i = start; i < stop; ++i) {
+                At.rowidxs[i] = A.colidxs[i];
+                At.vals[i] = A.vals[i];
+            }
+        });
         for (int64_t i = 0; i < A.n_rows + 1; ++i)
             At.colptr[i] = A.rowptr[i];
         return At;
@@ -174,13 +185,11 @@ template <typename T, SignedInteger sint_t>
 void reindex_inplace(CSCMatrix<T, sint_t> &A, IndexBase desired) {
     if (A.index_base == desired)
         return;
-    if (A.index_base == IndexBase::One) {
-        for (int64_t ell = 0; ell < A.nnz; ++ell)
-            A.rowidxs[ell] -= 1;
-    } else {
-        for (int64_t ell = 0; ell < A.nnz; ++ell)
-            A.rowidxs[ell] += 1;
-    }
+    sint_t shift = (A.index_base == IndexBase::One) ? -1 : 1;
+    parallel::parallel_for(0, A.nnz, [&](int64_t start, int64_t stop) {
+        for (int64_t ell = start; ell < stop; ++ell)
+            A.rowidxs[ell] += shift;
+    });
     A.index_base = desired;
     return;
 }
@@ -189,13 +198,11 @@ template <typename T, SignedInteger sint_t>
 void reindex_inplace(CSRMatrix<T, sint_t> &A, IndexBase desired) {
     if (A.index_base == desired)
         return;
-    if (A.index_base == IndexBase::One) {
-        for (int64_t ell = 0; ell < A.nnz; ++ell)
-            A.colidxs[ell] -= 1;
-    } else {
-        for (int64_t ell = 0; ell < A.nnz; ++ell)
-            A.colidxs[ell] += 1;  
-    }
+    sint_t shift = (A.index_base == IndexBase::One) ? -1 : 1;
+    parallel::parallel_for(0, A.nnz, [&](int64_t start, int64_t stop) {
+        for (int64_t ell = start; ell < stop; ++ell)
+            A.colidxs[ell] += shift;
+    });
     A.index_base = desired;
     return;
 }
@@ -204,17 +211,13 @@ template <typename T, SignedInteger sint_t>
 void reindex_inplace(COOMatrix<T,sint_t> &A, IndexBase desired) {
     if (A.index_base == desired)
         return;
-    if (A.index_base == IndexBase::One) {
-        for (int64_t ell = 0; ell < A.nnz; ++ell) {
-            A.rows[ell] -= 1;
-            A.cols[ell] -= 1;
+    sint_t shift = (A.index_base == IndexBase::One) ? -1 : 1;
+    parallel::parallel_for(0, A.nnz, [&](int64_t start, int64_t stop) {
+        for (int64_t ell = start; ell < stop; ++ell) {
+            A.rows[ell] += shift;
+            A.cols[ell] += shift;
         }
-    } else {
-        for (int64_t ell = 0; ell < A.nnz; ++ell) {
-            A.rows[ell] += 1;
-            A.cols[ell] += 1;
-        }
-    }
+    });
     A.index_base = desired;
     return;
 }
@@ -30,15 +30,13 @@
 #pragma once
 
 #include "RandBLAS/base.hh"
+#include "RandBLAS/parallel.hh"
 #include "RandBLAS/exceptions.hh"
 #include "RandBLAS/sparse_data/base.hh"
 #include "RandBLAS/sparse_data/coo_matrix.hh"
 #include "RandBLAS/sparse_data/csc_spmm_impl.hh"
 #include <vector>
 #include <algorithm>
-#if defined(RandBLAS_HAS_OpenMP)
-#include <omp.h>
-#endif
 
 namespace RandBLAS::sparse_data::coo {
 
@@ -136,28 +134,24 @@ static void apply_coo_left_jki_p11(
     auto C_inter_col_stride = s.inter_col_stride;
     auto C_inter_row_stride = s.inter_row_stride;
 
-    #pragma omp parallel default(shared)
-    {
-        const T *B_col = nullptr;
-        T *C_col = nullptr;
-        #pragma omp for schedule(static)
-        for (int64_t j = 0; j < n; j++) {
-            B_col = &B[B_inter_col_stride * j];
-            C_col = &C[C_inter_col_stride * j];
-            if (fixed_nnz_per_col) {
-                RandBLAS::sparse_data::csc::apply_regular_csc_to_vector_from_left_ki<T>(
-                    A_vals.data(), A_rows.data(), A_colptr[1],
-                    m, B_col, B_inter_row_stride,
-                    C_col, C_inter_row_stride
-                );
-            } else {
+    if (fixed_nnz_per_col) {
+        RandBLAS::sparse_data::csc::apply_regular_csc_left_jki<T>(
+            A_vals.data(), A_rows.data(), A_colptr[1], n, m,
+            B, B_inter_row_stride, B_inter_col_stride,
+            C, C_inter_row_stride, C_inter_col_stride
+        );
+    } else {
+        parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+            for (int64_t j = j_start; j < j_stop; j++) {
+                const T *B_col = &B[B_inter_col_stride * j];
+                T *C_col = &C[C_inter_col_stride * j];
                 RandBLAS::sparse_data::csc::apply_csc_to_vector_from_left_ki<T>(
                     A_vals.data(), A_rows.data(), A_colptr.data(),
                     m, B_col, B_inter_row_stride,
                     C_col, C_inter_row_stride
-                ); 
+                );
             }
-        }
+        });
     }
     return;
 }
@@ -29,14 +29,13 @@
 
 #pragma once
 #include "RandBLAS/base.hh"
+#include "RandBLAS/parallel.hh"
 #include "RandBLAS/exceptions.hh"
 #include "RandBLAS/sparse_data/base.hh"
 #include "RandBLAS/sparse_data/csc_matrix.hh"
 #include <vector>
 #include <algorithm>
-#if defined(RandBLAS_HAS_OpenMP)
-#include <omp.h>
-#endif
+#include <utility>
 
 namespace RandBLAS::sparse_data::csc {
 
@@ -89,6 +88,68 @@ static void apply_regular_csc_to_vector_from_left_ki(
     }
 }
 
+template <int64_t COL_NNZ, typename T, SignedInteger sint_t = int64_t>
+static void apply_regular_csc_to_vector_from_left_ki_unrolled(
+    // Same as apply_regular_csc_to_vector_from_left_ki, but with col_nnz
+    // known at compile time. The inner loop is expanded in full.
+    const T *vals,
+    sint_t *rowidxs,
+    // input-output vector data
+    int64_t len_v,
+    const T *v,
+    int64_t incv,   // stride between elements of v
+    T *Av,          // Av += A * v.
+    int64_t incAv   // stride between elements of Av
+) {
+    static_assert(COL_NNZ > 0);
+    for (int64_t c = 0; c < len_v; ++c) {
+        T scale = v[c * incv];
+        const T *vals_c = vals + c * COL_NNZ;
+        const sint_t *rowidxs_c = rowidxs + c * COL_NNZ;
+        [&]<int64_t... J>(std::integer_sequence<int64_t, J...>) {
+            ((Av[((int64_t) rowidxs_c[J]) * incAv] += (vals_c[J] * scale)), ...);
+        }(std::make_integer_sequence<int64_t, COL_NNZ>{});
+    }
+}
+
+template <typename T, SignedInteger sint_t = int64_t>
+static void apply_regular_csc_left_jki(
+    // Computes C[:, j] += A * B[:, j] for 0 <= j < n, where A is a "regular CSC"
+    // matrix with m columns and col_nnz nonzeros in each column. We dispatch on
+    // col_nnz once, so the per-column work uses an unrolled kernel when
+    // col_nnz is 1, 2, 4, or 8.
+    const T *vals,
+    sint_t *rowidxs,
+    int64_t col_nnz,
+    int64_t n,
+    int64_t m,
+    const T *B,
+    int64_t B_inter_row_stride,
+    int64_t B_inter_col_stride,
+    T *C,
+    int64_t C_inter_row_stride,
+    int64_t C_inter_col_stride
+) {
+    dispatch_fixed_nnz(col_nnz, [&](auto K) {
+        constexpr int64_t COL_NNZ = decltype(K)::value;
+        parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+            for (int64_t j = j_start; j < j_stop; j++) {
+                const T *B_col = &B[B_inter_col_stride * j];
+                T *C_col = &C[C_inter_col_stride * j];
+                if constexpr (COL_NNZ > 0) {
+                    apply_regular_csc_to_vector_from_left_ki_unrolled<COL_NNZ, T>(
+                        vals, rowidxs, m, B_col, B_inter_row_stride, C_col, C_inter_row_stride
+                    );
+                } else {
+                    apply_regular_csc_to_vector_from_left_ki<T>(
+                        vals, rowidxs, col_nnz, m, B_col, B_inter_row_stride, C_col, C_inter_row_stride
+                    );
+                }
+            }
+        });
+    });
+}
+
 template <typename T, SignedInteger sint_t>
 static void apply_csc_left_jki_p11(
     T alpha,
@@ -125,28 +186,24 @@ static void apply_csc_left_jki_p11(
     auto C_inter_col_stride = s.inter_col_stride;
     auto C_inter_row_stride = s.inter_row_stride;
 
-    #pragma omp parallel default(shared)
-    {
-        const T *B_col = nullptr;
-        T *C_col = nullptr;
-        #pragma omp for schedule(static)
-        for (int64_t j = 0; j < n; j++) {
-            B_col = &B[B_inter_col_stride * j];
-            C_col = &C[C_inter_col_stride * j];
-            if (fixed_nnz_per_col) {
-                apply_regular_csc_to_vector_from_left_ki<T>(
-                    vals, A.rowidxs, A.colptr[1],
-                    m, B_col, B_inter_row_stride,
-                    C_col, C_inter_row_stride
-                );
-            } else {
+    if (fixed_nnz_per_col) {
+        apply_regular_csc_left_jki<T>(
+            vals, A.rowidxs, A.colptr[1], n, m,
+            B, B_inter_row_stride, B_inter_col_stride,
+            C, C_inter_row_stride, C_inter_col_stride
+        );
+    } else {
+        parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+            for (int64_t j = j_start; j < j_stop; j++) {
+                const T *B_col = &B[B_inter_col_stride * j];
+                T *C_col = &C[C_inter_col_stride * j];
                 apply_csc_to_vector_from_left_ki<T>(
                     vals, A.rowidxs, A.colptr,
                     m, B_col, B_inter_row_stride,
                     C_col, C_inter_row_stride
-                ); 
+                );
             }
-        }
+        });
     }
     if (alpha != (T) 1.0) {
         delete [] vals;
@@ -172,30 +229,9 @@ static void apply_csc_left_kib_rowmajor_1p1(
     randblas_require(m == A.n_cols);
 
 
-    int num_threads = 1;
-    #if defined(RandBLAS_HAS_OpenMP)
-    #pragma omp parallel 
-    {
-        num_threads = omp_get_num_threads();
-    }
-    #endif
-
-    int* block_bounds = new int[num_threads + 1]{};
-    int block_size = d / num_threads;
-    if (block_size == 0) { block_size = 1;}
-    for (int t = 0; t < num_threads; ++t)
-        block_bounds[t+1] = block_bounds[t] + block_size;
-    block_bounds[num_threads] += d % num_threads;
-
-    #pragma omp parallel default(shared)
-    {
-        #if defined(RandBLAS_HAS_OpenMP)
-        int t = omp_get_thread_num();
-        #else
-        int t = 0;
-        #endif
-        int i_lower = block_bounds[t];
-        int i_upper = block_bounds[t+1];
+    // Each block of rows of C is updated by exactly one worker, so the
+    // rank-1 updates below never race with one another.
+    parallel::parallel_for(0, d, [&](int64_t i_lower, int64_t i_upper) {
         for (int64_t k = 0; k < m; ++k) {
             // Rank-1 update: C[:,:] += A[:,k] @ B[k,:]
             const T* row_B = &B[k*ldb];
@@ -208,9 +244,7 @@ static void apply_csc_left_kib_rowmajor_1p1(
                 }
             }
         }
-    }
-
-    delete [] block_bounds;
+    });
     return;
 }
 
@@ -30,14 +30,12 @@
 #pragma once
 
 #include "RandBLAS/base.hh"
+#include "RandBLAS/parallel.hh"
 #include "RandBLAS/exceptions.hh"
 #include "RandBLAS/sparse_data/base.hh"
 #include "RandBLAS/sparse_data/csr_matrix.hh"
 #include <vector>
 #include <algorithm>
-#if defined(RandBLAS_HAS_OpenMP)
-#include <omp.h>
-#endif
 
 
 namespace RandBLAS::sparse_data::csr {
@@ -100,12 +98,10 @@ static void apply_csr_left_jik_p11(
     auto C_inter_col_stride = s.inter_col_stride;
     auto C_inter_row_stride = s.inter_row_stride;
 
-    #pragma omp parallel default(shared)
-    {
+    parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
         const T *B_col = nullptr;
         T *C_col = nullptr;
-        #pragma omp for schedule(static)
-        for (int64_t j = 0; j < n; j++) {
+        for (int64_t j = j_start; j < j_stop; j++) {
             B_col = &B[B_inter_col_stride * j];
             C_col = &C[C_inter_col_stride * j];
             apply_csr_to_vector_from_left_ik(
@@ -114,7 +110,7 @@ static void apply_csr_left_jik_p11(
                 d, C_col, C_inter_row_stride
             );
         }
-    }
+    });
     if (alpha != (T) 1.0) {
         delete [] vals;
     }
@@ -138,10 +134,8 @@ static void apply_csr_left_ikb_rowmajor(
     randblas_require(d == A.n_rows);
     randblas_require(m == A.n_cols);
 
-    #pragma omp parallel default(shared)
-    {
-        #pragma omp for schedule(dynamic)
-        for (int64_t i = 0; i < d; ++i) {
+    parallel::parallel_for(0, d, [&](int64_t i_start, int64_t i_stop) {
+        for (int64_t i = i_start; i < i_stop; ++i) {
             // C[i, 0:n] += alpha * A[i, :] @ B[:, 0:n]
             T* row_C = &C[i*ldc];
             for (int64_t ell = A.rowptr[i]; ell < A.rowptr[i+1]; ++ell) {
@@ -153,7 +147,7 @@ static void apply_csr_left_ikb_rowmajor(
                 blas::axpy(n, scale, row_B, 1, row_C, 1);
             }
         }
-    }
+    }, 1);
     return;
 }
 
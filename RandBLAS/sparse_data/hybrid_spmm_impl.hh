@@ -0,0 +1,214 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/sparse_data/base.hh"
+#include "RandBLAS/sparse_data/coo_matrix.hh"
+#include "RandBLAS/sparse_data/csr_matrix.hh"
+#include "RandBLAS/sparse_data/csc_matrix.hh"
+#include <blas.hh>
+#include <vector>
+#include <type_traits>
+
+// Hybrid dense/sparse SpMM. A handful of nearly-dense rows or columns in a sparse
+// matrix wreck load balance in kernels that split work over rows (or columns) of the
+// sparse matrix, and they're handled much faster by GEMM anyway. The functions here
+// split submat(A) into dense panels and a sparse remainder, and apply the panels.
+
+namespace RandBLAS::sparse_data::hybrid {
+
+template <typename T>
+struct DensePanels {
+    // Indices (relative to submat(A)) of the dense rows, and a dense copy of those rows.
+    // The copy is len(rows)-by-m in the layout passed to split_dense_panels.
+    std::vector<int64_t> rows;
+    std::vector<T> row_panel;
+    // Indices (relative to submat(A)) of the dense columns, and a dense copy of their
+    // nonzeros that don't lie in a dense row. The copy is d-by-len(cols).
+    std::vector<int64_t> cols;
+    std::vector<T> col_panel;
+};
+
+// Copy the nonzeros of A for which keep[ell] is true into remainder, which must be
+// an empty memory-owning matrix with the same dimensions as A.
+template <SparseMatrix SpMat>
+void filter_nonzeros(const SpMat &A, const std::vector<bool> &keep, SpMat &remainder) {
+    using T = typename SpMat::scalar_t;
+    using sint_t = typename SpMat::index_t;
+    int64_t nnz = 0;
+    for (int64_t ell = 0; ell < A.nnz; ++ell)
+        nnz += (keep[ell]) ? 1 : 0;
+    if constexpr (std::is_same_v<SpMat, COOMatrix<T, sint_t>>) {
+        reserve_coo(nnz, remainder);
+        int64_t nz = 0;
+        for (int64_t ell = 0; ell < A.nnz; ++ell) {
+            if (!keep[ell])
+                continue;
+            remainder.vals[nz] = A.vals[ell];
+            remainder.rows[nz] = A.rows[ell];
+            remainder.cols[nz] = A.cols[ell];
+            ++nz;
+        }
+        remainder.sort = A.sort;
+    } else {
+        constexpr bool is_csr = std::is_same_v<SpMat, CSRMatrix<T, sint_t>>;
+        int64_t num_ptrs;
+        sint_t *ptr_in, *idxs_in, *ptr_out, *idxs_out;
+        if constexpr (is_csr) {
+            reserve_csr(nnz, remainder);
+            num_ptrs = A.n_rows;
+            ptr_in  = A.rowptr;           idxs_in  = A.colidxs;
+            ptr_out = remainder.rowptr;   idxs_out = remainder.colidxs;
+        } else {
+            reserve_csc(nnz, remainder);
+            num_ptrs = A.n_cols;
+            ptr_in  = A.colptr;           idxs_in  = A.rowidxs;
+            ptr_out = remainder.colptr;   idxs_out = remainder.rowidxs;
+        }
+        int64_t nz = 0;
+        ptr_out[0] = 0;
+        for (int64_t p = 0; p < num_ptrs; ++p) {
+            for (int64_t ell = ptr_in[p]; ell < ptr_in[p+1]; ++ell) {
+                if (!keep[ell])
+                    continue;
+                remainder.vals[nz] = A.vals[ell];
+                idxs_out[nz] = idxs_in[ell];
+                ++nz;
+            }
+            ptr_out[p+1] = (sint_t) nz;
+        }
+    }
+}
+
+// Split the d-by-m submatrix of A at offset (ro_a, co_a) into dense panels and a
+// sparse remainder. A row is dense if at least threshold * m of its entries are
+// structurally nonzero; a column is dense if at least threshold * d of its entries
+// are structurally nonzero. A nonzero in a dense row goes into panels.row_panel;
+// a nonzero in a dense column (but not a dense row) goes into panels.col_panel;
+// every other nonzero of A is copied into remainder.
+//
+// If there are no dense rows or columns then we return false, and we don't touch
+// panels or remainder. Otherwise we return true, and remainder is a memory-owning
+// matrix with the same dimensions and index base as A, for use with the same
+// (ro_a, co_a).
+template <SparseMatrix SpMat, typename T = SpMat::scalar_t>
+bool split_dense_panels(
+    double threshold, blas::Layout layout, const SpMat &A, int64_t ro_a, int64_t co_a,
+    int64_t d, int64_t m, DensePanels<T> &panels, SpMat &remainder
+) {
+    if (threshold <= 0.0 || d == 0 || m == 0)
+        return false;
+    std::vector<int64_t> row_nnz(d, 0);
+    std::vector<int64_t> col_nnz(m, 0);
+    for_each_in_window(A, ro_a, co_a, d, m, [&](int64_t i, int64_t k, int64_t) {
+        row_nnz[i] += 1;
+        col_nnz[k] += 1;
+    });
+    // Position of each row (resp. column) in its panel, or -1 if it's not dense.
+    std::vector<int64_t> row_pos(d, -1);
+    std::vector<int64_t> col_pos(m, -1);
+    for (int64_t i = 0; i < d; ++i) {
+        if (row_nnz[i] > 0 && (double) row_nnz[i] >= threshold * (double) m) {
+            row_pos[i] = (int64_t) panels.rows.size();
+            panels.rows.push_back(i);
+        }
+    }
+    for (int64_t k = 0; k < m; ++k) {
+        if (col_nnz[k] > 0 && (double) col_nnz[k] >= threshold * (double) d) {
+            col_pos[k] = (int64_t) panels.cols.size();
+            panels.cols.push_back(k);
+        }
+    }
+    int64_t r = (int64_t) panels.rows.size();
+    int64_t c = (int64_t) panels.cols.size();
+    if (r == 0 && c == 0)
+        return false;
+
+    bool colmajor = layout == blas::Layout::ColMajor;
+    panels.row_panel.assign(r * m, (T) 0);
+    panels.col_panel.assign(d * c, (T) 0);
+    std::vector<bool> keep(A.nnz, true);
+    for_each_in_window(A, ro_a, co_a, d, m, [&](int64_t i, int64_t k, int64_t ell) {
+        if (row_pos[i] >= 0) {
+            int64_t t = row_pos[i];
+            panels.row_panel[(colmajor) ? t + k * r : t * m + k] += A.vals[ell];
+            keep[ell] = false;
+        } else if (col_pos[k] >= 0) {
+            int64_t t = col_pos[k];
+            panels.col_panel[(colmajor) ? i + t * d : i * c + t] += A.vals[ell];
+            keep[ell] = false;
+        }
+    });
+    filter_nonzeros(A, keep, remainder);
+    return true;
+}
+
+// Compute C += alpha * (dense panels of submat(A)) * op(mat(B)), where C is d-by-n in
+// "layout", op(mat(B)) is m-by-n, and the panels came from split_dense_panels with
+// the same layout.
+template <typename T>
+void apply_dense_panels(
+    blas::Layout layout, blas::Op opB, int64_t d, int64_t n, int64_t m, T alpha,
+    const DensePanels<T> &panels, const T *B, int64_t ldb, T *C, int64_t ldc
+) {
+    using blas::Layout;
+    using blas::Op;
+    bool colmajor = layout == Layout::ColMajor;
+    auto [c_row, c_col] = layout_to_strides(layout, ldc);
+    int64_t r = (int64_t) panels.rows.size();
+    if (r > 0) {
+        // Y = alpha * row_panel * op(B) is r-by-n; then scatter the rows of Y into C.
+        std::vector<T> Y(r * n, (T) 0);
+        int64_t ldy = (colmajor) ? r : n;
+        blas::gemm(layout, Op::NoTrans, opB, r, n, m, alpha, panels.row_panel.data(), (colmajor) ? r : m, B, ldb, (T) 0, Y.data(), ldy);
+        for (int64_t t = 0; t < r; ++t) {
+            int64_t i = panels.rows[t];
+            for (int64_t j = 0; j < n; ++j)
+                C[i * c_row + j * c_col] += Y[(colmajor) ? t + j * ldy : t * ldy + j];
+        }
+    }
+    int64_t c = (int64_t) panels.cols.size();
+    if (c > 0) {
+        // G holds the rows of op(B) that match the dense columns; then C += alpha * col_panel * G.
+        auto layout_opB = (opB == Op::NoTrans) ? layout : ((colmajor) ? Layout::RowMajor : Layout::ColMajor);
+        auto [b_row, b_col] = layout_to_strides(layout_opB, ldb);
+        std::vector<T> G(c * n);
+        int64_t ldg = (colmajor) ? c : n;
+        for (int64_t t = 0; t < c; ++t) {
+            int64_t k = panels.cols[t];
+            for (int64_t j = 0; j < n; ++j)
+                G[(colmajor) ? t + j * ldg : t * ldg + j] = B[k * b_row + j * b_col];
+        }
+        blas::gemm(layout, Op::NoTrans, Op::NoTrans, d, n, c, alpha, panels.col_panel.data(), (colmajor) ? d : c, G.data(), ldg, (T) 1, C, ldc);
+    }
+}
+
+} // end namespace RandBLAS::sparse_data::hybrid
@@ -0,0 +1,314 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/sparse_data/base.hh"
+#include "RandBLAS/sparse_data/csr_matrix.hh"
+#include "RandBLAS/sparse_data/csc_matrix.hh"
+#include <algorithm>
+#include <concepts>
+
+namespace RandBLAS::sparse_data {
+
+// =============================================================================
+///
+///  A batch of \math{\ttt{batch_size}} sparse matrices that share one CSR sparsity pattern,
+///  given by \math{(\ttt{rowptr},\ttt{colidxs})} as in CSRMatrix. The values of the matrices
+///  are interleaved: the \math{\ttt{ell}^{\text{th}}} structural nonzero of the
+///  \math{\ttt{b}^{\text{th}}} matrix is \math{\ttt{vals[ell * batch_size + b]}.}
+///
+///  Kernels that apply a MultiCSRMatrix read each index once for the whole batch.
+///
+template <typename T, SignedInteger sint_t = int64_t>
+struct MultiCSRMatrix {
+
+    // ------------------------------------------------------------------------
+    /// Real scalar type used for structural nonzeros in this batch.
+    using scalar_t = T;
+
+    // ------------------------------------------------------------------------
+    /// Signed integer type used in the rowptr and colidxs array members.
+    using index_t = sint_t;
+
+    // ------------------------------------------------------------------------
+    ///  The number of rows in each matrix of the batch.
+    const int64_t n_rows;
+
+    // ------------------------------------------------------------------------
+    ///  The number of columns in each matrix of the batch.
+    const int64_t n_cols;
+
+    // ------------------------------------------------------------------------
+    ///  The number of matrices in the batch.
+    const int64_t batch_size;
+
+    // ------------------------------------------------------------------------
+    ///  If true, then delete [] will be called on each non-null reference member
+    ///  of this object at destruction time. Set automatically by the constructors.
+    bool own_memory;
+
+    // ------------------------------------------------------------------------
+    ///  The number of structural nonzeros in the shared pattern.
+    int64_t nnz;
+
+    // ------------------------------------------------------------------------
+    ///  A flag to indicate whether colidxs is interpreted
+    ///  with zero-based or one-based indexing.
+    IndexBase index_base;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to an array of length at least \math{\ttt{nnz * batch_size}} that holds
+    ///  the interleaved values of the batch.
+    T *vals;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to a pointer offset array of length at least \math{\ttt{n_rows + 1}}.
+    sint_t *rowptr;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to a column index array of length at least nnz.
+    sint_t *colidxs;
+
+    // ------------------------------------------------------------------------
+    ///  **Standard constructor.** The reference members are set to null pointers,
+    ///  nnz is set to zero, and own_memory is set to true. This constructor is
+    ///  intended for use with reserve_csr(int64_t nnz, MultiCSRMatrix &A).
+    MultiCSRMatrix(
+        int64_t n_rows,
+        int64_t n_cols,
+        int64_t batch_size
+    ) : n_rows(n_rows), n_cols(n_cols), batch_size(batch_size), own_memory(true), nnz(0),
+        index_base(IndexBase::Zero), vals(nullptr), rowptr(nullptr), colidxs(nullptr) {
+        randblas_require(batch_size > 0);
+    };
+
+    // ------------------------------------------------------------------------
+    /// **Expert constructor.** Arguments passed to this function are used to initialize
+    /// members of the same names; own_memory is set to false.
+    MultiCSRMatrix(
+        int64_t n_rows,
+        int64_t n_cols,
+        int64_t batch_size,
+        int64_t nnz,
+        T *vals,
+        sint_t *rowptr,
+        sint_t *colidxs,
+        IndexBase index_base = IndexBase::Zero
+    ) : n_rows(n_rows), n_cols(n_cols), batch_size(batch_size), own_memory(false), nnz(nnz),
+        index_base(index_base), vals(vals), rowptr(rowptr), colidxs(colidxs) {
+        randblas_require(batch_size > 0);
+    };
+
+    ~MultiCSRMatrix() {
+        if (own_memory) {
+            if (rowptr  != nullptr) delete [] rowptr;
+            if (colidxs != nullptr) delete [] colidxs;
+            if (vals    != nullptr) delete [] vals;
+        }
+    };
+
+    // move constructor
+    MultiCSRMatrix(MultiCSRMatrix<T, sint_t> &&other)
+    : n_rows(other.n_rows), n_cols(other.n_cols), batch_size(other.batch_size), own_memory(other.own_memory),
+      nnz(other.nnz), index_base(other.index_base), vals(nullptr), rowptr(nullptr), colidxs(nullptr) {
+        std::swap(colidxs, other.colidxs);
+        std::swap(rowptr , other.rowptr );
+        std::swap(vals   , other.vals   );
+        other.nnz = 0;
+    };
+};
+
+// =============================================================================
+///
+///  A batch of \math{\ttt{batch_size}} sparse matrices that share one CSC sparsity pattern,
+///  given by \math{(\ttt{colptr},\ttt{rowidxs})} as in CSCMatrix. The values of the matrices
+///  are interleaved: the \math{\ttt{ell}^{\text{th}}} structural nonzero of the
+///  \math{\ttt{b}^{\text{th}}} matrix is \math{\ttt{vals[ell * batch_size + b]}.}
+///
+///  Kernels that apply a MultiCSCMatrix read each index once for the whole batch.
+///
+template <typename T, SignedInteger sint_t = int64_t>
+struct MultiCSCMatrix {
+
+    // ------------------------------------------------------------------------
+    /// Real scalar type used for structural nonzeros in this batch.
+    using scalar_t = T;
+
+    // ------------------------------------------------------------------------
+    /// Signed integer type used in the colptr and rowidxs array members.
+    using index_t = sint_t;
+
+    // ------------------------------------------------------------------------
+    ///  The number of rows in each matrix of the batch.
+    const int64_t n_rows;
+
+    // ------------------------------------------------------------------------
+    ///  The number of columns in each matrix of the batch.
+    const int64_t n_cols;
+
+    // ------------------------------------------------------------------------
+    ///  The number of matrices in the batch.
+    const int64_t batch_size;
+
+    // ------------------------------------------------------------------------
+    ///  If true, then delete [] will be called on each non-null reference member
+    ///  of this object at destruction time. Set automatically by the constructors.
+    bool own_memory;
+
+    // ------------------------------------------------------------------------
+    ///  The number of structural nonzeros in the shared pattern.
+    int64_t nnz;
+
+    // ------------------------------------------------------------------------
+    ///  A flag to indicate whether rowidxs is interpreted
+    ///  with zero-based or one-based indexing.
+    IndexBase index_base;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to an array of length at least \math{\ttt{nnz * batch_size}} that holds
+    ///  the interleaved values of the batch.
+    T *vals;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to a row index array of length at least nnz.
+    sint_t *rowidxs;
+
+    // ------------------------------------------------------------------------
+    ///  Reference to a pointer offset array of length at least \math{\ttt{n_cols + 1}}.
+    sint_t *colptr;
+
+    // ------------------------------------------------------------------------
+    ///  **Standard constructor.** The reference members are set to null pointers,
+    ///  nnz is set to zero, and own_memory is set to true. This constructor is
+    ///  intended for use with reserve_csc(int64_t nnz, MultiCSCMatrix &A).
+    MultiCSCMatrix(
+        int64_t n_rows,
+        int64_t n_cols,
+        int64_t batch_size
+    ) : n_rows(n_rows), n_cols(n_cols), batch_size(batch_size), own_memory(true), nnz(0),
+        index_base(IndexBase::Zero), vals(nullptr), rowidxs(nullptr), colptr(nullptr) {
+        randblas_require(batch_size > 0);
+    };
+
+    // ------------------------------------------------------------------------
+    /// **Expert constructor.** Arguments passed to this function are used to initialize
+    /// members of the same names; own_memory is set to false.
+    MultiCSCMatrix(
+        int64_t n_rows,
+        int64_t n_cols,
+        int64_t batch_size,
+        int64_t nnz,
+        T *vals,
+        sint_t *rowidxs,
+        sint_t *colptr,
+        IndexBase index_base = IndexBase::Zero
+    ) : n_rows(n_rows), n_cols(n_cols), batch_size(batch_size), own_memory(false), nnz(nnz),
+        index_base(index_base), vals(vals), rowidxs(rowidxs), colptr(colptr) {
+        randblas_require(batch_size > 0);
+    };
+
+    ~MultiCSCMatrix() {
+        if (own_memory) {
+            if (rowidxs != nullptr) delete [] rowidxs;
+            if (colptr  != nullptr) delete [] colptr;
+            if (vals    != nullptr) delete [] vals;
+        }
+    };
+
+    // move constructor
+    MultiCSCMatrix(MultiCSCMatrix<T, sint_t> &&other)
+    : n_rows(other.n_rows), n_cols(other.n_cols), batch_size(other.batch_size), own_memory(other.own_memory),
+      nnz(other.nnz), index_base(other.index_base), vals(nullptr), rowidxs(nullptr), colptr(nullptr) {
+        std::swap(rowidxs, other.rowidxs);
+        std::swap(colptr , other.colptr );
+        std::swap(vals   , other.vals   );
+        other.nnz = 0;
+    };
+};
+
+#ifdef __cpp_concepts
+// =============================================================================
+/// Satisfied by MultiCSRMatrix and MultiCSCMatrix.
+template <typename M>
+concept MultiSparseMatrix = requires(M A) {
+    { A.n_rows }     -> std::same_as<const int64_t&>;
+    { A.n_cols }     -> std::same_as<const int64_t&>;
+    { A.batch_size } -> std::same_as<const int64_t&>;
+    { A.nnz }        -> std::same_as<int64_t&>;
+    { *(A.vals) }    -> std::same_as<typename M::scalar_t&>;
+};
+static_assert(MultiSparseMatrix<MultiCSRMatrix<double>>);
+static_assert(MultiSparseMatrix<MultiCSCMatrix<float>>);
+#else
+#define MultiSparseMatrix typename
+#endif
+
+// -----------------------------------------------------
+///
+/// Analogous to reserve_csr(int64_t nnz, CSRMatrix &M), except that
+/// M.vals is redirected to a new array of length nnz * M.batch_size.
+///
+template <typename T, SignedInteger sint_t>
+void reserve_csr(int64_t nnz, MultiCSRMatrix<T, sint_t> &M) {
+    randblas_require(M.own_memory);
+    randblas_require(M.colidxs == nullptr);
+    randblas_require(M.vals    == nullptr);
+    if (M.rowptr == nullptr)
+        M.rowptr = new sint_t[M.n_rows + 1]{0};
+    M.nnz = nnz;
+    if (nnz > 0) {
+        M.colidxs = new sint_t[nnz]{0};
+        M.vals    = new T[nnz * M.batch_size]{0.0};
+    }
+    return;
+}
+
+// -----------------------------------------------------
+///
+/// Analogous to reserve_csc(int64_t nnz, CSCMatrix &M), except that
+/// M.vals is redirected to a new array of length nnz * M.batch_size.
+///
+template <typename T, SignedInteger sint_t>
+void reserve_csc(int64_t nnz, MultiCSCMatrix<T, sint_t> &M) {
+    randblas_require(M.own_memory);
+    randblas_require(M.rowidxs == nullptr);
+    randblas_require(M.vals    == nullptr);
+    if (M.colptr == nullptr)
+        M.colptr = new sint_t[M.n_cols + 1]{0};
+    M.nnz = nnz;
+    if (nnz > 0) {
+        M.rowidxs = new sint_t[nnz]{0};
+        M.vals    = new T[nnz * M.batch_size]{0.0};
+    }
+    return;
+}
+
+} // end namespace RandBLAS::sparse_data
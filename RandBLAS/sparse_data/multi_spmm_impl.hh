@@ -0,0 +1,227 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "RandBLAS/base.hh"
+#include "RandBLAS/exceptions.hh"
+#include "RandBLAS/parallel.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/sparse_data/base.hh"
+#include "RandBLAS/sparse_data/multi_matrix.hh"
+#include <type_traits>
+
+namespace RandBLAS::sparse_data::multi {
+
+// Views of the transpose of a batch. These don't copy or own any data.
+template <typename T, SignedInteger sint_t>
+MultiCSCMatrix<T, sint_t> transpose(MultiCSRMatrix<T, sint_t> &A) {
+    return MultiCSCMatrix<T, sint_t>(A.n_cols, A.n_rows, A.batch_size, A.nnz, A.vals, A.colidxs, A.rowptr, A.index_base);
+}
+
+template <typename T, SignedInteger sint_t>
+MultiCSRMatrix<T, sint_t> transpose(MultiCSCMatrix<T, sint_t> &A) {
+    return MultiCSRMatrix<T, sint_t>(A.n_cols, A.n_rows, A.batch_size, A.nnz, A.vals, A.colptr, A.rowidxs, A.index_base);
+}
+
+// C_b += alpha * A_b * op(B) for every matrix A_b in the batch, where C_b = C + b * stride_c.
+// Work is split over rows of A, so each thread writes to its own rows of every C_b.
+template <typename T, SignedInteger sint_t>
+static void apply_multi_csr_left_ibj(
+    T alpha,
+    blas::Layout layout_opB,
+    blas::Layout layout_C,
+    int64_t d,
+    int64_t n,
+    const MultiCSRMatrix<T, sint_t> &A,
+    const T *B,
+    int64_t ldb,
+    T *C,
+    int64_t ldc,
+    int64_t stride_c
+) {
+    auto s = layout_to_strides(layout_opB, ldb);
+    auto b_row = s.inter_row_stride;
+    auto b_col = s.inter_col_stride;
+    s = layout_to_strides(layout_C, ldc);
+    auto c_row = s.inter_row_stride;
+    auto c_col = s.inter_col_stride;
+    const int64_t batch_size = A.batch_size;
+    parallel::parallel_for(0, d, [&](int64_t i_start, int64_t i_stop) {
+        for (int64_t i = i_start; i < i_stop; ++i) {
+            for (int64_t ell = A.rowptr[i]; ell < A.rowptr[i+1]; ++ell) {
+                const T *B_row = B + ((int64_t) A.colidxs[ell]) * b_row;
+                const T *v = A.vals + ell * batch_size;
+                for (int64_t b = 0; b < batch_size; ++b) {
+                    T coeff = alpha * v[b];
+                    T *C_row = C + b * stride_c + i * c_row;
+                    for (int64_t j = 0; j < n; ++j)
+                        C_row[j * c_col] += coeff * B_row[j * b_col];
+                }
+            }
+        }
+    });
+}
+
+// C_b += alpha * A_b * op(B) for every matrix A_b in the batch, where C_b = C + b * stride_c.
+// Work is split over columns of op(B), so each thread writes to its own columns of every C_b.
+template <typename T, SignedInteger sint_t>
+static void apply_multi_csc_left_jkb(
+    T alpha,
+    blas::Layout layout_opB,
+    blas::Layout layout_C,
+    int64_t n,
+    int64_t m,
+    const MultiCSCMatrix<T, sint_t> &A,
+    const T *B,
+    int64_t ldb,
+    T *C,
+    int64_t ldc,
+    int64_t stride_c
+) {
+    auto s = layout_to_strides(layout_opB, ldb);
+    auto b_row = s.inter_row_stride;
+    auto b_col = s.inter_col_stride;
+    s = layout_to_strides(layout_C, ldc);
+    auto c_row = s.inter_row_stride;
+    auto c_col = s.inter_col_stride;
+    const int64_t batch_size = A.batch_size;
+    parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+        for (int64_t j = j_start; j < j_stop; ++j) {
+            T *C_col = C + j * c_col;
+            for (int64_t k = 0; k < m; ++k) {
+                T scale = alpha * B[k * b_row + j * b_col];
+                if (scale == (T) 0)
+                    continue;
+                for (int64_t ell = A.colptr[k]; ell < A.colptr[k+1]; ++ell) {
+                    T *C_entry = C_col + ((int64_t) A.rowidxs[ell]) * c_row;
+                    const T *v = A.vals + ell * batch_size;
+                    for (int64_t b = 0; b < batch_size; ++b)
+                        C_entry[b * stride_c] += v[b] * scale;
+                }
+            }
+        }
+    });
+}
+
+} // end namespace RandBLAS::sparse_data::multi
+
+
+namespace RandBLAS::sparse_data {
+
+// Compute C_b = alpha * op(A_b) * op(mat(B)) + beta * C_b for each matrix A_b in the batch A,
+// where C_b is the d-by-n matrix that starts at C + b * stride_c. The matrices C_b must not overlap.
+template <MultiSparseMatrix MultiSpMat, typename T = MultiSpMat::scalar_t>
+void left_spmm_multi(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opB,
+    int64_t d, // each C_b is d-by-n
+    int64_t n, // \op(B) is m-by-n
+    int64_t m, // each \op(A_b) is d-by-m
+    T alpha,
+    MultiSpMat &A,
+    const T *B,
+    int64_t ldb,
+    T beta,
+    T *C,
+    int64_t ldc,
+    int64_t stride_c
+) {
+    using blas::Layout;
+    using blas::Op;
+    using sint_t = typename MultiSpMat::index_t;
+    constexpr bool is_csr = std::is_same_v<MultiSpMat, MultiCSRMatrix<T, sint_t>>;
+    constexpr bool is_csc = std::is_same_v<MultiSpMat, MultiCSCMatrix<T, sint_t>>;
+    static_assert(is_csr || is_csc);
+    if (opA == Op::Trans) {
+        auto At = multi::transpose(A);
+        left_spmm_multi(layout, Op::NoTrans, opB, d, n, m, alpha, At, B, ldb, beta, C, ldc, stride_c);
+        return;
+    }
+    randblas_require(A.index_base == IndexBase::Zero);
+    randblas_require(A.n_rows == d);
+    randblas_require(A.n_cols == m);
+
+    Layout layout_opB = layout;
+    if (opB == Op::Trans)
+        layout_opB = (layout == Layout::ColMajor) ? Layout::RowMajor : Layout::ColMajor;
+    auto [rows_B, cols_B] = dims_before_op(m, n, opB);
+    if (layout == Layout::ColMajor) {
+        randblas_require(ldb >= rows_B);
+        randblas_require(ldc >= d);
+    } else {
+        randblas_require(ldb >= cols_B);
+        randblas_require(ldc >= n);
+    }
+    for (int64_t b = 0; b < A.batch_size; ++b) {
+        T *C_b = C + b * stride_c;
+        if (layout == Layout::ColMajor) {
+            for (int64_t j = 0; j < n; ++j)
+                RandBLAS::util::safe_scal(d, beta, &C_b[j * ldc], 1);
+        } else {
+            for (int64_t i = 0; i < d; ++i)
+                RandBLAS::util::safe_scal(n, beta, &C_b[i * ldc], 1);
+        }
+    }
+    if (alpha == (T) 0)
+        return;
+
+    if constexpr (is_csr) {
+        multi::apply_multi_csr_left_ibj(alpha, layout_opB, layout, d, n, A, B, ldb, C, ldc, stride_c);
+    } else {
+        multi::apply_multi_csc_left_jkb(alpha, layout_opB, layout, n, m, A, B, ldb, C, ldc, stride_c);
+    }
+}
+
+// Compute C_b = alpha * op(mat(A)) * op(B_b) + beta * C_b for each matrix B_b in the batch B,
+// where C_b is the m-by-d matrix that starts at C + b * stride_c. This reduces to left_spmm_multi
+// in the same way that right_spmm reduces to left_spmm.
+template <MultiSparseMatrix MultiSpMat, typename T = MultiSpMat::scalar_t>
+inline void right_spmm_multi(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opB,
+    int64_t m, // each C_b is m-by-d
+    int64_t d, // each op(B_b) is n-by-d
+    int64_t n, // op(A) is m-by-n
+    T alpha,
+    const T *A,
+    int64_t lda,
+    MultiSpMat &B,
+    T beta,
+    T *C,
+    int64_t ldc,
+    int64_t stride_c
+) {
+    auto trans_opB = (opB == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    auto trans_layout = (layout == blas::Layout::ColMajor) ? blas::Layout::RowMajor : blas::Layout::ColMajor;
+    left_spmm_multi(trans_layout, trans_opB, opA, d, m, n, alpha, B, A, lda, beta, C, ldc, stride_c);
+}
+
+} // end namespace RandBLAS::sparse_data
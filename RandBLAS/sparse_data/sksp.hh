@@ -32,6 +32,7 @@
 #include "RandBLAS/base.hh"
 #include "RandBLAS/dense_skops.hh"
 #include "RandBLAS/exceptions.hh"
+#include "RandBLAS/sparse_data/multi_spmm_impl.hh"
 
 
 namespace RandBLAS::sparse_data {
@@ -41,7 +42,8 @@ namespace RandBLAS::sparse_data {
 // =============================================================================
 /// \fn lsksp3(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d,
 ///     int64_t n, int64_t m, T alpha, DenseSkOp<T,RNG> &S, int64_t ro_s, int64_t co_s,
-///     SpMat &A, int64_t ro_a, int64_t co_a, T beta, T *B, int64_t ldb
+///     SpMat &A, int64_t ro_a, int64_t co_a, T beta, T *B, int64_t ldb, const T *diag,
+///     double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the left in an SpMM-like operation
@@ -128,6 +130,13 @@ namespace RandBLAS::sparse_data {
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B`.
 ///
+///      diag - [in]
+///       * Optional pointer to an array of :math:`m` real scalars.
+///       * If provided, then :math:`\op(\submat(\mtxA))` is replaced by :math:`\operatorname{diag}(\ttt{diag}) \cdot \op(\submat(\mtxA))`.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional). See sketch_sparse.
+///
 /// @endverbatim
 template <typename T, SparseMatrix SpMat, typename DenseSkOp>
 void lsksp3(
@@ -146,17 +155,30 @@ void lsksp3(
     int64_t co_a,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr,
+    double dense_split_threshold = 0.0
 ) {
     // B = op(submat(\mtxS)) @ op(submat(\mtxA))
     auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
     constexpr bool maybe_denseskop = !std::is_same_v<std::remove_cv_t<DenseSkOp>, BLASFriendlyOperator<T>>;
+    if (diag != nullptr) {
+        // op(submat(S)) * diag(diag) scales the columns of op(submat(S)).
+        if constexpr (maybe_denseskop)
+            RandBLAS::dense::fill_if_lazy(S);
+        bool scale_rows = (opS == blas::Op::Trans);
+        auto submat_S = scaled_submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s,
+            scale_rows ? diag : nullptr, scale_rows ? nullptr : diag);
+        lsksp3(layout, opS, opA, d, n, m, alpha, submat_S, 0, 0, A, ro_a, co_a, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
+        return;
+    }
     if constexpr (maybe_denseskop) {
+        RandBLAS::dense::fill_if_lazy(S);
         if (!S.buff) {
             // DenseSkOp doesn't permit defining a "black box" distribution, so we have to pack the submatrix
             // into an equivalent datastructure ourselves.
             auto submat_S = submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s);
-            lsksp3(layout, opS, opA, d, n, m, alpha, submat_S, 0, 0, A, ro_a, co_a, beta, B, ldb);
+            lsksp3(layout, opS, opA, d, n, m, alpha, submat_S, 0, 0, A, ro_a, co_a, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
             return;
         } // else, proceed with the rest of the function call.
     } 
@@ -177,7 +199,7 @@ void lsksp3(
     if (S.layout != layout)
         opS = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
 
-    right_spmm(layout, opS, opA, d, n, m, alpha, S_ptr, lds, A, ro_a, co_a, beta, B, ldb);
+    right_spmm(layout, opS, opA, d, n, m, alpha, S_ptr, lds, A, ro_a, co_a, beta, B, ldb, dense_split_threshold);
     return;
 }
 
@@ -186,7 +208,8 @@ void lsksp3(
 // =============================================================================
 /// \fn rsksp3(blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m,
 ///     int64_t d, int64_t n, T alpha, SpMat &A, int64_t ro_a, int64_t co_a,
-///     DenseSkOp<T,RNG> &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb
+///     DenseSkOp<T,RNG> &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb, const T *diag,
+///     double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the right in an SpMM-like operation
@@ -273,6 +296,13 @@ void lsksp3(
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B`.
 ///
+///      diag - [in]
+///       * Optional pointer to an array of :math:`n` real scalars.
+///       * If provided, then :math:`\op(\submat(\mtxA))` is replaced by :math:`\op(\submat(\mtxA)) \cdot \operatorname{diag}(\ttt{diag})`.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional). See sketch_sparse.
+///
 /// @endverbatim
 template <typename T, SparseMatrix SpMat, typename DenseSkOp>
 void rsksp3(
@@ -291,16 +321,29 @@ void rsksp3(
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const T *diag = nullptr,
+    double dense_split_threshold = 0.0
 ) {
     auto [rows_submat_S, cols_submat_S] = dims_before_op(n, d, opS);
     constexpr bool maybe_denseskop = !std::is_same_v<std::remove_cv_t<DenseSkOp>, BLASFriendlyOperator<T>>;
+    if (diag != nullptr) {
+        // diag(diag) * op(submat(S)) scales the rows of op(submat(S)).
+        if constexpr (maybe_denseskop)
+            RandBLAS::dense::fill_if_lazy(S);
+        bool scale_rows = (opS == blas::Op::NoTrans);
+        auto submat_S = scaled_submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s,
+            scale_rows ? diag : nullptr, scale_rows ? nullptr : diag);
+        rsksp3(layout, opA, opS, m, d, n, alpha, A, ro_a, co_a, submat_S, 0, 0, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
+        return;
+    }
     if constexpr (maybe_denseskop) {
+        RandBLAS::dense::fill_if_lazy(S);
         if (!S.buff) {
             // DenseSkOp doesn't permit defining a "black box" distribution, so we have to pack the submatrix
             // into an equivalent datastructure ourselves.
             auto submat_S = submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s);
-            rsksp3(layout, opA, opS, m, d, n, alpha, A, ro_a, co_a, submat_S, 0, 0, beta, B, ldb);
+            rsksp3(layout, opA, opS, m, d, n, alpha, A, ro_a, co_a, submat_S, 0, 0, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
             return;
         }
     }
@@ -321,10 +364,38 @@ void rsksp3(
     if (S.layout != layout)
         opS = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
 
-    left_spmm(layout, opA, opS, m, d, n, alpha, A, ro_a, co_a, S_ptr, lds, beta, B, ldb);
+    left_spmm(layout, opA, opS, m, d, n, alpha, A, ro_a, co_a, S_ptr, lds, beta, B, ldb, dense_split_threshold);
     return;
 }
 
+// MARK: batched
+
+// Call f(opS_eff, S_ptr, lds), where op(submat(S)) is opS_eff applied to the matrix that
+// S_ptr defines when read in "layout" with leading dimension lds. If S is an unfilled
+// DenseSkOp, then S_ptr points to a temporary copy of submat(S).
+template <typename T, typename DenseSkOp, typename FUNC>
+void with_submat_buffer(
+    blas::Layout layout, blas::Op opS, DenseSkOp &S, int64_t rows_submat_S, int64_t cols_submat_S,
+    int64_t ro_s, int64_t co_s, FUNC &&f
+) {
+    constexpr bool maybe_denseskop = !std::is_same_v<std::remove_cv_t<DenseSkOp>, BLASFriendlyOperator<T>>;
+    if constexpr (maybe_denseskop) {
+        RandBLAS::dense::fill_if_lazy(S);
+        if (!S.buff) {
+            auto submat_S = submatrix_as_blackbox<BLASFriendlyOperator<T>>(S, rows_submat_S, cols_submat_S, ro_s, co_s);
+            with_submat_buffer<T>(layout, opS, submat_S, rows_submat_S, cols_submat_S, 0, 0, f);
+            return;
+        }
+    }
+    randblas_require( S.buff != nullptr );
+    randblas_require( S.n_rows >= rows_submat_S + ro_s );
+    randblas_require( S.n_cols >= cols_submat_S + co_s );
+    auto [pos, lds] = offset_and_ldim(S.layout, S.n_rows, S.n_cols, ro_s, co_s);
+    if (S.layout != layout)
+        opS = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+    f(opS, (const T *) &S.buff[pos], lds);
+}
+
 }  // end namespace RandBLAS::sparse_data
 
 
@@ -337,7 +408,8 @@ using namespace RandBLAS::sparse_data;
 
 // =============================================================================
 /// \fn sketch_sparse(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d,  int64_t n, int64_t m,
-///     T alpha, DenseSkOp &S, int64_t ro_s, int64_t co_s, SpMat &A, T beta, T *B, int64_t ldb
+///     T alpha, DenseSkOp &S, int64_t ro_s, int64_t co_s, SpMat &A, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec, double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the left in an SpMM-like operation
@@ -414,6 +486,17 @@ using namespace RandBLAS::sparse_data;
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B`.
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional).
+///       * If positive, then each row or column of :math:`\mtxA` whose fraction of structural
+///         nonzeros is at least this value is moved into a dense panel, which is applied with GEMM.
+///         The remaining nonzeros are handled by the usual sparse kernels.
+///       * Zero (the default) disables this splitting.
+///
 /// @endverbatim
 template <SparseMatrix SpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
 inline void sketch_sparse(
@@ -430,16 +513,20 @@ inline void sketch_sparse(
     SpMat &A,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    double dense_split_threshold = 0.0
 ) {
-    sparse_data::lsksp3(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, 0, 0, beta, B, ldb);
+    exec::ScopedPolicy scoped_policy(exec);
+    sparse_data::lsksp3(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, 0, 0, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
     return;
 }
 
 
 // =============================================================================
 /// \fn sketch_sparse(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d,
-///     int64_t n, int64_t m, T alpha, SpMat &A, DenseSkOp &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb
+///     int64_t n, int64_t m, T alpha, SpMat &A, DenseSkOp &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec, double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Sketch from the right in an SpMM-like operation
@@ -516,6 +603,102 @@ inline void sketch_sparse(
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(B)` when reading from :math:`B`.
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional).
+///       * If positive, then each row or column of :math:`\mtxA` whose fraction of structural
+///         nonzeros is at least this value is moved into a dense panel, which is applied with GEMM.
+///         The remaining nonzeros are handled by the usual sparse kernels.
+///       * Zero (the default) disables this splitting.
+///
+/// @endverbatim
+template <SparseMatrix SpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
+inline void sketch_sparse(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // B is m-by-d
+    int64_t d, // op(submat(\mtxA)) is m-by-n
+    int64_t n, // op(submat(\mtxS)) is n-by-d
+    T alpha,
+    SpMat &A,
+    DenseSkOp &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    double dense_split_threshold = 0.0
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    sparse_data::rsksp3(layout, opA, opS, m, d, n, alpha, A, 0, 0, S, ro_s, co_s, beta, B, ldb, (const T *) nullptr, dense_split_threshold);
+    return;
+}
+
+// MARK: SKSP overloads, diagonal scaling
+
+// =============================================================================
+/// \fn sketch_sparse(blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+///     T alpha, DenseSkOp &S, int64_t ro_s, int64_t co_s, const T *diag, SpMat &A, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec, double dense_split_threshold
+/// )
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a row-scaled sparse matrix from the left in an SpMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\operatorname{diag}(\ttt{diag})}_{m \times m} \cdot \underbrace{\op(\mtxA)}_{m \times n} + \beta \cdot \underbrace{\mat(B)}_{d \times n}.    \tag{$\star$}
+///
+/// We scale a copy of :math:`\op(\submat(\mtxS))` rather than :math:`\mtxA`. If :math:`\mtxS` hasn't
+/// been filled then the copy is scaled as it's generated.
+///
+/// The parameter :math:`\ttt{diag}` is a pointer to an array of :math:`m` real scalars. All other
+/// parameters are as in the overload of sketch_sparse that omits :math:`\ttt{diag}`.
+///
+/// @endverbatim
+template <SparseMatrix SpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
+inline void sketch_sparse(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // B is d-by-n
+    int64_t n, // op(submat(\mtxA)) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    DenseSkOp &S,
+    int64_t ro_s,
+    int64_t co_s,
+    const T *diag,
+    SpMat &A,
+    T beta,
+    T *B,
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    double dense_split_threshold = 0.0
+) {
+    randblas_require(diag != nullptr);
+    exec::ScopedPolicy scoped_policy(exec);
+    sparse_data::lsksp3(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A, 0, 0, beta, B, ldb, diag, dense_split_threshold);
+    return;
+}
+
+// =============================================================================
+/// \fn sketch_sparse(blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
+///     T alpha, SpMat &A, const T *diag, DenseSkOp &S, int64_t ro_s, int64_t co_s, T beta, T *B, int64_t ldb,
+///     const ExecPolicy &exec, double dense_split_threshold
+/// )
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a column-scaled sparse matrix from the right in an SpMM-like operation
+///
+/// .. math::
+///     \mat(B) = \alpha \cdot \underbrace{\op(\mtxA)}_{m \times n} \cdot \underbrace{\operatorname{diag}(\ttt{diag})}_{n \times n} \cdot \underbrace{\op(\submat(\mtxS))}_{n \times d} + \beta \cdot \underbrace{\mat(B)}_{m \times d}.    \tag{$\star$}
+///
+/// The parameter :math:`\ttt{diag}` is a pointer to an array of :math:`n` real scalars. All other
+/// parameters are as in the overload of sketch_sparse that omits :math:`\ttt{diag}`.
+///
 /// @endverbatim
 template <SparseMatrix SpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
 inline void sketch_sparse(
@@ -527,15 +710,104 @@ inline void sketch_sparse(
     int64_t n, // op(submat(\mtxS)) is n-by-d
     T alpha,
     SpMat &A,
+    const T *diag,
     DenseSkOp &S,
     int64_t ro_s,
     int64_t co_s,
     T beta,
     T *B,
-    int64_t ldb
+    int64_t ldb,
+    const ExecPolicy &exec = {},
+    double dense_split_threshold = 0.0
 ) {
-    sparse_data::rsksp3(layout, opA, opS, m, d, n, alpha, A, 0, 0, S, ro_s, co_s, beta, B, ldb);
+    randblas_require(diag != nullptr);
+    exec::ScopedPolicy scoped_policy(exec);
+    sparse_data::rsksp3(layout, opA, opS, m, d, n, alpha, A, 0, 0, S, ro_s, co_s, beta, B, ldb, diag, dense_split_threshold);
     return;
 }
 
+// MARK: batched sketching
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a batch of sparse matrices that share one sparsity pattern, from the left.
+/// For :math:`0 \leq b < \ttt{A.batch_size},` this computes
+///
+/// .. math::
+///     \mat(B_b) = \alpha \cdot \underbrace{\op(\submat(\mtxS))}_{d \times m} \cdot \underbrace{\op(\mtxA_b)}_{m \times n} + \beta \cdot \underbrace{\mat(B_b)}_{d \times n},
+///
+/// where :math:`\mtxA_b` is the :math:`b^{\text{th}}` matrix in the batch :math:`\mtxA`
+/// (a MultiCSRMatrix or MultiCSCMatrix), and :math:`\mat(B_b)` is read from the buffer that starts at
+/// :math:`\ttt{B + b * strideb}` with leading dimension :math:`\ttt{ldb}.` The matrices :math:`\mat(B_b)`
+/// must not overlap. We make one pass over the indices of :math:`\mtxA` for the whole batch.
+///
+/// All other arguments have the same meaning as in sketch_sparse.
+/// @endverbatim
+template <MultiSparseMatrix MultiSpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
+inline void sketch_sparse_batched(
+    blas::Layout layout,
+    blas::Op opS,
+    blas::Op opA,
+    int64_t d, // each B_b is d-by-n
+    int64_t n, // each op(A_b) is m-by-n
+    int64_t m, // op(submat(\mtxS)) is d-by-m
+    T alpha,
+    DenseSkOp &S,
+    int64_t ro_s,
+    int64_t co_s,
+    MultiSpMat &A,
+    T beta,
+    T *B,
+    int64_t ldb,
+    int64_t strideb,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    auto [rows_submat_S, cols_submat_S] = dims_before_op(d, m, opS);
+    sparse_data::with_submat_buffer<T>(layout, opS, S, rows_submat_S, cols_submat_S, ro_s, co_s,
+        [&](blas::Op opS_eff, const T *S_ptr, int64_t lds) {
+            sparse_data::right_spmm_multi(layout, opS_eff, opA, d, n, m, alpha, S_ptr, lds, A, beta, B, ldb, strideb);
+        }
+    );
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Sketch a batch of sparse matrices that share one sparsity pattern, from the right.
+/// For :math:`0 \leq b < \ttt{A.batch_size},` this computes
+///
+/// .. math::
+///     \mat(B_b) = \alpha \cdot \underbrace{\op(\mtxA_b)}_{m \times n} \cdot \underbrace{\op(\submat(\mtxS))}_{n \times d} + \beta \cdot \underbrace{\mat(B_b)}_{m \times d},
+///
+/// where :math:`\mtxA_b` and :math:`\mat(B_b)` are as in the left-sketching overload of
+/// sketch_sparse_batched.
+/// @endverbatim
+template <MultiSparseMatrix MultiSpMat, typename DenseSkOp, typename T = DenseSkOp::scalar_t>
+inline void sketch_sparse_batched(
+    blas::Layout layout,
+    blas::Op opA,
+    blas::Op opS,
+    int64_t m, // each B_b is m-by-d
+    int64_t d, // op(submat(\mtxS)) is n-by-d
+    int64_t n, // each op(A_b) is m-by-n
+    T alpha,
+    MultiSpMat &A,
+    DenseSkOp &S,
+    int64_t ro_s,
+    int64_t co_s,
+    T beta,
+    T *B,
+    int64_t ldb,
+    int64_t strideb,
+    const ExecPolicy &exec = {}
+) {
+    exec::ScopedPolicy scoped_policy(exec);
+    auto [rows_submat_S, cols_submat_S] = dims_before_op(n, d, opS);
+    sparse_data::with_submat_buffer<T>(layout, opS, S, rows_submat_S, cols_submat_S, ro_s, co_s,
+        [&](blas::Op opS_eff, const T *S_ptr, int64_t lds) {
+            sparse_data::left_spmm_multi(layout, opA, opS_eff, m, d, n, alpha, A, S_ptr, lds, beta, B, ldb, strideb);
+        }
+    );
+}
+
 }  // end namespace RandBLAS
@@ -39,6 +39,7 @@
 #include "RandBLAS/sparse_data/csc_spmm_impl.hh"
 #include "RandBLAS/sparse_data/csr_spmm_impl.hh"
 #include "RandBLAS/sparse_data/coo_spmm_impl.hh"
+#include "RandBLAS/sparse_data/hybrid_spmm_impl.hh"
 #include <vector>
 #include <algorithm>
 
@@ -61,7 +62,8 @@ void left_spmm(
     int64_t ldb,
     T beta,
     T *C,
-    int64_t ldc
+    int64_t ldc,
+    double dense_split_threshold = 0.0
 ) {
     using blas::Layout;
     using blas::Op;
@@ -73,13 +75,13 @@ void left_spmm(
         constexpr bool is_csr = std::is_same_v<SpMat, CSRMatrix<T, sint_t>>;
         if constexpr (is_coo) {
             auto At = RandBLAS::sparse_data::coo::transpose(A);
-            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc);
+            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc, dense_split_threshold);
         } else if constexpr (is_csc) {
             auto At = RandBLAS::sparse_data::conversions::transpose_as_csr(A);
-            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc);
+            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc, dense_split_threshold);
         } else if constexpr (is_csr) {
             auto At = RandBLAS::sparse_data::conversions::transpose_as_csc(A);
-            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc);
+            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, At, co_a, ro_a, B, ldb, beta, C, ldc, dense_split_threshold);
         } else {
             randblas_require(false);
         }
@@ -133,6 +135,18 @@ void left_spmm(
 
     if (alpha == (T) 0)
         return;
+
+    // Handle nearly-dense rows and columns with GEMM, then recurse on the sparse remainder.
+    double threshold = dense_split_threshold;
+    if (threshold > 0.0) {
+        SpMat A_sparse(A.n_rows, A.n_cols);
+        hybrid::DensePanels<T> panels;
+        if (hybrid::split_dense_panels(threshold, layout, A, ro_a, co_a, d, m, panels, A_sparse)) {
+            hybrid::apply_dense_panels(layout, opB, d, n, m, alpha, panels, B, ldb, C, ldc);
+            left_spmm(layout, Op::NoTrans, opB, d, n, m, alpha, A_sparse, ro_a, co_a, B, ldb, (T) 1, C, ldc);
+            return;
+        }
+    }
     
     // compute the matrix-matrix product
     if constexpr (is_coo) {
@@ -175,7 +189,8 @@ inline void right_spmm(
     int64_t j_off,
     T beta,
     T *C,
-    int64_t ldc
+    int64_t ldc,
+    double dense_split_threshold = 0.0
 ) { 
     //
     // Compute C = op(mat(A)) @ op(submat(\mtxB)) by reduction to left_spmm. We start with
@@ -195,7 +210,7 @@ inline void right_spmm(
     auto trans_layout = (layout == Layout::ColMajor) ? Layout::RowMajor : Layout::ColMajor;
     left_spmm(
         trans_layout, trans_opB, opA,
-        d, m, n, alpha, B, i_off, j_off, A, lda, beta, C, ldc
+        d, m, n, alpha, B, i_off, j_off, A, lda, beta, C, ldc, dense_split_threshold
     );
 }
 
@@ -205,7 +220,8 @@ namespace RandBLAS {
 
 // =============================================================================
 /// \fn spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m,
-///     int64_t n, int64_t k, T alpha, SpMat &A, const T *B, int64_t ldb, T beta, T *C, int64_t ldc
+///     int64_t n, int64_t k, T alpha, SpMat &A, const T *B, int64_t ldb, T beta, T *C, int64_t ldc,
+///     const ExecPolicy &exec, double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Perform an SPMM-like operation, multiplying a dense matrix on the left with a sparse matrix:
@@ -275,16 +291,29 @@ namespace RandBLAS {
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(C)` when reading from :math:`C`.
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional).
+///       * If positive, then each row or column of the sparse matrix whose fraction of structural
+///         nonzeros is at least this value is moved into a dense panel, which is applied with GEMM.
+///         The remaining nonzeros are handled by the usual sparse kernels.
+///       * Zero (the default) disables this splitting.
+///
 /// @endverbatim
 template <SparseMatrix SpMat, typename T = SpMat::scalar_t>
-inline void spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m, int64_t n, int64_t k, T alpha, SpMat &A, const T *B, int64_t ldb, T beta, T *C, int64_t ldc) {
-    RandBLAS::sparse_data::left_spmm(layout, opA, opB, m, n, k, alpha, A, 0, 0, B, ldb, beta, C, ldc);
+inline void spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m, int64_t n, int64_t k, T alpha, SpMat &A, const T *B, int64_t ldb, T beta, T *C, int64_t ldc, const ExecPolicy &exec = {}, double dense_split_threshold = 0.0) {
+    exec::ScopedPolicy scoped_policy(exec);
+    RandBLAS::sparse_data::left_spmm(layout, opA, opB, m, n, k, alpha, A, 0, 0, B, ldb, beta, C, ldc, dense_split_threshold);
     return;
 };
 
 // =============================================================================
 /// \fn spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m,
-///     int64_t n, int64_t k, T alpha, const T* A, int64_t lda, SpMat &B, T beta, T *C, int64_t ldc
+///     int64_t n, int64_t k, T alpha, const T* A, int64_t lda, SpMat &B, T beta, T *C, int64_t ldc,
+///     const ExecPolicy &exec, double dense_split_threshold
 /// ) 
 /// @verbatim embed:rst:leading-slashes
 /// Perform an SPMM-like operation, multiplying a dense matrix on the right with a (submatrix of a) sparse matrix:
@@ -353,10 +382,22 @@ inline void spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m, int
 ///       * A nonnegative integer.
 ///       * Leading dimension of :math:`\mat(C)` when reading from :math:`C`.
 ///
+///      exec - [in]
+///       * An ExecPolicy (optional).
+///       * Controls the number of threads in RandBLAS' parallel regions for this call.
+///
+///      dense_split_threshold - [in]
+///       * A real scalar (optional).
+///       * If positive, then each row or column of the sparse matrix whose fraction of structural
+///         nonzeros is at least this value is moved into a dense panel, which is applied with GEMM.
+///         The remaining nonzeros are handled by the usual sparse kernels.
+///       * Zero (the default) disables this splitting.
+///
 /// @endverbatim
 template <SparseMatrix SpMat, typename T = SpMat::scalar_t>
-inline void spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m, int64_t n, int64_t k, T alpha, const T *A, int64_t lda, SpMat &B, T beta, T *C, int64_t ldc) {
-    RandBLAS::sparse_data::right_spmm(layout, opA, opB, m, n, k, alpha, A, lda, B, 0, 0, B, beta, C, ldc);
+inline void spmm(blas::Layout layout, blas::Op opA, blas::Op opB, int64_t m, int64_t n, int64_t k, T alpha, const T *A, int64_t lda, SpMat &B, T beta, T *C, int64_t ldc, const ExecPolicy &exec = {}, double dense_split_threshold = 0.0) {
+    exec::ScopedPolicy scoped_policy(exec);
+    RandBLAS::sparse_data::right_spmm(layout, opA, opB, m, n, k, alpha, A, lda, B, 0, 0, beta, C, ldc, dense_split_threshold);
     return;
 }
 
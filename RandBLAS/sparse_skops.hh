@@ -30,6 +30,7 @@
 
 #include "RandBLAS/config.h"
 #include "RandBLAS/base.hh"
+#include "RandBLAS/parallel.hh"
 #include "RandBLAS/exceptions.hh"
 #include "RandBLAS/random_gen.hh"
 #include "RandBLAS/util.hh"
@@ -40,6 +41,8 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 
 #define MAX(a, b) (((a) < (b)) ? (b) : (a))
@@ -56,26 +59,38 @@ static state_t repeated_fisher_yates(
     int64_t dim_minor,
     sint_t *idxs_major,
     sint_t *idxs_minor,
-    T *vals
+    T *vals,
+    uint64_t *sign_bits = nullptr
 ) {
     bool write_vals = vals != nullptr;
     bool write_idxs_minor = idxs_minor != nullptr;
+    bool write_sign_bits = sign_bits != nullptr;
+    // If requested, bit ell of sign_bits is set when the ell-th nonzero is -1. The
+    // caller must zero-initialize sign_bits. Neighboring minor-axis vectors can share
+    // a word of sign_bits, so we set bits atomically.
     randblas_error_if(vec_nnz > dim_major);
+    using RNG = typename state_t::generator;
+    auto ctr = state.counter;
+    const auto key = state.key;
+    // Each minor-axis vector is sampled from its own range of counters, and
+    // vec_work is restored after each vector. So the loop below can be split
+    // across threads without changing the result.
+    parallel::parallel_for(0, dim_minor, [&](int64_t i_start, int64_t i_stop) {
+    RNG gen;
     std::vector<sint_t> vec_work(dim_major);
     for (sint_t j = 0; j < dim_major; ++j)
         vec_work[j] = j;
     std::vector<sint_t> pivots(vec_nnz);
-    using RNG = typename state_t::generator;
-    RNG gen;
-    auto [ctr, key] = state;
-    for (sint_t i = 0; i < dim_minor; ++i) {
-        sint_t offset = i * vec_nnz;
+    for (int64_t i = i_start; i < i_stop; ++i) {
+        // Positions in idxs_major can exceed the range of sint_t even when the
+        // indices stored there don't, so we compute them in 64-bit arithmetic.
+        int64_t offset = i * vec_nnz;
         auto ctr_work = ctr;
         ctr_work.incr(offset);
-        for (sint_t j = 0; j < vec_nnz; ++j) {
+        for (int64_t j = 0; j < vec_nnz; ++j) {
             // one step of Fisher-Yates shuffling
             auto rv = gen(ctr_work, key);
-            sint_t ell = j + rv[0] % (dim_major - j);
+            sint_t ell = (sint_t) (j + rv[0] % (dim_major - j));
             pivots[j] = ell;
             sint_t swap = vec_work[ell];
             vec_work[ell] = vec_work[j];
@@ -84,6 +99,10 @@ static state_t repeated_fisher_yates(
             idxs_major[j + offset] = (sint_t) swap;
             if (write_vals)
                 vals[j + offset] = (rv[1] % 2 == 0) ? 1.0 : -1.0;
+            if (write_sign_bits && rv[1] % 2 != 0) {
+                int64_t pos = j + offset;
+                std::atomic_ref<uint64_t>(sign_bits[pos / 64]).fetch_or(((uint64_t) 1) << (pos % 64), std::memory_order_relaxed);
+            }
             if (write_idxs_minor)
                 idxs_minor[j + offset] = (sint_t) i;
             // increment counter
@@ -93,14 +112,15 @@ static state_t repeated_fisher_yates(
         //      This isn't necessary from a statistical perspective,
         //      but it makes it easier to generate submatrices of
         //      a given SparseSkOp.
-        for (sint_t j = 1; j <= vec_nnz; ++j) {
-            sint_t jj = vec_nnz - j;
+        for (int64_t j = 1; j <= vec_nnz; ++j) {
+            int64_t jj = vec_nnz - j;
             sint_t swap = idxs_major[jj + offset];
             sint_t ell = pivots[jj];
             vec_work[jj] = vec_work[ell];
             vec_work[ell] = swap;
         }
     }
+    });
     ctr.incr(dim_minor * vec_nnz);
     return state_t {ctr, key};
 }
@@ -192,6 +212,14 @@ struct SparseDist {
     ///  \math{\ttt{full_nnz} = \vecnnz * \ttt{dim_minor}.}
     const int64_t full_nnz;
 
+    // ---------------------------------------------------------------------------
+    ///  Only used when \math{\ttt{major_axis} = \ttt{Long}.} If false (the default),
+    ///  then each nonzero's sign is drawn from its own CBRNG word. If true, then
+    ///  signs are drawn one bit at a time, so a single word supplies 32 or 64 signs.
+    ///  That makes sampling cheaper, but it changes the operator sampled from a
+    ///  given seed.
+    const bool packed_signs;
+
     // ---------------------------------------------------------------------------
     ///  Arguments passed to this function are used to initialize members of the same names.
     ///  The members \math{\ttt{dim_major},} \math{\ttt{dim_minor},} \math{\ttt{isometry_scale},} and \math{\ttt{full_nnz}}
@@ -203,19 +231,24 @@ struct SparseDist {
         int64_t n_rows,
         int64_t n_cols,
         int64_t vec_nnz = 4,
-        Axis major_axis = Axis::Short
+        Axis major_axis = Axis::Short,
+        bool packed_signs = false
     ) : n_rows(n_rows), n_cols(n_cols),
         major_axis(major_axis),
         dim_major((major_axis == Axis::Short) ? std::min(n_rows, n_cols) : std::max(n_rows, n_cols)),
         dim_minor(n_rows + n_cols - dim_major),
         isometry_scale(sparse::isometry_scale(major_axis, vec_nnz, dim_major, dim_minor)),
-        vec_nnz(vec_nnz), full_nnz(vec_nnz * dim_minor) 
+        vec_nnz(vec_nnz), full_nnz(vec_nnz * dim_minor), packed_signs(packed_signs)
     {   // argument validation
         randblas_require(n_rows > 0);
         randblas_require(n_cols > 0);
         randblas_require(vec_nnz > 0);
         randblas_require(vec_nnz <= dim_major);
     }
+
+    // ---------------------------------------------------------------------------
+    ///  Two SparseDists are equal if they describe the same distribution.
+    bool operator==(const SparseDist &) const = default;
 };
 
 #ifdef __cpp_concepts
@@ -250,7 +283,7 @@ RNGState<RNG> compute_next_state(SparseDist dist, RNGState<RNG> state) {
         //   See repeated_fisher_yates.
     } else {
         num_mavec = std::min(dist.n_rows, dist.n_cols);
-        incrs_per_mavec = (int64_t) std::ceil((double) dist.vec_nnz / ((double) state.len_c/2));
+        incrs_per_mavec = incrs_for_iid_uniform<RNG>(dist.vec_nnz, true, dist.packed_signs);
         // ^ LASOs do try to be frugal with CBRNG increments.
         //   See sample_indices_iid_uniform.
     }
@@ -354,6 +387,13 @@ struct SparseSkOp {
     ///  If non-null, this must point to an array of length at least dist.full_nnz.
     sint_t *cols;
 
+    // ---------------------------------------------------------------------------
+    ///  If non-null, then RandBLAS functions that need this operator's data will
+    ///  call fill_sparse on it in place (exactly once, even if this operator is
+    ///  shared by several threads) instead of sampling a temporary copy per call.
+    ///  Set this with enable_lazy_fill.
+    std::shared_ptr<FillOnce> lazy_fill = nullptr;
+
     /////////////////////////////////////////////////////////////////////
     //
     //      Member functions must directly relate to memory management.
@@ -408,7 +448,7 @@ struct SparseSkOp {
     SparseSkOp(SparseSkOp<T,RNG,sint_t> &&S
     ) : dist(S.dist), seed_state(S.seed_state), next_state(S.next_state),
         n_rows(dist.n_rows), n_cols(dist.n_cols), own_memory(S.own_memory),
-        nnz(S.nnz), rows(S.rows), cols(S.cols), vals(S.vals)
+        nnz(S.nnz), vals(S.vals), rows(S.rows), cols(S.cols), lazy_fill(std::move(S.lazy_fill))
     {
         S.rows = nullptr;
         S.cols = nullptr;
@@ -522,7 +562,7 @@ state_t fill_sparse_unpacked_nosub(
         int64_t total_nnz = 0;
         auto state = seed_state;
         for (int64_t i = 0; i < dim_minor; ++i) {
-            state = sample_indices_iid_uniform(dim_major, vec_nnz, idxs_long, vals, state);
+            state = sample_indices_iid_uniform(dim_major, vec_nnz, idxs_long, vals, state, D.packed_signs);
             // ^ That writes directly so S.vals and either S.rows or S.cols.
             //   The new values might need to be changed if there are duplicates in idxs_long.
             //   We have a helper function for this since it's a tedious process.
@@ -561,8 +601,12 @@ state_t fill_sparse_unpacked_nosub(
 ///         RandBLAS::COOMatrix mat(S.n_rows, S.n_cols, S.nnz, S.vals, S.rows, S.cols);
 ///
 /// @endverbatim
+/// The optional ExecPolicy controls the number of threads used for sampling when
+/// \math{\ttt{S.dist.major_axis}} is Short. Sampling for long-axis-major
+/// operators is sequential.
 template <typename SparseSkOp>
-void fill_sparse(SparseSkOp &S) {
+void fill_sparse(SparseSkOp &S, const ExecPolicy &exec = {}) {
+    exec::ScopedPolicy scoped_policy(exec);
     using sint_t = typename SparseSkOp::index_t;
     using T      = typename SparseSkOp::scalar_t;
     int64_t full_nnz = S.dist.full_nnz;
@@ -644,5 +688,44 @@ COOMatrix<T, sint_t> coo_view_of_skop(SparseSkOp &S) {
     return A;
 }
 
+// Copy S.vals into vals, multiplying each nonzero by diag[idx[e] - offset] when that
+// index lies in [0, len). Here idx is S.rows or S.cols. Nonzeros outside that range
+// are copied unchanged.
+template <typename SparseSkOp, typename T, typename sint_t>
+void scaled_skop_vals(const SparseSkOp &S, const sint_t *idx, int64_t offset, int64_t len, const T *diag, T *vals) {
+    for (int64_t e = 0; e < S.nnz; ++e) {
+        int64_t k = (int64_t) idx[e] - offset;
+        vals[e] = (0 <= k && k < len) ? S.vals[e] * diag[k] : S.vals[e];
+    }
+}
+
+// Called by functions that are about to read S's data. If S is in lazy-fill
+// mode then this makes sure S is filled in place.
+template <typename SparseSkOp>
+inline void fill_if_lazy(SparseSkOp &S) {
+    if (S.lazy_fill) {
+        S.lazy_fill->run([&S]() {
+            if (S.nnz < 0)
+                fill_sparse(S);
+        });
+    }
+}
+
+// Call f(S_filled), where S_filled is S if its nonzeros are available and otherwise
+// a temporary copy of S that we sample here. Functions that apply S one panel at a
+// time use this so that an unfilled operator is sampled once rather than per panel.
+template <typename SKOP, typename FUNC>
+inline void with_filled(SKOP &S, FUNC &&f) {
+    if constexpr (requires { S.lazy_fill; })
+        fill_if_lazy(S);
+    if (S.nnz >= 0) {
+        f(S);
+        return;
+    }
+    SKOP shallowcopy(S.dist, S.seed_state);
+    fill_sparse(shallowcopy);
+    f(shallowcopy);
+}
+
 
 } // end namespace RandBLAS::sparse
@@ -44,8 +44,10 @@
 #   include <cxxabi.h>
 #endif
 #include <memory>
+#include <vector>
 #include <string>
 #include <cstdlib>
+#include <cmath>
 
 
 namespace RandBLAS::util {
@@ -146,6 +148,29 @@ void require_symmetric(blas::Layout layout, const T* A, int64_t n, int64_t lda,
     return;
 }
 
+// Overwrite the upper triangle of the column-major k-by-k matrix M with the factor R
+// from a Cholesky decomposition M = R^T R, and zero out the strict lower triangle.
+// Only the upper triangle of M is read. Returns false if M isn't positive definite
+// to working precision.
+template <typename T>
+bool cholesky_upper(int64_t k, T *M, int64_t ldm) {
+    for (int64_t j = 0; j < k; ++j) {
+        T *R_j = M + j * ldm;
+        T r_jj = R_j[j] - blas::dot(j, R_j, 1, R_j, 1);
+        if (!(r_jj > (T) 0))
+            return false;
+        r_jj = std::sqrt(r_jj);
+        R_j[j] = r_jj;
+        for (int64_t i = j + 1; i < k; ++i) {
+            T *R_i = M + i * ldm;
+            R_i[j] = (R_i[j] - blas::dot(j, R_j, 1, R_i, 1)) / r_jj;
+        }
+        for (int64_t i = j + 1; i < k; ++i)
+            R_j[i] = (T) 0.0;
+    }
+    return true;
+}
+
 } // end namespace RandBLAS::util
 
 namespace RandBLAS {
@@ -473,38 +498,161 @@ state_t sample_indices_iid(int64_t n, const T* cdf, int64_t k, sint_t* samples,
     return state_t(ctr, key);
 }
  
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// Checks that all elements of the length-:math:`n` array :math:`w` are no smaller than
+/// :math:`\ttt{error_if_below},` then builds a table for Walker's alias method from the
+/// distribution over :math:`\{0, \ldots, n - 1\}` with probabilities proportional to :math:`\max\{0, w_i\}.`
+/// We use Vose's construction.
+///
+/// On exit, :math:`w` holds the acceptance probabilities and :math:`\ttt{alias}` holds the alias
+/// indices. Together they can be passed to sample_indices_iid_alias, which draws each sample in :math:`O(1)`
+/// time rather than the :math:`O(\log n)` time of sample_indices_iid.
+/// @endverbatim
+template <typename T, SignedInteger sint_t>
+void weights_to_alias(int64_t n, T* w, sint_t* alias, T error_if_below = -sqrt_epsilon<T>()) {
+    // The table is built in double precision. In single precision the sum of the weights, and
+    // the mass that large indices give away one small index at a time, drift noticeably once
+    // n is in the millions.
+    double sum = 0.0;
+    for (int64_t i = 0; i < n; ++i) {
+        randblas_require(w[i] >= error_if_below);
+        sum += (double) std::max(w[i], (T) 0.0);
+    }
+    randblas_require(sum >= std::sqrt((double) n) * (double) std::numeric_limits<T>::epsilon());
+    // Scale so the average weight is one. Indices with weight below one ("small") get topped
+    // up by an index with weight above one ("large"), which becomes the small index's alias.
+    std::vector<double> q(n);
+    std::vector<int64_t> small, large;
+    for (int64_t i = 0; i < n; ++i) {
+        q[i] = ((double) std::max(w[i], (T) 0.0)) * (((double) n) / sum);
+        alias[i] = (sint_t) i;
+        if (q[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        int64_t s = small.back(); small.pop_back();
+        int64_t l = large.back();
+        alias[s] = (sint_t) l;
+        q[l] -= 1.0 - q[s];
+        if (q[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left over has weight one, up to rounding error.
+    for (int64_t i : small)
+        q[i] = 1.0;
+    for (int64_t i : large)
+        q[i] = 1.0;
+    for (int64_t i = 0; i < n; ++i)
+        w[i] = (T) q[i];
+    return;
+}
+
+// =============================================================================
+/// @verbatim embed:rst:leading-slashes
+/// :math:`(\ttt{prob}, \ttt{alias})` is a table for Walker's alias method over :math:`\{0, \ldots, n - 1\},`
+/// as produced by weights_to_alias.
+///
+/// On exit, :math:`\ttt{samples}` is overwritten by :math:`k` independent samples from that distribution.
+/// Each sample uses two random words: one picks an index :math:`i` uniformly, and the other
+/// decides between :math:`i` and :math:`\ttt{alias}[i].`
+/// The returned RNGState should be used for the next call to a random sampling function whose
+/// output should be statistically independent from :math:`\ttt{samples}.`
+/// @endverbatim
+template <typename T, SignedInteger sint_t, typename state_t = RNGState<DefaultRNG>>
+state_t sample_indices_iid_alias(int64_t n, const T* prob, const sint_t* alias, int64_t k, sint_t* samples, const state_t &state) {
+    using RNG = typename state_t::generator;
+    auto [ctr, key] = state;
+    RNG gen;
+    auto words = gen(ctr, key);
+    int64_t len_c = 2 * (((int64_t) state.len_c) / 2);
+    int64_t w_index = 0;
+    auto next_word = [&]() {
+        if (w_index == len_c) {
+            ctr.incr(1);
+            words = gen(ctr, key);
+            w_index = 0;
+        }
+        return words[w_index++];
+    };
+    // Each sample consumes two words: one picks an index i, and the other decides
+    // between i and alias[i]. u01 maps a word into (0, 1].
+    double dN = (double) n;
+    for (int64_t j = 0; j < k; ++j) {
+        int64_t i = std::min((int64_t) (dN * r123::u01<double>(next_word())), n - 1);
+        double coin = r123::u01<double>(next_word());
+        samples[j] = (coin <= (double) prob[i]) ? (sint_t) i : alias[i];
+    }
+    if (0 < w_index) ctr.incr(1);
+    return state_t(ctr, key);
+}
+
 template <typename T, SignedInteger sint_t, bool WriteRademachers = true, typename state_t = RNGState<DefaultRNG>>
-state_t sample_indices_iid_uniform(int64_t n, int64_t k, sint_t* samples, T* rademachers, const state_t &state) {
+state_t sample_indices_iid_uniform(int64_t n, int64_t k, sint_t* samples, T* rademachers, const state_t &state, bool packed_signs = false) {
     using RNG = typename state_t::generator;
+    using word_t = typename RNG::ctr_type::value_type;
+    using F = std::conditional_t<sizeof(word_t) == sizeof(uint32_t), float, double>;
     auto [ctr, key] = state;
     RNG gen;
-    auto rv_array = r123ext::uneg11::generate(gen, ctr, key);
+    auto words = gen(ctr, key);
     int64_t len_c = static_cast<int64_t>(state.len_c);
-    if constexpr (WriteRademachers) {
+    if (WriteRademachers && !packed_signs) {
         len_c = 2*(len_c/2);
         // ^ round down to the nearest multiple of two.
     }
-    int64_t rv_index = 0;
+    int64_t w_index = 0;
+    auto next_word = [&]() {
+        if (w_index == len_c) {
+            ctr.incr(1);
+            words = gen(ctr, key);
+            w_index = 0;
+        }
+        return words[w_index++];
+    };
+    // Each index consumes one word. By default each Rademacher consumes the word
+    // after its index. With packed_signs, Rademachers consume one bit each, so a
+    // single word supplies the signs for the next 32 (or 64) indices.
+    r123ext::bit_stream<RNG> signs{};
     double dN = (double) n;
     for (int64_t i = 0; i < k; ++i) {
-        auto random_unif01 = uneg11_to_u01<double>(rv_array[rv_index]);
+        auto random_unif01 = uneg11_to_u01<double>(r123::uneg11<F>(next_word()));
         sint_t sample_index = (sint_t) dN * random_unif01;
         samples[i] = sample_index;
-        rv_index += 1;
         if constexpr (WriteRademachers) {
-            rademachers[i] = (rv_array[rv_index] >= 0) ? (T) 1 : (T) -1;
-            rv_index += 1;
-        }
-        if (rv_index == len_c) {
-            ctr.incr(1);
-            rv_array = r123ext::uneg11::generate(gen, ctr, key);
-            rv_index = 0;
+            if (!packed_signs) {
+                rademachers[i] = (r123::uneg11<F>(next_word()) >= 0) ? (T) 1 : (T) -1;
+                continue;
+            }
+            if (signs.empty())
+                signs.refill(next_word());
+            rademachers[i] = signs.next() ? (T) 1 : (T) -1;
         }
     }
-    if (0 < rv_index) ctr.incr(1);
+    if (0 < w_index) ctr.incr(1);
     return state_t(ctr, key);
 }
 
+// The number of counter increments used by sample_indices_iid_uniform when it writes
+// k indices (and k Rademachers, if with_rademachers is true).
+template <typename RNG>
+inline int64_t incrs_for_iid_uniform(int64_t k, bool with_rademachers, bool packed_signs = false) {
+    using word_t = typename RNG::ctr_type::value_type;
+    constexpr int64_t len_c = RNG::ctr_type::static_size;
+    constexpr int64_t bits_per_word = 8 * sizeof(word_t);
+    if (with_rademachers && !packed_signs) {
+        int64_t pairs_per_incr = len_c / 2;
+        return (k + pairs_per_incr - 1) / pairs_per_incr;
+    }
+    int64_t num_words = k;
+    if (with_rademachers)
+        num_words += (k + bits_per_word - 1) / bits_per_word;
+    return (num_words + len_c - 1) / len_c;
+}
+
 
 // =============================================================================
 /// @verbatim embed:rst:leading-slashes
@@ -34,7 +34,6 @@
 
 #include <iostream>
 #include <vector>
-#include <typeinfo>
 #include <cstring>
 #include <chrono>
 
@@ -69,13 +68,28 @@ auto run_test(RandBLAS::DenseDist D, T *mat)
 }
 
 
+template <typename T, typename RNG, typename OP>
+void report(const char *rng_name, const char *op_name, RandBLAS::DenseDist D, std::vector<T> &mat)
+{
+    // Warm up once so that page faults on mat aren't charged to the first generator.
+    run_test<T,RNG,OP>(D, mat.data());
+    auto dt = run_test<T,RNG,OP>(D, mat.data());
+    double secs = ((double) dt) * std::chrono::high_resolution_clock::period::num
+        / std::chrono::high_resolution_clock::period::den;
+    double rate = ((double) D.n_rows * D.n_cols) / secs;
+    std::cerr << "[" << rng_name << ", " << op_name << "] dt = " << dt
+        << ", " << rate / 1e6 << " M entries/sec" << std::endl;
+}
+
+
 int main(int argc, char **argv)
 {
-    (void) argc;
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " m n" << std::endl;
+        return 1;
+    }
 
     using T = float;
-    using RNG = r123::Philox4x32;
-    using OP = r123ext::uneg11;
 
     int64_t m = atoi(argv[1]);
     int64_t n = atoi(argv[2]);
@@ -84,14 +98,30 @@ int main(int argc, char **argv)
 
     std::vector<T> mat(d);
 
-    auto dt = run_test<T,RNG,OP>(dist, mat.data());
-
-    std::cerr << "[" << typeid(RNG).name() << ", "
-        << typeid(OP).name() << "] dt = " << dt << std::endl;
+    // Compare the default CBRNG against the cheaper ones that RNGState supports.
+    report<T, r123::Philox4x32,  r123ext::uneg11>("Philox4x32",      "uneg11", dist, mat);
+    report<T, Philox4x32_7,      r123ext::uneg11>("Philox4x32_7",    "uneg11", dist, mat);
+    report<T, r123::Threefry4x32,r123ext::uneg11>("Threefry4x32",    "uneg11", dist, mat);
+    report<T, Threefry4x32_13,   r123ext::uneg11>("Threefry4x32_13", "uneg11", dist, mat);
+#if R123_USE_AES_NI
+    report<T, ARS4x32,           r123ext::uneg11>("ARS4x32",         "uneg11", dist, mat);
+    report<T, ARS4x32_5,         r123ext::uneg11>("ARS4x32_5",       "uneg11", dist, mat);
+#endif
+    report<T, r123::Philox4x32,  r123ext::boxmul>("Philox4x32",      "boxmul", dist, mat);
+    report<T, Philox4x32_7,      r123ext::boxmul>("Philox4x32_7",    "boxmul", dist, mat);
+    report<T, Threefry4x32_13,   r123ext::boxmul>("Threefry4x32_13", "boxmul", dist, mat);
+#if R123_USE_AES_NI
+    report<T, ARS4x32,           r123ext::boxmul>("ARS4x32",         "boxmul", dist, mat);
+#endif
+    report<T, r123::Philox4x32,  r123ext::ziggurat>("Philox4x32",     "ziggurat", dist, mat);
+    report<T, Philox4x32_7,      r123ext::ziggurat>("Philox4x32_7",   "ziggurat", dist, mat);
+    // 64-bit generators can produce two floats per counter element.
+    report<T, r123::Philox4x64,  r123ext::uneg11>      ("Philox4x64", "uneg11",       dist, mat);
+    report<T, r123::Philox4x64,  r123ext::uneg11_split>("Philox4x64", "uneg11_split", dist, mat);
+    report<T, r123::Philox4x64,  r123ext::boxmul_split>("Philox4x64", "boxmul_split", dist, mat);
 
     if (d < 100)
         std::cerr << "mat = " << mat << std::endl;
 
     return 0;
 }
-
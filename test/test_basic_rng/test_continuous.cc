@@ -57,7 +57,7 @@ class TestScalarDistributions : public ::testing::Test {
         std::vector<T> &samples, double critical_value, ScalarDist sd
     ) { 
         auto F_true = [sd](T x) {
-            if (sd == ScalarDist::Gaussian) {
+            if (sd == ScalarDist::Gaussian || sd == ScalarDist::GaussianZiggurat) {
                 return RandBLAS_StatTests::standard_normal_cdf(x);
             } else if (sd == ScalarDist::Uniform) {
                 return RandBLAS_StatTests::uniform_syminterval_cdf(x, (T) std::sqrt(3));
@@ -107,11 +107,11 @@ class TestScalarDistributions : public ::testing::Test {
         return;
     }
 
-    template <typename T>
+    template <typename T, typename RNG = RandBLAS::DefaultRNG>
     static void run(double significance, int64_t num_samples, ScalarDist sd, uint32_t seed) {
         using RandBLAS_StatTests::KolmogorovSmirnovConstants::critical_value_rep_mutator;
         auto critical_value = critical_value_rep_mutator(num_samples, significance);
-        RNGState state(seed);
+        RNGState<RNG> state(seed);
         std::vector<T> samples(num_samples, -1);
         RandBLAS::DenseDist D(num_samples, 1, sd, RandBLAS::Axis::Long);
         RandBLAS::fill_dense(D, samples.data(), state);
@@ -165,3 +165,47 @@ TEST_F(TestScalarDistributions, guassian_ks_skeptical) {
     run<float>(s, 10000,  ScalarDist::Gaussian, 0);
     run<float>(s, 1000,   ScalarDist::Gaussian, 0);
 }
+
+TEST_F(TestScalarDistributions, ziggurat_tables) {
+    const auto &zt = r123ext::ziggurat_tables();
+    // The fast path and the leftover distribution must split the half-normal's mass.
+    EXPECT_NEAR(zt.fast_cdf[1], 1.0 - zt.p_reject, 1e-12);
+    EXPECT_LT(zt.p_reject, 0.03);
+    for (int m = 1; m < zt.layers; ++m) {
+        ASSERT_GE(zt.leftover_cdf[m], zt.leftover_cdf[m+1]) << "m = " << m;
+        ASSERT_GE(zt.x[m], zt.x[m+1]) << "m = " << m;
+    }
+    for (int i = 0; i < zt.knots; ++i) {
+        ASSERT_LT(zt.knot_V[i], zt.knot_V[i+1]) << "i = " << i;
+    }
+    // The leftover inverse CDF is the inverse of leftover_cdf at the layer boundaries.
+    for (int m = 1; m < zt.layers; m += 9) {
+        EXPECT_NEAR(zt.leftover_inverse(zt.leftover_cdf[m]), zt.x[m], 1e-9) << "m = " << m;
+    }
+    EXPECT_GT(zt.leftover_inverse(1.0 - 1e-12), zt.r);
+}
+
+TEST_F(TestScalarDistributions, ziggurat_ks_generous) {
+    double s = 1e-6;
+    for (uint32_t i = 99; i < 103; ++i) {
+        run<double>(s, 100000, ScalarDist::GaussianZiggurat, i);
+        run<double>(s, 10000,  ScalarDist::GaussianZiggurat, i*i);
+        run<double>(s, 1000,   ScalarDist::GaussianZiggurat, i*i*i);
+    }
+}
+
+TEST_F(TestScalarDistributions, ziggurat_ks_moderate) {
+    double s = 1e-4;
+    run<float>(s, 100000, ScalarDist::GaussianZiggurat, 0);
+    run<float>(s, 10000,  ScalarDist::GaussianZiggurat, 0);
+    run<float>(s, 1000,   ScalarDist::GaussianZiggurat, 0);
+    run<double, r123::Philox4x64>(s, 100000, ScalarDist::GaussianZiggurat, 0);
+    run<float,  r123::Philox4x64>(s, 100000, ScalarDist::GaussianZiggurat, 0);
+}
+
+TEST_F(TestScalarDistributions, ziggurat_ks_skeptical) {
+    double s = 1e-2;
+    run<float>(s, 100000, ScalarDist::GaussianZiggurat, 0);
+    run<float>(s, 10000,  ScalarDist::GaussianZiggurat, 0);
+    run<float>(s, 1000,   ScalarDist::GaussianZiggurat, 0);
+}
@@ -36,6 +36,8 @@
 using RandBLAS::RNGState;
 using RandBLAS::weights_to_cdf;
 using RandBLAS::sample_indices_iid;
+using RandBLAS::weights_to_alias;
+using RandBLAS::sample_indices_iid_alias;
 using RandBLAS::sample_indices_iid_uniform;
 using RandBLAS::repeated_fisher_yates;
 #include "rng_common.hh"
@@ -133,6 +135,86 @@ class TestSampleIndices : public ::testing::Test
         return;
     }
 
+    static void test_iid_alias_kolmogorov_smirnov(int64_t N, float exponent, double significance, int64_t num_samples, uint32_t seed) {
+        using RandBLAS_StatTests::KolmogorovSmirnovConstants::critical_value_rep_mutator;
+        auto critical_value = critical_value_rep_mutator(num_samples, significance);
+
+        vector<float> weights{};
+        for (int i = 0; i < N; ++i)
+            weights.push_back(std::pow(1.0/((float)i + 1.0), exponent));
+        vector<float> true_cdf(weights);
+        weights_to_cdf(N, true_cdf.data());
+        vector<int64_t> alias(N);
+        weights_to_alias(N, weights.data(), alias.data());
+
+        RNGState state(seed);
+        vector<int64_t> samples(num_samples, -1);
+        auto next_state = sample_indices_iid_alias(N, weights.data(), alias.data(), num_samples, samples.data(), state);
+        // Two words per sample, as with sample_indices_iid_uniform when it writes Rademachers.
+        using RNG = typename decltype(state)::generator;
+        int64_t incrs = RandBLAS::incrs_for_iid_uniform<RNG>(num_samples, true);
+        ASSERT_EQ(next_state.counter.v[0], state.counter.v[0] + incrs);
+        sample_indices_iid_alias(N, weights.data(), alias.data(), num_samples, samples.data(), state);
+
+        index_set_kolmogorov_smirnov_tester(samples, true_cdf, critical_value);
+        return;
+    }
+
+    static void test_iid_alias_degenerate_distributions(uint32_t seed) {
+        int64_t N = 100;
+        int64_t num_samples = N*N;
+        vector<int64_t> samples(num_samples, -1);
+        vector<int64_t> alias(N);
+        RNGState state(seed);
+
+        // Mass only on even elements != 10.
+        vector<float> weights(N, 0.0);
+        for (int i = 0; i < N; i = i + 2)
+            weights[i] = 1.0f / ((float) i + 1.0f);
+        weights[10] = 0.0;
+        weights_to_alias(N, weights.data(), alias.data());
+        state = sample_indices_iid_alias(N, weights.data(), alias.data(), num_samples, samples.data(), state);
+        for (auto s : samples) {
+            ASSERT_FALSE(s == 10 || s % 2 == 1) << "s = " << s;
+        }
+
+        // A delta function, with a negative weight that's clipped without error.
+        std::fill(weights.begin(), weights.end(), 0.0);
+        weights[17] = 99.0f;
+        weights[3]  = -std::numeric_limits<float>::epsilon()/10;
+        weights_to_alias(N, weights.data(), alias.data());
+        sample_indices_iid_alias(N, weights.data(), alias.data(), num_samples, samples.data(), state);
+        for (auto s : samples) {
+            ASSERT_EQ(s, 17);
+        }
+        return;
+    }
+
+    // Alternating weights 1 and 9 over 2^22 indices. The light indices should get a tenth
+    // of the samples. That needs the accept/reject decision to have many more random bits
+    // than are left over after picking an index, and the table to be built without drift.
+    static void test_iid_alias_many_indices(uint32_t seed) {
+        int64_t N = ((int64_t) 1) << 22;
+        int64_t num_samples = 200000;
+        vector<float> weights(N);
+        for (int64_t i = 0; i < N; ++i)
+            weights[i] = (i % 2 == 0) ? 1.0f : 9.0f;
+        vector<int64_t> alias(N);
+        weights_to_alias(N, weights.data(), alias.data());
+        vector<int64_t> samples(num_samples, -1);
+        RNGState state(seed);
+        sample_indices_iid_alias(N, weights.data(), alias.data(), num_samples, samples.data(), state);
+        int64_t num_light = 0;
+        for (auto s : samples) {
+            ASSERT_TRUE(0 <= s && s < N);
+            num_light += (s % 2 == 0);
+        }
+        // The standard deviation of the light fraction is sqrt(0.09 / num_samples) < 7e-4.
+        double frac_light = ((double) num_light) / ((double) num_samples);
+        EXPECT_NEAR(frac_light, 0.1, 0.005);
+        return;
+    }
+
     static void test_iid_degenerate_distributions(uint32_t seed) {
         int64_t N = 100;
         int64_t num_samples = N*N;
@@ -188,6 +270,47 @@ class TestSampleIndices : public ::testing::Test
         EXPECT_LE( total_2call, total_1call + 1);
     }
 
+    template <typename RNG>
+    static void test_iid_uniform_with_rademachers(int64_t k, bool packed_signs) {
+        RNGState<RNG> seed(7);
+        int64_t n = 1000;
+        vector<int64_t> idxs(k), idxs_nosign(k);
+        vector<double> signs(k, 0.0);
+        auto s1 = RandBLAS::sample_indices_iid_uniform<double, int64_t, true>(n, k, idxs.data(), signs.data(), seed, packed_signs);
+        // The counter increment must match what SparseSkOp's constructor predicts for LASOs.
+        auto expect = seed;
+        expect.counter.incr(RandBLAS::incrs_for_iid_uniform<RNG>(k, true, packed_signs));
+        EXPECT_TRUE(s1 == expect);
+        auto s2 = sample_indices_iid_uniform(n, k, idxs_nosign.data(), seed);
+        expect = seed;
+        expect.counter.incr(RandBLAS::incrs_for_iid_uniform<RNG>(k, false));
+        EXPECT_TRUE(s2 == expect);
+        int64_t bits_per_word = 8 * sizeof(typename RNG::ctr_type::value_type);
+        int64_t len_c = RNG::ctr_type::static_size;
+        if (packed_signs) {
+            // Signs are drawn from bits, so they add at most ceil(k/W) words to the k index words.
+            int64_t sign_words = (k + bits_per_word - 1) / bits_per_word;
+            EXPECT_EQ(RandBLAS::incrs_for_iid_uniform<RNG>(k, true, true), (k + sign_words + len_c - 1) / len_c);
+        } else {
+            // Each (index, sign) pair uses two words.
+            EXPECT_EQ(RandBLAS::incrs_for_iid_uniform<RNG>(k, true), (k + len_c/2 - 1) / (len_c/2));
+        }
+        // The indices are unaffected by whether we also sample signs, up to the
+        // interleaving of sign words into the stream.
+        EXPECT_EQ(idxs[0], idxs_nosign[0]);
+        int64_t num_pos = 0;
+        for (auto v : signs) {
+            ASSERT_TRUE(v == 1.0 || v == -1.0);
+            num_pos += (v > 0);
+        }
+        // 6 standard deviations from the mean.
+        EXPECT_NEAR((double) num_pos, 0.5 * k, 3.0 * std::sqrt((double) k));
+        for (auto i : idxs) {
+            ASSERT_GE(i, 0);
+            ASSERT_LT(i, n);
+        }
+    }
+
     static void test_updated_rngstates_iid() {
         RNGState seed;
         int offset = 8675309;
@@ -334,6 +457,22 @@ TEST_F(TestSampleIndices, rngstate_updates_iid_uniform) {
     test_updated_rngstates_iid_uniform();
 }
 
+TEST_F(TestSampleIndices, iid_uniform_rademachers_one_word_each) {
+    for (int64_t k : {1, 31, 32, 33, 100, 10000}) {
+        test_iid_uniform_with_rademachers<r123::Philox4x32>(k, false);
+        test_iid_uniform_with_rademachers<r123::Philox4x64>(k, false);
+        test_iid_uniform_with_rademachers<r123::Threefry2x64>(k, false);
+    }
+}
+
+TEST_F(TestSampleIndices, iid_uniform_rademachers_from_bits) {
+    for (int64_t k : {1, 31, 32, 33, 100, 10000}) {
+        test_iid_uniform_with_rademachers<r123::Philox4x32>(k, true);
+        test_iid_uniform_with_rademachers<r123::Philox4x64>(k, true);
+        test_iid_uniform_with_rademachers<r123::Threefry2x64>(k, true);
+    }
+}
+
 TEST_F(TestSampleIndices, rngstate_updates_iid) {
     test_updated_rngstates_iid();
 }
@@ -401,6 +540,25 @@ TEST_F(TestSampleIndices, iid_ks_generous) {
     test_iid_kolmogorov_smirnov(1000000,  3, s, 1000,   0);
 }
 
+TEST_F(TestSampleIndices, iid_alias_ks_moderate) {
+    float s = 1e-4;
+    test_iid_alias_kolmogorov_smirnov(100,      1, s, 100000, 0);
+    test_iid_alias_kolmogorov_smirnov(10000,    1, s, 1000,   0);
+    test_iid_alias_kolmogorov_smirnov(1000000,  1, s, 1000,   0);
+    test_iid_alias_kolmogorov_smirnov(100,      3, s, 100000, 0);
+    test_iid_alias_kolmogorov_smirnov(10000,    3, s, 1000,   0);
+}
+
+TEST_F(TestSampleIndices, iid_alias_many_indices) {
+    for (uint32_t i : {0, 1})
+        test_iid_alias_many_indices(i);
+}
+
+TEST_F(TestSampleIndices, support_of_degenerate_distributions_alias) {
+    for (uint32_t i : {0, 1, 2})
+        test_iid_alias_degenerate_distributions(i);
+}
+
 TEST_F(TestSampleIndices, iid_ks_moderate) {
     float s = 1e-4;
     test_iid_kolmogorov_smirnov(100,      1, s, 100000, 0);
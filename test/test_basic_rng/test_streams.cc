@@ -0,0 +1,170 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <RandBLAS/base.hh>
+#include <RandBLAS/dense_skops.hh>
+#include <RandBLAS/rng_streams.hh>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using RandBLAS::RNGState;
+using RandBLAS::RNGStreamAllocator;
+
+
+class TestRNGStreamAllocator : public ::testing::Test {
+    protected:
+
+    template <typename RNG>
+    static std::vector<uint32_t> key_words(const RNGState<RNG> &s) {
+        return std::vector<uint32_t>(s.key.v, s.key.v + s.len_k);
+    }
+};
+
+TEST_F(TestRNGStreamAllocator, keys_are_sequential) {
+    RNGState<> base(17);
+    base.counter[0] = 3;
+    RNGStreamAllocator<> alloc(base);
+    for (uint64_t i = 0; i < 5; ++i) {
+        auto s = alloc.next_key();
+        RNGState<> expect(18 + i);
+        expect.counter[0] = 3;
+        ASSERT_EQ(s, expect);
+    }
+    EXPECT_EQ(alloc.keys_issued(), (uint64_t) 5);
+    EXPECT_EQ(alloc.counters_reserved(), (uint64_t) 0);
+}
+
+TEST_F(TestRNGStreamAllocator, counter_ranges_are_sequential) {
+    RNGState<> base(5);
+    base.counter[0] = UINT32_MAX;
+    RNGStreamAllocator<> alloc(base);
+    auto s0 = alloc.reserve_counters(1);
+    auto s1 = alloc.reserve_counters(10);
+    auto s2 = alloc.reserve_counters(0);
+    EXPECT_EQ(s0, base);
+    auto expect = base;
+    expect.counter.incr(1);
+    EXPECT_EQ(s1, expect);
+    // incrementing must carry into the next counter word.
+    EXPECT_EQ(s1.counter[0], (uint32_t) 0);
+    EXPECT_EQ(s1.counter[1], (uint32_t) 1);
+    expect.counter.incr(10);
+    EXPECT_EQ(s2, expect);
+    EXPECT_EQ(alloc.counters_reserved(), (uint64_t) 11);
+    EXPECT_EQ(alloc.keys_issued(), (uint64_t) 0);
+}
+
+TEST_F(TestRNGStreamAllocator, counter_overflow) {
+    RNGStreamAllocator<> alloc;
+    alloc.reserve_counters(UINT64_MAX - 1);
+    EXPECT_THROW(alloc.reserve_counters(2), RandBLAS::Error);
+    alloc.reserve_counters(1);
+    EXPECT_EQ(alloc.counters_reserved(), UINT64_MAX);
+}
+
+TEST_F(TestRNGStreamAllocator, concurrent_keys_are_distinct) {
+    RNGStreamAllocator<> alloc(RNGState<>(42));
+    const int num_threads = 8;
+    const int per_thread = 500;
+    std::vector<std::vector<RNGState<>>> got(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < per_thread; ++i)
+                got[t].push_back(alloc.next_key());
+        });
+    }
+    for (auto &th : threads)
+        th.join();
+    std::set<std::vector<uint32_t>> keys;
+    for (auto &states : got) {
+        for (auto &s : states) {
+            keys.insert(key_words(s));
+        }
+    }
+    EXPECT_EQ(keys.size(), (size_t) num_threads * per_thread);
+    EXPECT_EQ(keys.count(key_words(alloc.base)), (size_t) 0);
+    EXPECT_EQ(alloc.keys_issued(), (uint64_t) num_threads * per_thread);
+}
+
+TEST_F(TestRNGStreamAllocator, concurrent_counter_ranges_are_disjoint) {
+    RNGStreamAllocator<> alloc(RNGState<>(7));
+    const int num_threads = 8;
+    const int per_thread = 500;
+    // Each entry is (first counter, number of counters), using only counter[0] since
+    // the total reservation stays far below 2^32.
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> got(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                uint64_t n = 1 + (t + i) % 13;
+                auto s = alloc.reserve_counters(n);
+                EXPECT_EQ(s.key, alloc.base.key);
+                got[t].emplace_back(s.counter[0], n);
+            }
+        });
+    }
+    for (auto &th : threads)
+        th.join();
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    uint64_t total = 0;
+    for (auto &r : got) {
+        ranges.insert(ranges.end(), r.begin(), r.end());
+        for (auto &p : r)
+            total += p.second;
+    }
+    std::sort(ranges.begin(), ranges.end());
+    // The ranges must tile [0, total) without gaps or overlaps.
+    uint64_t next = 0;
+    for (auto &p : ranges) {
+        ASSERT_EQ(p.first, next);
+        next += p.second;
+    }
+    EXPECT_EQ(next, total);
+    EXPECT_EQ(alloc.counters_reserved(), total);
+}
+
+TEST_F(TestRNGStreamAllocator, reserved_range_covers_dense_skop) {
+    using RandBLAS::DenseDist;
+    using RandBLAS::DenseSkOp;
+    RNGStreamAllocator<> alloc(RNGState<>(3));
+    DenseDist D(31, 17);
+    // The number of counters a DenseSkOp needs is the offset of its next_state.
+    DenseSkOp<double> probe(D, RNGState<>());
+    uint64_t n = probe.next_state.counter[0];
+    auto s0 = alloc.reserve_counters(n);
+    auto s1 = alloc.reserve_counters(n);
+    DenseSkOp<double> S0(D, s0);
+    EXPECT_EQ(S0.next_state, s1);
+}
@@ -0,0 +1,202 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/compact_skops.hh"
+#include "RandBLAS/skge.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::CompactSparseSkOp;
+using RandBLAS::RNGState;
+using RandBLAS::Axis;
+
+
+class TestCompactSparseSkOp : public ::testing::Test
+{
+    protected:
+
+    // The compact data must describe the same matrix as the COO data of a SparseSkOp.
+    template <typename T, typename idx_t>
+    static void check_same_operator(int64_t n_rows, int64_t n_cols, int64_t vec_nnz, uint32_t key) {
+        SparseDist D(n_rows, n_cols, vec_nnz, Axis::Short);
+        SparseSkOp<T> S(D, RNGState<>(key));
+        RandBLAS::fill_sparse(S);
+        CompactSparseSkOp<T, RandBLAS::DefaultRNG, idx_t> C(D, RNGState<>(key));
+        RandBLAS::fill_sparse(C);
+        ASSERT_EQ(C.nnz, S.nnz);
+        ASSERT_EQ(C.next_state, S.next_state);
+        bool major_is_row = n_rows <= n_cols;
+        for (int64_t ell = 0; ell < S.nnz; ++ell) {
+            int64_t minor = ell / vec_nnz;
+            int64_t row = (major_is_row) ? (int64_t) C.idxs_major[ell] : minor;
+            int64_t col = (major_is_row) ? minor : (int64_t) C.idxs_major[ell];
+            T val = ((C.sign_bits[ell / 64] >> (ell % 64)) & 1) ? (T) -1 : (T) 1;
+            ASSERT_EQ(row, (int64_t) S.rows[ell]);
+            ASSERT_EQ(col, (int64_t) S.cols[ell]);
+            ASSERT_EQ(val, S.vals[ell]);
+        }
+    }
+
+    // Compare sketch_general with a CompactSparseSkOp against sketch_general with the
+    // equivalent SparseSkOp, from both sides.
+    template <typename T>
+    static void check_sketch(
+        SparseDist D, uint32_t key, blas::Layout layout, blas::Op opS, blas::Op opA,
+        int64_t d, int64_t len, int64_t ro_s, int64_t co_s, bool fill
+    ) {
+        SparseSkOp<T> S(D, RNGState<>(key));
+        CompactSparseSkOp<T> C(D, RNGState<>(key));
+        if (fill)
+            RandBLAS::fill_sparse(C);
+        int64_t n = 13;
+        T tol = 50 * std::numeric_limits<T>::epsilon() * D.vec_nnz;
+
+        // Left: op(submat(S)) is d-by-len, op(A) is len-by-n.
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(len, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A + 1 : cols_A + 1;
+        std::vector<T> A(lda * std::max(rows_A, cols_A));
+        for (size_t i = 0; i < A.size(); ++i)
+            A[i] = (T) ((i * 13 + 5) % 23) / (T) 7 - (T) 1;
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? d : n;
+        std::vector<T> B_actual(d * n, (T) 1), B_expect(d * n, (T) 1);
+        RandBLAS::sketch_general(layout, opS, opA, d, n, len, (T) 1.5, C, ro_s, co_s, A.data(), lda, (T) 0.5, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opS, opA, d, n, len, (T) 1.5, S, ro_s, co_s, A.data(), lda, (T) 0.5, B_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+
+        // Right: op(A) is n-by-len, op(submat(S^T)) is len-by-d.
+        blas::Op opS_right = (opS == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+        auto [rows_A2, cols_A2] = RandBLAS::dims_before_op(n, len, opA);
+        lda = (layout == blas::Layout::ColMajor) ? rows_A2 : cols_A2;
+        ldb = (layout == blas::Layout::ColMajor) ? n : d;
+        std::vector<T> C_actual(n * d, (T) 0), C_expect(n * d, (T) 0);
+        RandBLAS::sketch_general(layout, opA, opS_right, n, d, len, (T) -1.0, A.data(), lda, C, ro_s, co_s, (T) 0.0, C_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opA, opS_right, n, d, len, (T) -1.0, A.data(), lda, S, ro_s, co_s, (T) 0.0, C_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), n * d,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+};
+
+TEST_F(TestCompactSparseSkOp, matches_sparse_skop_wide) {
+    check_same_operator<double, int32_t>(10, 300, 3, 0);
+    check_same_operator<float, int64_t>(10, 300, 10, 1);
+}
+
+TEST_F(TestCompactSparseSkOp, matches_sparse_skop_tall) {
+    check_same_operator<double, int32_t>(257, 9, 2, 2);
+    check_same_operator<float, int16_t>(1000, 40, 8, 3);
+}
+
+TEST_F(TestCompactSparseSkOp, more_nonzeros_than_index_type_range) {
+    // full_nnz = 40000 exceeds INT16_MAX, but every major-axis index fits in int16_t.
+    check_same_operator<double, int16_t>(100, 5000, 8, 4);
+    check_same_operator<double, int16_t>(5000, 100, 8, 5);
+}
+
+TEST_F(TestCompactSparseSkOp, memory_footprint) {
+    SparseDist D(64, 100000, 8, Axis::Short);
+    CompactSparseSkOp<double> C(D, RNGState<>(0));
+    RandBLAS::fill_sparse(C);
+    int64_t compact_bytes = D.full_nnz * (int64_t) sizeof(int32_t) + C.num_sign_words() * (int64_t) sizeof(uint64_t);
+    int64_t coo_bytes = D.full_nnz * (int64_t) (2 * sizeof(int64_t) + sizeof(double));
+    EXPECT_GT(coo_bytes, 5 * compact_bytes);
+}
+
+TEST_F(TestCompactSparseSkOp, sketch_full_operator) {
+    SparseDist D(8, 60, 3, Axis::Short);
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+            check_sketch<double>(D, 4, layout, blas::Op::NoTrans, opA, 8, 60, 0, 0, true);
+            check_sketch<float>(D, 5, layout, blas::Op::NoTrans, opA, 8, 60, 0, 0, false);
+        }
+    }
+    SparseDist D_tall(70, 6, 4, Axis::Short);
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        check_sketch<double>(D_tall, 6, layout, blas::Op::Trans, blas::Op::NoTrans, 6, 70, 0, 0, true);
+        check_sketch<double>(D_tall, 6, layout, blas::Op::Trans, blas::Op::Trans, 6, 70, 0, 0, true);
+    }
+}
+
+TEST_F(TestCompactSparseSkOp, sketch_without_offsets) {
+    // The overloads of sketch_general without (ro_s, co_s) forward to the compact kernels.
+    SparseDist D(5, 40, 2, Axis::Short);
+    SparseSkOp<double> S(D, RNGState<>(9));
+    CompactSparseSkOp<double> C(D, RNGState<>(9));
+    std::vector<double> A(40 * 3);
+    for (size_t i = 0; i < A.size(); ++i)
+        A[i] = (double) i / 10.0;
+    std::vector<double> B_actual(5 * 3, 0.0), B_expect(5 * 3, 0.0);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 5, 3, 40, 1.0, C, A.data(), 40, 0.0, B_actual.data(), 5);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 5, 3, 40, 1.0, S, A.data(), 40, 0.0, B_expect.data(), 5);
+    test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), 15,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-12, 1e-12
+    );
+    EXPECT_EQ(C.idxs_major, nullptr);
+}
+
+TEST_F(TestCompactSparseSkOp, sketch_submatrix) {
+    SparseDist D(12, 80, 4, Axis::Short);
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+            // op(submat(S)) = S[2:9, 5:55].
+            check_sketch<double>(D, 7, layout, blas::Op::NoTrans, opA, 7, 50, 2, 5, true);
+            // op(submat(S)) = S[3:12, 10:41]^T.
+            check_sketch<double>(D, 8, layout, blas::Op::Trans, opA, 31, 9, 3, 10, true);
+        }
+    }
+}
+
+TEST_F(TestCompactSparseSkOp, sketch_unrolled_vec_nnz) {
+    // vec_nnz in {1, 2, 4, 8} uses a compile-time trip count; 5 uses the generic loop.
+    for (int64_t vec_nnz : {1, 2, 4, 5, 8}) {
+        SparseDist D(16, 90, vec_nnz, Axis::Short);
+        for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+            check_sketch<double>(D, 11, layout, blas::Op::NoTrans, blas::Op::NoTrans, 16, 90, 0, 0, true);
+            check_sketch<float>(D, 12, layout, blas::Op::Trans, blas::Op::NoTrans, 40, 10, 3, 20, true);
+        }
+    }
+}
+
+TEST_F(TestCompactSparseSkOp, rejects_long_axis_major) {
+    EXPECT_THROW(
+        (CompactSparseSkOp<double>(SparseDist(10, 100, 2, Axis::Long), RNGState<>(0))),
+        RandBLAS::Error
+    );
+}
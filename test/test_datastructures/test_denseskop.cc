@@ -32,6 +32,7 @@
 #include "RandBLAS/random_gen.hh"
 #include "RandBLAS/dense_skops.hh"
 #include "RandBLAS/util.hh"
+#include "RandBLAS/async.hh"
 #include "test/comparison.hh"
 
 #include <gtest/gtest.h>
@@ -101,7 +102,7 @@ class TestDenseMoments : public ::testing::Test {
 
     virtual void TearDown(){};
 
-    template <typename T>
+    template <typename T, typename RNG = RandBLAS::DefaultRNG>
     static void test_mean_stddev(
         uint32_t key,
         int64_t n_rows,
@@ -115,7 +116,7 @@ class TestDenseMoments : public ::testing::Test {
 
         // Construct the sketching operator
         RandBLAS::DenseDist D(n_rows, n_cols, sd);
-        auto state = RandBLAS::RNGState(key);
+        RandBLAS::RNGState<RNG> state(key);
         auto next_state = RandBLAS::fill_dense(D, A.data(), state);
 
         // Compute the entrywise empirical mean and standard deviation.
@@ -158,6 +159,31 @@ TEST_F(TestDenseMoments, Uniform)
     }
 }
 
+TEST_F(TestDenseMoments, GaussianZiggurat)
+{
+    auto sd = RandBLAS::ScalarDist::GaussianZiggurat;
+    for (uint32_t key : {0, 1, 2})
+    {
+        test_mean_stddev<float>(key, 500, 500, sd, 1.0);
+        test_mean_stddev<double>(key, 203, 203, sd, 1.0);
+        test_mean_stddev<double, r123::Philox4x64>(key, 203, 503, sd, 1.0);
+    }
+}
+
+// Cheaper CBRNGs should be drop-in replacements for the default.
+TEST_F(TestDenseMoments, faster_generators)
+{
+    for (auto sd : {RandBLAS::ScalarDist::Gaussian, RandBLAS::ScalarDist::Uniform})
+    {
+        test_mean_stddev<double, RandBLAS::Philox4x32_7>(0, 203, 503, sd, 1.0);
+        test_mean_stddev<double, RandBLAS::Threefry4x32_13>(0, 203, 503, sd, 1.0);
+        test_mean_stddev<double, r123::Philox2x64>(0, 203, 503, sd, 1.0);
+        #if R123_USE_AES_NI
+        test_mean_stddev<double, RandBLAS::ARS4x32>(0, 203, 503, sd, 1.0);
+        test_mean_stddev<float,  RandBLAS::ARS4x32_5>(1, 500, 500, sd, 1.0f);
+        #endif
+    }
+}
 
 class TestSubmatGeneration : public ::testing::Test
 {
@@ -295,6 +321,43 @@ TEST_F(TestSubmatGeneration, diag)
     }
 }
 
+TEST_F(TestSubmatGeneration, ziggurat)
+{
+    int64_t n_rows = 100;
+    int64_t n_cols = 2000;
+    int64_t n_srows = 41;
+    int64_t n_scols = 97;
+    int64_t ptr = n_rows + 2;
+    for (int k = 0; k < 3; k++) {
+        RandBLAS::RNGState<r123::Philox4x32> seed(k);
+        test_colwise_smat_gen<double, r123::Philox4x32, r123ext::ziggurat>(n_cols, n_rows, n_scols, n_srows, ptr, seed);
+        test_rowwise_smat_gen<float, r123::Philox4x32, r123ext::ziggurat>(n_cols, n_rows, n_scols, n_srows, ptr, seed);
+        test_diag_smat_gen<double, r123::Philox4x32, r123ext::ziggurat>(n_cols, n_rows, seed);
+    }
+}
+
+TEST_F(TestSubmatGeneration, faster_generators)
+{
+    int64_t n_rows = 100;
+    int64_t n_cols = 2000;
+    int64_t n_srows = 41;
+    int64_t n_scols = 97;
+    int64_t ptr = n_rows + 2;
+    using RandBLAS::Philox4x32_7;
+    using RandBLAS::Threefry4x32_13;
+    RandBLAS::RNGState<Philox4x32_7> s1(1);
+    test_colwise_smat_gen<double, Philox4x32_7, r123ext::boxmul>(n_cols, n_rows, n_scols, n_srows, ptr, s1);
+    test_rowwise_smat_gen<float, Philox4x32_7, r123ext::uneg11>(n_cols, n_rows, n_scols, n_srows, ptr, s1);
+    RandBLAS::RNGState<Threefry4x32_13> s2(2);
+    test_colwise_smat_gen<float, Threefry4x32_13, r123ext::uneg11>(n_cols, n_rows, n_scols, n_srows, ptr, s2);
+    test_rowwise_smat_gen<double, Threefry4x32_13, r123ext::boxmul>(n_cols, n_rows, n_scols, n_srows, ptr, s2);
+    #if R123_USE_AES_NI
+    RandBLAS::RNGState<RandBLAS::ARS4x32> s3(3);
+    test_colwise_smat_gen<double, RandBLAS::ARS4x32, r123ext::boxmul>(n_cols, n_rows, n_scols, n_srows, ptr, s3);
+    test_diag_smat_gen<float, RandBLAS::ARS4x32, r123ext::uneg11>(n_cols, n_rows, s3);
+    #endif
+}
+
 
 #if defined(RandBLAS_HAS_OpenMP)
 template <typename T, typename RNG, typename OP>
@@ -341,6 +404,260 @@ TEST(TestDenseThreading, GaussianPhilox) {
 #endif
 
 
+class TestExecPolicy : public ::testing::Test
+{
+    protected:
+
+    template <typename T>
+    static void test_fill_dense_invariant(int64_t m, int64_t n, RandBLAS::ScalarDist family) {
+        RandBLAS::DenseDist D(m, n, family);
+        RandBLAS::RNGState state(17);
+        std::vector<T> base(m * n);
+        auto base_next = RandBLAS::fill_dense(D, base.data(), state);
+
+        std::vector<RandBLAS::ExecPolicy> policies = {{1}, {3}, {8}, {4, true}};
+        for (auto &policy : policies) {
+            std::vector<T> test(m * n, (T) 0.0);
+            auto test_next = RandBLAS::fill_dense(D, test.data(), state, policy);
+            ASSERT_EQ(base_next, test_next);
+            for (int64_t i = 0; i < m * n; ++i)
+                ASSERT_EQ(base[i], test[i]);
+        }
+        // The policy only applies for the duration of the call.
+        EXPECT_TRUE(RandBLAS::exec::current_policy().inherits());
+    }
+};
+
+TEST_F(TestExecPolicy, fill_dense_gaussian) {
+    test_fill_dense_invariant<float>(33, 9, RandBLAS::ScalarDist::Gaussian);
+    test_fill_dense_invariant<double>(7, 50, RandBLAS::ScalarDist::Gaussian);
+}
+
+TEST_F(TestExecPolicy, fill_dense_uniform) {
+    test_fill_dense_invariant<float>(33, 9, RandBLAS::ScalarDist::Uniform);
+    test_fill_dense_invariant<double>(7, 50, RandBLAS::ScalarDist::Uniform);
+}
+
+TEST_F(TestExecPolicy, scoped_policies_nest) {
+    using RandBLAS::ExecPolicy;
+    using RandBLAS::exec::ScopedPolicy;
+    int outside = RandBLAS::exec::num_threads();
+    {
+        ScopedPolicy outer(ExecPolicy{3});
+        #if defined(RandBLAS_HAS_OpenMP)
+        EXPECT_EQ(RandBLAS::exec::num_threads(), 3);
+        #endif
+        {
+            ScopedPolicy inherit(ExecPolicy{});
+            #if defined(RandBLAS_HAS_OpenMP)
+            EXPECT_EQ(RandBLAS::exec::num_threads(), 3);
+            #endif
+        }
+        {
+            ScopedPolicy serial(ExecPolicy{2, true});
+            EXPECT_EQ(RandBLAS::exec::num_threads(), 1);
+        }
+        #if defined(RandBLAS_HAS_OpenMP)
+        EXPECT_EQ(RandBLAS::exec::num_threads(), 3);
+        #endif
+    }
+    EXPECT_EQ(RandBLAS::exec::num_threads(), outside);
+}
+
+
+class TestAsync : public ::testing::Test
+{
+    protected:
+
+    template <typename T>
+    static void test_fill_dense_async(int64_t m, int64_t n) {
+        RandBLAS::DenseDist D(m, n);
+        RandBLAS::RNGState state(5);
+        std::vector<T> expect(m * n);
+        auto expect_next = RandBLAS::fill_dense(D, expect.data(), state);
+
+        std::vector<T> actual(m * n, (T) 0.0);
+        auto fut = RandBLAS::fill_dense_async(D, actual.data(), state, {2});
+        ASSERT_EQ(fut.get(), expect_next);
+        for (int64_t i = 0; i < m * n; ++i)
+            ASSERT_EQ(expect[i], actual[i]);
+
+        RandBLAS::DenseSkOp<T> S(D, state);
+        RandBLAS::fill_dense_async(S).get();
+        for (int64_t i = 0; i < m * n; ++i)
+            ASSERT_EQ(expect[i], S.buff[i]);
+    }
+
+    template <typename T>
+    static void test_sketch_general_async(int64_t d, int64_t m, int64_t n) {
+        RandBLAS::DenseDist D(d, m);
+        RandBLAS::DenseSkOp<T> S(D, 11);
+        RandBLAS::fill_dense(S);
+        std::vector<T> A(m * n);
+        RandBLAS::RNGState state(3);
+        RandBLAS::fill_dense(RandBLAS::DenseDist(m, n), A.data(), state);
+
+        auto layout = blas::Layout::ColMajor;
+        auto NoTrans = blas::Op::NoTrans;
+        std::vector<T> expect(d * n);
+        RandBLAS::sketch_general(layout, NoTrans, NoTrans, d, n, m, (T) 1.0, S, 0, 0, A.data(), m, (T) 0.0, expect.data(), d);
+
+        // Queue two sketches back-to-back; the default pool runs them in order.
+        std::vector<T> left(d * n);
+        std::vector<T> right(n * d);
+        auto f1 = RandBLAS::sketch_general_async(layout, NoTrans, NoTrans, d, n, m, (T) 1.0, S, 0, 0, A.data(), m, (T) 0.0, left.data(), d);
+        auto f2 = RandBLAS::sketch_general_async(layout, blas::Op::Trans, blas::Op::Trans, n, d, m, (T) 1.0, A.data(), m, S, 0, 0, (T) 0.0, right.data(), n);
+        f1.get();
+        f2.get();
+        // The right-sketch runs a different GEMM, so it can differ from the left-sketch by rounding.
+        T atol = 100 * std::numeric_limits<T>::epsilon();
+        T rtol = atol;
+        test::comparison::matrices_approx_equal(
+            layout, NoTrans, d, n, expect.data(), d, left.data(), d,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__
+        );
+        test::comparison::matrices_approx_equal(
+            layout, blas::Op::Trans, d, n, expect.data(), d, right.data(), n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, atol, rtol
+        );
+    }
+};
+
+TEST_F(TestAsync, fill_dense_matches_sync) {
+    test_fill_dense_async<float>(13, 40);
+    test_fill_dense_async<double>(40, 13);
+}
+
+TEST_F(TestAsync, sketch_general_matches_sync) {
+    test_sketch_general_async<float>(5, 30, 7);
+    test_sketch_general_async<double>(5, 30, 7);
+}
+
+TEST_F(TestAsync, exceptions_reach_the_future) {
+    RandBLAS::DenseDist D(4, 4);
+    RandBLAS::DenseSkOp<double> S(D, 0);
+    // S won't own its memory and has no buffer, so fill_dense must fail.
+    S.own_memory = false;
+    auto fut = RandBLAS::fill_dense_async(S);
+    EXPECT_THROW(fut.get(), RandBLAS::Error);
+}
+
+TEST_F(TestAsync, private_pool) {
+    RandBLAS::async::ThreadPool pool(2);
+    EXPECT_EQ(pool.num_workers(), 2);
+    RandBLAS::DenseDist D(10, 10);
+    std::vector<float> a(100), b(100);
+    RandBLAS::RNGState state(1);
+    auto fa = RandBLAS::fill_dense_async(D, a.data(), state, {}, pool);
+    auto fb = RandBLAS::fill_dense_async(D, b.data(), state, {}, pool);
+    fa.get();
+    fb.get();
+    for (int i = 0; i < 100; ++i)
+        ASSERT_EQ(a[i], b[i]);
+}
+
+
+class TestTileCache : public ::testing::Test
+{
+    protected:
+
+    template <typename T>
+    static void test_submatrices_match(int64_t m, int64_t n, RandBLAS::Axis major_axis, int64_t tr, int64_t tc) {
+        RandBLAS::DenseDist D(m, n, RandBLAS::ScalarDist::Gaussian, major_axis);
+        RandBLAS::RNGState seed(21);
+        RandBLAS::DenseSkOp<T> full(D, seed);
+        RandBLAS::fill_dense(full);
+        RandBLAS::DenseTileCache<T> cache(D, seed, tr, tc, 1 << 24);
+        auto [irs, ics] = RandBLAS::layout_to_strides(D.natural_layout, m, n);
+
+        std::vector<std::tuple<int64_t,int64_t,int64_t,int64_t>> boxes = {
+            {m, n, 0, 0}, {1, 1, m - 1, n - 1}, {m / 2, n / 3, m / 4, n / 5}, {m - 3, 2, 3, n - 2}
+        };
+        for (auto [r, c, ro_s, co_s] : boxes) {
+            std::vector<T> sub(r * c, (T) 0.0);
+            cache.copy_submatrix(r, c, ro_s, co_s, sub.data());
+            auto [sub_irs, sub_ics] = RandBLAS::layout_to_strides(D.natural_layout, r, c);
+            for (int64_t i = 0; i < r; ++i) {
+                for (int64_t j = 0; j < c; ++j) {
+                    ASSERT_EQ(sub[i * sub_irs + j * sub_ics], full.buff[(i + ro_s) * irs + (j + co_s) * ics]);
+                }
+            }
+        }
+        // The whole operator was requested once, so every tile is cached and nothing was regenerated.
+        int64_t num_tiles = ((m + tr - 1) / tr) * ((n + tc - 1) / tc);
+        EXPECT_EQ(cache.tiles_generated(), num_tiles);
+        EXPECT_EQ(cache.bytes_in_use(), m * n * (int64_t) sizeof(T));
+    }
+};
+
+TEST_F(TestTileCache, submatrices_match_fill_dense_wide) {
+    test_submatrices_match<float>(12, 57, RandBLAS::Axis::Long, 5, 8);
+    test_submatrices_match<double>(12, 57, RandBLAS::Axis::Short, 7, 16);
+}
+
+TEST_F(TestTileCache, submatrices_match_fill_dense_tall) {
+    test_submatrices_match<float>(57, 12, RandBLAS::Axis::Long, 8, 5);
+    test_submatrices_match<double>(57, 12, RandBLAS::Axis::Short, 100, 3);
+}
+
+TEST_F(TestTileCache, capacity_bounds_memory) {
+    RandBLAS::DenseDist D(40, 40);
+    RandBLAS::DenseTileCache<double> cache(D, RandBLAS::RNGState(0), 10, 10, 2 * 100 * sizeof(double));
+    std::vector<double> sub(40 * 40);
+    cache.copy_submatrix(40, 40, 0, 0, sub.data());
+    EXPECT_EQ(cache.tiles_generated(), 16);
+    EXPECT_LE(cache.bytes_in_use(), cache.capacity_bytes);
+    // The two most recent tiles are still cached ...
+    cache.copy_submatrix(10, 10, 30, 30, sub.data());
+    EXPECT_EQ(cache.tiles_generated(), 16);
+    // ... but the first one was evicted.
+    cache.copy_submatrix(10, 10, 0, 0, sub.data());
+    EXPECT_EQ(cache.tiles_generated(), 17);
+}
+
+TEST_F(TestTileCache, concurrent_requests_generate_once) {
+    RandBLAS::DenseDist D(64, 64);
+    RandBLAS::DenseTileCache<double> cache(D, RandBLAS::RNGState(3), 16, 16, 1 << 20);
+    int num_threads = 8;
+    std::vector<std::vector<double>> subs(num_threads, std::vector<double>(64 * 64));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < num_threads; ++t)
+        workers.emplace_back([&cache, &subs, t]() { cache.copy_submatrix(64, 64, 0, 0, subs[t].data()); });
+    for (auto &w : workers)
+        w.join();
+    // Threads that race on a tile wait for the one generating it.
+    EXPECT_EQ(cache.tiles_generated(), 16);
+    for (int t = 1; t < num_threads; ++t)
+        ASSERT_EQ(subs[t], subs[0]);
+}
+
+TEST_F(TestTileCache, sketch_general_uses_tiles) {
+    int64_t d = 20, m = 100, n = 6;
+    RandBLAS::DenseDist D(d, m);
+    RandBLAS::DenseSkOp<double> full(D, 4);
+    RandBLAS::fill_dense(full);
+    RandBLAS::DenseSkOp<double> lazy(D, 4);
+    RandBLAS::attach_tile_cache(lazy, 8, 32, 1 << 20);
+
+    std::vector<double> A(m * n);
+    RandBLAS::RNGState state(9);
+    RandBLAS::fill_dense(RandBLAS::DenseDist(m, n), A.data(), state);
+    auto layout = blas::Layout::ColMajor;
+    auto NoTrans = blas::Op::NoTrans;
+    // Sweep over blocks of columns of S, as a block algorithm would.
+    for (int sweep = 0; sweep < 2; ++sweep) {
+        for (int64_t co_s = 0; co_s < m; co_s += 25) {
+            std::vector<double> expect(d * n), actual(d * n);
+            RandBLAS::sketch_general(layout, NoTrans, NoTrans, d, n, 25, 1.0, full, 0, co_s, A.data() + co_s, m, 0.0, expect.data(), d);
+            RandBLAS::sketch_general(layout, NoTrans, NoTrans, d, n, 25, 1.0, lazy, 0, co_s, A.data() + co_s, m, 0.0, actual.data(), d);
+            for (int64_t i = 0; i < d * n; ++i)
+                ASSERT_EQ(expect[i], actual[i]);
+        }
+    }
+    EXPECT_EQ(lazy.buff, nullptr);
+    EXPECT_EQ(lazy.tiles->tiles_generated(), 3 * 4);
+}
+
 class TestFillAxis : public::testing::Test
 {
     protected:
@@ -444,17 +761,18 @@ class TestDenseSkOpStates : public ::testing::Test
         uint32_t key,
         int64_t n_rows,
         int64_t n_cols,
-        RandBLAS::ScalarDist sd
+        RandBLAS::ScalarDist sd,
+        bool split_words = false
     ) {
         float *buff = new float[n_rows*n_cols];
-        RandBLAS::RNGState state(key);
+        RandBLAS::RNGState<RNG> state(key);
 
-        RandBLAS::DenseDist D(n_rows, n_cols, sd);
+        RandBLAS::DenseDist D(n_rows, n_cols, sd, RandBLAS::Axis::Long, split_words);
 
         auto actual_final_state = RandBLAS::fill_dense(D, buff, state);
         auto actual_c = actual_final_state.counter;
 
-        auto expect_final_state = RandBLAS::dense::compute_next_state(D, state);
+        auto expect_final_state = RandBLAS::dense::compute_next_state<float>(D, state);
         auto expect_c = expect_final_state.counter;
 
         for (int i = 0; i < RNG::ctr_type::static_size; i++) {
@@ -485,5 +803,81 @@ TEST_F(TestDenseSkOpStates, compare_skopless_fill_dense_to_compute_next_state) {
         test_compute_next_state<r123::Philox4x32>(key, 131, 71, sd);
         test_compute_next_state<r123::Philox4x32>(key, 80, 40, sd);
         test_compute_next_state<r123::Philox4x32>(key, 91, 43, sd);
+        test_compute_next_state<r123::Philox4x64>(key, 13, 7, sd);
+        test_compute_next_state<r123::Philox4x64>(key, 91, 43, sd);
+        test_compute_next_state<r123::Threefry2x64>(key, 11, 5, sd);
+        // With split_words, 64-bit generators split each word into two floats.
+        test_compute_next_state<r123::Philox4x64>(key, 13, 7, sd, true);
+        test_compute_next_state<r123::Philox4x64>(key, 91, 43, sd, true);
+        test_compute_next_state<r123::Threefry2x64>(key, 11, 5, sd, true);
+        sd = RandBLAS::ScalarDist::GaussianZiggurat;
+        test_compute_next_state<r123::Philox4x32>(key, 91, 43, sd);
+        test_compute_next_state<r123::Philox4x64>(key, 91, 43, sd);
+        test_compute_next_state<r123::Philox4x64>(key, 91, 43, sd, true);
+    }
+}
+
+TEST_F(TestDenseSkOpStates, split_words_for_float_from_64bit_generators) {
+    using RNG = r123::Philox4x64;
+    RandBLAS::RNGState<RNG> state(3);
+    RandBLAS::DenseDist D(5, 9, RandBLAS::ScalarDist::Uniform, RandBLAS::Axis::Short, true);
+    // ^ natural layout is column-major with columns of length 5 (one counter each).
+    std::vector<float> A(D.n_rows * D.n_cols);
+    RandBLAS::fill_dense(D, A.data(), state);
+    RNG gen;
+    auto ctr = state.counter;
+    for (int64_t j = 0; j < D.n_cols; ++j) {
+        auto words = gen(ctr, state.key);
+        for (int64_t i = 0; i < D.n_rows; ++i) {
+            uint32_t half = (uint32_t) (words[i / 2] >> (32 * (i % 2)));
+            float expect = r123::uneg11<float>(half) * std::sqrt(3.0f);
+            ASSERT_EQ(A[i + j * D.n_rows], expect) << "(i, j) = (" << i << ", " << j << ")";
+        }
+        ctr.incr();
+    }
+    // Submatrices and DenseSkOps see the same values.
+    std::vector<float> B(3 * 4);
+    RandBLAS::fill_dense_unpacked(blas::Layout::ColMajor, D, 3, 4, 2, 5, B.data(), state);
+    for (int64_t j = 0; j < 4; ++j) {
+        for (int64_t i = 0; i < 3; ++i)
+            ASSERT_EQ(B[i + 3*j], A[(i + 2) + (j + 5) * D.n_rows]);
+    }
+    RandBLAS::DenseSkOp<float, RNG> S(D, state);
+    auto next = RandBLAS::fill_dense(D, A.data(), state);
+    EXPECT_TRUE(S.next_state == next);
+}
+
+TEST_F(TestDenseSkOpStates, no_split_words_by_default) {
+    // Without split_words, a float sample from a 64-bit generator uses one counter
+    // element per entry, as in earlier versions of RandBLAS.
+    using RNG = r123::Philox4x64;
+    RandBLAS::RNGState<RNG> state(3);
+    RNG gen;
+    for (auto sd : {RandBLAS::ScalarDist::Uniform, RandBLAS::ScalarDist::Gaussian}) {
+        RandBLAS::DenseDist D(4, 9, sd, RandBLAS::Axis::Short);
+        // ^ natural layout is column-major with columns of length 4 (one counter each).
+        std::vector<float> A(D.n_rows * D.n_cols);
+        auto next = RandBLAS::fill_dense(D, A.data(), state);
+        auto ctr = state.counter;
+        for (int64_t j = 0; j < D.n_cols; ++j) {
+            if (sd == RandBLAS::ScalarDist::Uniform) {
+                auto vals = r123ext::uneg11::generate(gen, ctr, state.key);
+                for (int64_t i = 0; i < D.n_rows; ++i)
+                    ASSERT_EQ(A[i + j * D.n_rows], ((float) vals[i]) * (float) std::sqrt(3)) << "(i, j) = (" << i << ", " << j << ")";
+            } else {
+                auto vals = r123ext::boxmul::generate(gen, ctr, state.key);
+                for (int64_t i = 0; i < D.n_rows; ++i)
+                    ASSERT_EQ(A[i + j * D.n_rows], (float) vals[i]) << "(i, j) = (" << i << ", " << j << ")";
+            }
+            ctr.incr();
+        }
+        EXPECT_TRUE(next.counter == ctr);
+        EXPECT_TRUE(RandBLAS::dense::compute_next_state<float>(D, state) == next);
+        // Float and double samples from one seed agree up to rounding.
+        std::vector<double> B(D.n_rows * D.n_cols);
+        auto next_double = RandBLAS::fill_dense(D, B.data(), state);
+        EXPECT_TRUE(next_double == next);
+        for (int64_t i = 0; i < D.n_rows * D.n_cols; ++i)
+            ASSERT_NEAR((double) A[i], B[i], 1e-5 * std::max(1.0, std::abs(B[i])));
     }
 }
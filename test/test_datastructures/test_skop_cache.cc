@@ -0,0 +1,136 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <RandBLAS/dense_skops.hh>
+#include <RandBLAS/sparse_skops.hh>
+#include <RandBLAS/skop_cache.hh>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::SkOpCache;
+using RandBLAS::RNGState;
+
+
+class TestSkOpCache : public ::testing::Test
+{
+    protected:
+
+    template <typename SKOP>
+    static void check_same_as_fresh(SKOP &cached, const typename SKOP::distribution_t &D, const typename SKOP::state_t &seed) {
+        SKOP fresh(D, seed);
+        if constexpr (std::is_same_v<typename SKOP::distribution_t, DenseDist>) {
+            RandBLAS::fill_dense(fresh);
+            for (int64_t i = 0; i < D.n_rows * D.n_cols; ++i)
+                ASSERT_EQ(cached.buff[i], fresh.buff[i]);
+        } else {
+            RandBLAS::fill_sparse(fresh);
+            ASSERT_EQ(cached.nnz, fresh.nnz);
+            for (int64_t i = 0; i < fresh.nnz; ++i) {
+                ASSERT_EQ(cached.vals[i], fresh.vals[i]);
+                ASSERT_EQ(cached.rows[i], fresh.rows[i]);
+                ASSERT_EQ(cached.cols[i], fresh.cols[i]);
+            }
+        }
+        ASSERT_EQ(cached.next_state, fresh.next_state);
+    }
+};
+
+TEST_F(TestSkOpCache, dense_hits_share_memory) {
+    SkOpCache<DenseSkOp<float>> cache(1 << 20);
+    DenseDist D(20, 7);
+    RNGState seed(3);
+    auto S1 = cache.get(D, seed);
+    auto S2 = cache.get(DenseDist(20, 7), RNGState(3));
+    EXPECT_EQ(S1.get(), S2.get());
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 1);
+    check_same_as_fresh(*S1, D, seed);
+
+    // A different seed or distribution is a different operator.
+    auto S3 = cache.get(D, RNGState(4));
+    auto S4 = cache.get(DenseDist(20, 7, RandBLAS::ScalarDist::Uniform), seed);
+    EXPECT_NE(S1.get(), S3.get());
+    EXPECT_NE(S1.get(), S4.get());
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_EQ(cache.bytes_in_use(), 3 * 20 * 7 * (int64_t) sizeof(float));
+}
+
+TEST_F(TestSkOpCache, sparse_matches_fill_sparse) {
+    SkOpCache<SparseSkOp<double>> cache(1 << 20);
+    SparseDist D(10, 300, 3);
+    RNGState seed(0);
+    auto S = cache.get(D, seed);
+    check_same_as_fresh(*S, D, seed);
+    EXPECT_EQ(cache.get(D, seed).get(), S.get());
+}
+
+TEST_F(TestSkOpCache, lru_eviction) {
+    DenseDist D(10, 10);
+    int64_t bytes = SkOpCache<DenseSkOp<double>>::operator_bytes(D);
+    SkOpCache<DenseSkOp<double>> cache(2 * bytes);
+    auto S0 = cache.get(D, RNGState(0));
+    cache.get(D, RNGState(1));
+    cache.get(D, RNGState(0));  // now seed 1 is least recently used.
+    cache.get(D, RNGState(2));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_LE(cache.bytes_in_use(), cache.capacity_bytes);
+    EXPECT_EQ(cache.get(D, RNGState(0)).get(), S0.get());
+    EXPECT_EQ(cache.misses(), 3);
+    cache.get(D, RNGState(1));
+    EXPECT_EQ(cache.misses(), 4);
+
+    // Evicted operators stay valid for whoever holds them.
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    check_same_as_fresh(*S0, D, RNGState(0));
+}
+
+TEST_F(TestSkOpCache, concurrent_requests_fill_once) {
+    SkOpCache<DenseSkOp<double>> cache(1 << 24);
+    DenseDist D(500, 200);
+    RNGState seed(7);
+    const int num_threads = 6;
+    std::vector<DenseSkOp<double>*> got(num_threads, nullptr);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() { got[t] = cache.get(D, seed).get(); });
+    }
+    for (auto &th : threads)
+        th.join();
+    for (int t = 1; t < num_threads; ++t)
+        EXPECT_EQ(got[t], got[0]);
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_EQ(cache.hits(), num_threads - 1);
+    check_same_as_fresh(*cache.get(D, seed), D, seed);
+}
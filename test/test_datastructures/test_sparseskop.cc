@@ -30,9 +30,11 @@
 #include <RandBLAS/dense_skops.hh>
 #include <RandBLAS/sparse_skops.hh>
 #include <RandBLAS/util.hh>
+#include <RandBLAS/skge.hh>
 #include "test/comparison.hh"
 #include <gtest/gtest.h>
 #include <cmath>
+#include <thread>
 
 using std::vector;
 using RandBLAS::RNGState;
@@ -84,9 +86,8 @@ class TestSparseSkOpConstruction : public ::testing::Test
         }
     }
 
-    template <SignedInteger sint_t>
+    template <SignedInteger sint_t, typename RNG = RandBLAS::DefaultRNG>
     void proper_saso_construction(int64_t d, int64_t m, int64_t key_index, int64_t nnz_index) {
-        using RNG = SparseSkOp<float>::state_t::generator;
         SparseDist D0(d, m, vec_nnzs[nnz_index], Axis::Short);
         SparseSkOp<float, RNG, sint_t> S0(D0, keys[key_index]);
         fill_sparse(S0);
@@ -97,9 +98,8 @@ class TestSparseSkOpConstruction : public ::testing::Test
         }
     }
 
-    template <SignedInteger sint_t>
+    template <SignedInteger sint_t, typename RNG = RandBLAS::DefaultRNG>
     void proper_laso_construction(int64_t d, int64_t m, int64_t key_index, int64_t nnz_index) {
-        using RNG = SparseSkOp<float>::state_t::generator;
         SparseDist D0(d, m, vec_nnzs[nnz_index], Axis::Long);
         SparseSkOp<float, RNG, sint_t> S0(D0, keys[key_index]);
         fill_sparse(S0);
@@ -192,6 +192,50 @@ TEST_F(TestSparseSkOpConstruction, fill_unpacked_nosub_laso) {
     unpacked_nosub({20,10,7,Axis::Long});
 }
 
+TEST_F(TestSparseSkOpConstruction, fill_unpacked_nosub_laso_packed_signs) {
+    unpacked_nosub({10,20,7,Axis::Long,true});
+    unpacked_nosub({20,10,7,Axis::Long,true});
+}
+
+TEST_F(TestSparseSkOpConstruction, fill_saso_thread_invariant) {
+    SparseDist D(40, 1000, 5, Axis::Short);
+    RNGState<RandBLAS::DefaultRNG> s(3);
+    SparseSkOp<double> S_serial(D, s);
+    fill_sparse(S_serial, RandBLAS::ExecPolicy{0, true});
+    for (int num_threads : {1, 2, 5}) {
+        SparseSkOp<double> S(D, s);
+        fill_sparse(S, RandBLAS::ExecPolicy{num_threads});
+        ASSERT_EQ(S.nnz, S_serial.nnz);
+        test::comparison::buffs_approx_equal(
+            S.vals, S_serial.vals, S.nnz, __PRETTY_FUNCTION__, __FILE__, __LINE__, 0.0, 0.0
+        );
+        test::comparison::buffs_approx_equal(
+            S.rows, S_serial.rows, S.nnz, __PRETTY_FUNCTION__, __FILE__, __LINE__, (int64_t) 0, (int64_t) 0
+        );
+        test::comparison::buffs_approx_equal(
+            S.cols, S_serial.cols, S.nnz, __PRETTY_FUNCTION__, __FILE__, __LINE__, (int64_t) 0, (int64_t) 0
+        );
+    }
+}
+
+TEST_F(TestSparseSkOpConstruction, faster_generators) {
+    // LASOs merge duplicate iid samples, so only SASOs have a fixed
+    // number of distinct indices per vector that we can check here.
+    using RandBLAS::Philox4x32_7;
+    using RandBLAS::Threefry4x32_13;
+    for (int64_t key_index : {0, 1, 2}) {
+        proper_saso_construction<int64_t, Philox4x32_7>(7, 20, key_index, 2);
+        proper_saso_construction<int64_t, Philox4x32_7>(15, 7, key_index, 3);
+        proper_saso_construction<int64_t, Threefry4x32_13>(7, 20, key_index, 2);
+        proper_saso_construction<int64_t, Threefry4x32_13>(15, 7, key_index, 3);
+        proper_saso_construction<int64_t, r123::Threefry2x64>(15, 7, key_index, 3);
+        #if R123_USE_AES_NI
+        proper_saso_construction<int64_t, RandBLAS::ARS4x32>(7, 20, key_index, 2);
+        proper_saso_construction<int64_t, RandBLAS::ARS4x32>(15, 7, key_index, 3);
+        #endif
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////
 //
 //
@@ -332,3 +376,55 @@ TEST_F(TestSparseSkOpConstruction, LASO_Dim_15by7_int32) {
     // proper_laso_construction<int>(15, 7, 0, 3);
     // proper_laso_construction<int>(15, 7, 1, 3);
 }
+
+
+class TestLazyFill : public ::testing::Test
+{
+    protected:
+
+    template <typename SKOP>
+    static void concurrent_sketches_share_one_fill(SKOP &S, int64_t d, int64_t m) {
+        using T = typename SKOP::scalar_t;
+        int64_t n = 4;
+        std::vector<T> A(m * n);
+        RandBLAS::RNGState state(2);
+        RandBLAS::fill_dense(RandBLAS::DenseDist(m, n), A.data(), state);
+
+        RandBLAS::enable_lazy_fill(S);
+        const int num_threads = 4;
+        std::vector<std::vector<T>> outs(num_threads, std::vector<T>(d * n));
+        std::vector<std::thread> threads;
+        auto NoTrans = blas::Op::NoTrans;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                RandBLAS::sketch_general(blas::Layout::ColMajor, NoTrans, NoTrans, d, n, m, (T) 1.0, S, 0, 0, A.data(), m, (T) 0.0, outs[t].data(), d);
+            });
+        }
+        for (auto &th : threads)
+            th.join();
+        EXPECT_TRUE(S.lazy_fill->finished());
+
+        std::vector<T> expect(d * n);
+        SKOP S_ref(S.dist, S.seed_state);
+        RandBLAS::sketch_general(blas::Layout::ColMajor, NoTrans, NoTrans, d, n, m, (T) 1.0, S_ref, 0, 0, A.data(), m, (T) 0.0, expect.data(), d);
+        for (int t = 0; t < num_threads; ++t) {
+            for (int64_t i = 0; i < d * n; ++i)
+                ASSERT_EQ(outs[t][i], expect[i]);
+        }
+    }
+};
+
+TEST_F(TestLazyFill, sparse_operator_filled_in_place) {
+    SparseDist D(6, 300, 2);
+    SparseSkOp<double> S(D, 12);
+    concurrent_sketches_share_one_fill(S, 6, 300);
+    ASSERT_EQ(S.nnz, D.full_nnz);
+    ASSERT_NE(S.vals, nullptr);
+}
+
+TEST_F(TestLazyFill, dense_operator_filled_in_place) {
+    RandBLAS::DenseDist D(6, 300);
+    RandBLAS::DenseSkOp<float> S(D, 12);
+    concurrent_sketches_share_one_fill(S, 6, 300);
+    ASSERT_NE(S.buff, nullptr);
+}
@@ -118,4 +118,61 @@ TEST_F(TestSparseTranspose, CSC_TO_CSR_7x20) {
 TEST_F(TestSparseTranspose, CSC_TO_CSR_13x5) {
     test_transposed_csc_as_csr(13, 5, 0.05);
     test_transposed_csc_as_csr(13, 5, 0.90);
-}
\ No newline at end of file
+}
+
+class TestSparseToCOO : public ::testing::Test 
+{
+    protected:
+    virtual void SetUp(){};
+    virtual void TearDown(){};
+
+    template <typename T = double>
+    void test_csc_to_coo(int64_t m, int64_t n, T p) {
+        Layout layout = Layout::ColMajor;
+        std::vector<T> A_dense(m * n);
+        std::vector<T> B_dense(m * n, 0.0);
+        RandBLAS::RNGState s(1);
+        iid_sparsify_random_dense(m, n, layout, A_dense.data(), p, s);
+        CSCMatrix<T> A_csc(m, n);
+        dense_to_csc(layout, A_dense.data(), 0.0, A_csc);
+
+        COOMatrix<T> A_coo(m, n);
+        csc_to_coo(A_csc, A_coo);
+        ASSERT_EQ(A_coo.nnz, A_csc.nnz);
+        coo_to_dense(A_coo, layout, B_dense.data());
+        test::comparison::matrices_approx_equal(
+            layout, blas::Op::NoTrans, m, n, A_dense.data(), m, B_dense.data(), m,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__
+        );
+    }
+
+    template <typename T = double>
+    void test_csr_to_coo(int64_t m, int64_t n, T p) {
+        Layout layout = Layout::ColMajor;
+        std::vector<T> A_dense(m * n);
+        std::vector<T> B_dense(m * n, 0.0);
+        RandBLAS::RNGState s(1);
+        iid_sparsify_random_dense(m, n, layout, A_dense.data(), p, s);
+        CSRMatrix<T> A_csr(m, n);
+        dense_to_csr(layout, A_dense.data(), 0.0, A_csr);
+
+        COOMatrix<T> A_coo(m, n);
+        csr_to_coo(A_csr, A_coo);
+        ASSERT_EQ(A_coo.nnz, A_csr.nnz);
+        coo_to_dense(A_coo, layout, B_dense.data());
+        test::comparison::matrices_approx_equal(
+            layout, blas::Op::NoTrans, m, n, A_dense.data(), m, B_dense.data(), m,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__
+        );
+    }
+};
+
+TEST_F(TestSparseToCOO, CSC_TO_COO_13x5) {
+    test_csc_to_coo(13, 5, 0.10);
+    test_csc_to_coo(13, 5, 0.80);
+}
+
+TEST_F(TestSparseToCOO, CSR_TO_COO_13x5) {
+    test_csr_to_coo(13, 5, 0.10);
+    test_csr_to_coo(13, 5, 0.80);
+}
@@ -230,6 +230,20 @@ TEST_F(TestLSKGES, sketch_saso_colMajor_fourThreads)
 }
 #endif
 
+TEST_F(TestLSKGES, sketch_saso_unrolled_vec_nnz)
+{
+    // vec_nnz in {1, 2, 4, 8} uses kernels with compile-time trip counts; 5 uses the generic kernel.
+    for (int64_t vec_nnz : {1, 2, 4, 5, 8}) {
+        for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+            SparseDist D(19, 201, vec_nnz, Axis::Short);
+            SparseSkOp<double> S(D, keys[0]);
+            test_left_apply_to_random<double>(1.0, S, 12, 0.0, layout, 1);
+            SparseSkOp<float> S_single(D, keys[1]);
+            test_left_apply_to_random<float>(1.0, S_single, 12, 0.0, layout, 1);
+        }
+    }
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 //
@@ -216,6 +216,22 @@ TEST_F(TestRSKGES, sketch_laso_colMajor_oneThread)
     }
 }
 
+TEST_F(TestRSKGES, sketch_saso_unrolled_vec_nnz)
+{
+    // vec_nnz in {1, 2, 4, 8} uses kernels with compile-time trip counts; 5 uses the generic kernel.
+    for (int64_t vec_nnz : {1, 2, 4, 5, 8}) {
+        for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+            SparseDist D(201, 19, vec_nnz, RandBLAS::Axis::Short);
+            SparseSkOp<double> S(D, keys[0]);
+            RandBLAS::fill_sparse(S);
+            test_right_apply_to_random<double>(1.0, S, 12, layout, 0.0, 1);
+            SparseSkOp<float> S_single(D, keys[1]);
+            RandBLAS::fill_sparse(S_single);
+            test_right_apply_to_random<float>(1.0, S_single, 12, layout, 0.0, 1);
+        }
+    }
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 //
@@ -385,3 +401,26 @@ TEST_F(TestRSKGES, subset_cols_s_rowmajor2)
             Layout::RowMajor
         );
 }
+
+TEST_F(TestRSKGES, unfilled_operator_nonzero_beta)
+{
+    // An unfilled operator must give the same result as a filled one,
+    // including when beta != 0 (so B must only be updated once).
+    int64_t m = 9, d = 5, n = 40;
+    SparseDist D(n, d, 3);
+    SparseSkOp<double> S_filled(D, 3);
+    RandBLAS::fill_sparse(S_filled);
+    SparseSkOp<double> S_unfilled(D, 3);
+
+    std::vector<double> A(m * n);
+    RandBLAS::RNGState state(8);
+    RandBLAS::fill_dense(RandBLAS::DenseDist(m, n), A.data(), state);
+    std::vector<double> B_expect(m * d, 1.0);
+    std::vector<double> B_actual(m * d, 1.0);
+    auto NoTrans = blas::Op::NoTrans;
+    RandBLAS::sketch_general(Layout::ColMajor, NoTrans, NoTrans, m, d, n, 2.0, A.data(), m, S_filled, 0, 0, 0.5, B_expect.data(), m);
+    RandBLAS::sketch_general(Layout::ColMajor, NoTrans, NoTrans, m, d, n, 2.0, A.data(), m, S_unfilled, 0, 0, 0.5, B_actual.data(), m);
+    test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), m * d,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__
+    );
+}
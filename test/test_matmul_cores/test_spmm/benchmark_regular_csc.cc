@@ -0,0 +1,102 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS.hh"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+using namespace RandBLAS;
+using namespace RandBLAS::sparse_data;
+
+
+// Time C += S * B where S is a d-by-m SASO with vec_nnz nonzeros per column and B is
+// m-by-n in column-major order. The "generic" kernel uses a runtime trip count for the
+// loop over each column of S; the "dispatched" kernel uses an unrolled loop whenever
+// vec_nnz is 1, 2, 4, or 8.
+template <typename T>
+void report(int64_t d, int64_t m, int64_t n, int64_t vec_nnz, int reps) {
+    SparseDist D(d, m, vec_nnz, Axis::Short);
+    SparseSkOp<T> S(D, 0);
+    fill_sparse(S);
+    auto S_coo = coo_view_of_skop(S);
+    CSCMatrix<T> S_csc(d, m);
+    conversions::coo_to_csc(S_coo, S_csc);
+
+    std::vector<T> B(m * n);
+    for (int64_t i = 0; i < m * n; ++i)
+        B[i] = (T) ((i * 7 + 3) % 11) - (T) 5;
+    std::vector<T> C(d * n, (T) 0);
+
+    auto time = [&](auto &&body) {
+        body(); // warm up
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < reps; ++r)
+            body();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(t1 - t0).count() / reps;
+    };
+    double t_generic = time([&]() {
+        parallel::parallel_for(0, n, [&](int64_t j_start, int64_t j_stop) {
+            for (int64_t j = j_start; j < j_stop; ++j)
+                csc::apply_regular_csc_to_vector_from_left_ki<T>(
+                    S_csc.vals, S_csc.rowidxs, vec_nnz, m, B.data() + j * m, 1, C.data() + j * d, 1
+                );
+        });
+    });
+    double t_dispatched = time([&]() {
+        csc::apply_regular_csc_left_jki<T>(
+            S_csc.vals, S_csc.rowidxs, vec_nnz, n, m, B.data(), 1, m, C.data(), 1, d
+        );
+    });
+    std::cerr << "[vec_nnz = " << vec_nnz << "] generic: " << t_generic * 1e3 << " ms, dispatched: "
+        << t_dispatched * 1e3 << " ms, speedup: " << t_generic / t_dispatched << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " d m n [reps]" << std::endl;
+        return 1;
+    }
+
+    using T = double;
+
+    int64_t d = atoi(argv[1]);
+    int64_t m = atoi(argv[2]);
+    int64_t n = atoi(argv[3]);
+    int reps = (argc > 4) ? atoi(argv[4]) : 5;
+
+    for (int64_t vec_nnz : {1, 2, 4, 8})
+        report<T>(d, m, n, vec_nnz, reps);
+
+    return 0;
+}
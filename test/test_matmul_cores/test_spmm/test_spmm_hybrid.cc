@@ -0,0 +1,191 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "test/test_matmul_cores/test_spmm/spmm_test_helpers.hh"
+#include "test/comparison.hh"
+#include <RandBLAS.hh>
+#include <vector>
+
+using namespace RandBLAS::sparse_data;
+using RandBLAS::ExecPolicy;
+using blas::Layout;
+using blas::Op;
+
+
+template <SparseMatrix SpMat>
+class TestHybridSpMM : public ::testing::Test {
+    public:
+    using T = typename SpMat::scalar_t;
+
+    // A d0-by-m0 matrix that's mostly sparse, with two dense rows and one dense column.
+    static std::vector<T> make_dense(int64_t d0, int64_t m0, uint32_t key) {
+        std::vector<T> mat(d0 * m0);
+        RandBLAS::RNGState s(key);
+        iid_sparsify_random_dense<T>(d0, m0, Layout::ColMajor, mat.data(), (T) 0.95, s);
+        for (int64_t k = 0; k < m0; ++k) {
+            mat[1 + k * d0] = (T) 1 + (T) (k % 5) / 5;
+            mat[(d0 - 3) + k * d0] = (T) -1 + (T) (k % 3) / 3;
+        }
+        for (int64_t i = 0; i < d0; ++i)
+            mat[i + 4 * d0] = (T) 0.5 - (T) (i % 7) / 7;
+        return mat;
+    }
+
+    static SpMat to_sparse(int64_t d0, int64_t m0, std::vector<T> &mat) {
+        SpMat A(d0, m0);
+        using sint_t = typename SpMat::index_t;
+        if constexpr (std::is_same_v<SpMat, COOMatrix<T, sint_t>>) {
+            coo::dense_to_coo<T>(Layout::ColMajor, mat.data(), 0.0, A);
+        } else if constexpr (std::is_same_v<SpMat, CSRMatrix<T, sint_t>>) {
+            csr::dense_to_csr<T>(Layout::ColMajor, mat.data(), 0.0, A);
+        } else {
+            csc::dense_to_csc<T>(Layout::ColMajor, mat.data(), 0.0, A);
+        }
+        return A;
+    }
+
+    // Check C = alpha * op(A) * op(B) + beta * C against GEMM on a dense copy of A,
+    // when dense rows and columns of A are split off.
+    static void check_spmm(Layout layout, Op opA, Op opB, double threshold) {
+        int64_t d0 = 30, m0 = 40, n = 7;
+        auto dense = make_dense(d0, m0, 11);
+        auto A = to_sparse(d0, m0, dense);
+        auto [rows_opA, cols_opA] = (opA == Op::NoTrans) ? std::pair{d0, m0} : std::pair{m0, d0};
+        int64_t m = rows_opA, k = cols_opA;
+        auto [rows_B, cols_B] = RandBLAS::dims_before_op(k, n, opB);
+        int64_t ldb = (layout == Layout::ColMajor) ? rows_B : cols_B;
+        int64_t ldc = (layout == Layout::ColMajor) ? m : n;
+        std::vector<T> B(k * n);
+        for (size_t i = 0; i < B.size(); ++i)
+            B[i] = (T) ((i * 7 + 2) % 13) / (T) 6 - (T) 1;
+        std::vector<T> C_actual(m * n), C_expect(m * n);
+        for (size_t i = 0; i < C_actual.size(); ++i)
+            C_actual[i] = C_expect[i] = (T) (i % 5);
+
+        RandBLAS::spmm(layout, opA, opB, m, n, k, (T) 1.5, A, B.data(), ldb, (T) 0.5, C_actual.data(), ldc, ExecPolicy{}, threshold);
+        // The dense copy of A is column-major.
+        if (layout == Layout::ColMajor) {
+            blas::gemm(layout, opA, opB, m, n, k, (T) 1.5, dense.data(), d0, B.data(), ldb, (T) 0.5, C_expect.data(), ldc);
+        } else {
+            // Compute the expected result in column-major and transpose it.
+            std::vector<T> C_col(m * n);
+            for (int64_t i = 0; i < m; ++i)
+                for (int64_t j = 0; j < n; ++j)
+                    C_col[i + j * m] = C_expect[i * n + j];
+            std::vector<T> B_col(k * n);
+            for (int64_t i = 0; i < rows_B; ++i)
+                for (int64_t j = 0; j < cols_B; ++j)
+                    B_col[i + j * rows_B] = B[i * cols_B + j];
+            blas::gemm(Layout::ColMajor, opA, opB, m, n, k, (T) 1.5, dense.data(), d0, B_col.data(), rows_B, (T) 0.5, C_col.data(), m);
+            for (int64_t i = 0; i < m; ++i)
+                for (int64_t j = 0; j < n; ++j)
+                    C_expect[i * n + j] = C_col[i + j * m];
+        }
+        T tol = 100 * std::numeric_limits<T>::epsilon();
+        test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), m * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+};
+
+using SpMatTypes = ::testing::Types<COOMatrix<double>, CSRMatrix<double>, CSCMatrix<double>, CSRMatrix<float>>;
+TYPED_TEST_SUITE(TestHybridSpMM, SpMatTypes);
+
+TYPED_TEST(TestHybridSpMM, split_matches_dense) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        for (auto opA : {Op::NoTrans, Op::Trans}) {
+            for (auto opB : {Op::NoTrans, Op::Trans}) {
+                TestFixture::check_spmm(layout, opA, opB, 0.5);
+                TestFixture::check_spmm(layout, opA, opB, 0.0);
+            }
+        }
+    }
+}
+
+TYPED_TEST(TestHybridSpMM, threshold_above_one_has_no_effect) {
+    TestFixture::check_spmm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, 1.5);
+}
+
+TYPED_TEST(TestHybridSpMM, split_finds_dense_panels) {
+    using T = typename TypeParam::scalar_t;
+    int64_t d0 = 30, m0 = 40;
+    auto dense = TestFixture::make_dense(d0, m0, 11);
+    auto A = TestFixture::to_sparse(d0, m0, dense);
+    TypeParam remainder(d0, m0);
+    hybrid::DensePanels<T> panels;
+    bool split = hybrid::split_dense_panels(0.5, Layout::ColMajor, A, 0, 0, d0, m0, panels, remainder);
+    ASSERT_TRUE(split);
+    ASSERT_EQ(panels.rows, (std::vector<int64_t>{1, d0 - 3}));
+    ASSERT_EQ(panels.cols, (std::vector<int64_t>{4}));
+    int64_t panel_nnz = 2 * m0 + (d0 - 2);
+    ASSERT_EQ(remainder.nnz + panel_nnz, A.nnz);
+    // The remainder has no dense rows or columns left to split.
+    TypeParam again(d0, m0);
+    hybrid::DensePanels<T> no_panels;
+    ASSERT_FALSE(hybrid::split_dense_panels(0.5, Layout::ColMajor, remainder, 0, 0, d0, m0, no_panels, again));
+}
+
+TEST(TestHybridSpMMOffsets, coo_submatrix) {
+    // Only the dense rows inside the submatrix are split off.
+    int64_t d0 = 30, m0 = 40, d = 20, m = 25, n = 6, ro = 1, co = 10;
+    auto dense = TestHybridSpMM<COOMatrix<double>>::make_dense(d0, m0, 3);
+    auto A = TestHybridSpMM<COOMatrix<double>>::to_sparse(d0, m0, dense);
+    std::vector<double> B(m * n);
+    for (size_t i = 0; i < B.size(); ++i)
+        B[i] = (double) ((i * 5 + 1) % 9) - 4.0;
+    std::vector<double> C_actual(d * n, 0.0), C_expect(d * n, 0.0);
+    left_spmm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, n, m, 1.0, A, ro, co, B.data(), m, 0.0, C_actual.data(), d, 0.5);
+    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, n, m, 1.0, dense.data() + ro + co * d0, d0, B.data(), m, 0.0, C_expect.data(), d);
+    test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), d * n,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-12, 1e-12
+    );
+}
+
+TEST(TestHybridSpMMOffsets, sketch_sparse_left_and_right) {
+    int64_t d0 = 30, m0 = 40, d = 8;
+    auto dense = TestHybridSpMM<CSRMatrix<double>>::make_dense(d0, m0, 5);
+    auto A = TestHybridSpMM<CSRMatrix<double>>::to_sparse(d0, m0, dense);
+    RandBLAS::DenseDist DS(d, d0);
+    RandBLAS::DenseSkOp<double> S(DS, 7);
+    RandBLAS::fill_dense(S);
+    // Left: B = S * A is d-by-m0.
+    std::vector<double> B_split(d * m0), B_plain(d * m0);
+    RandBLAS::sketch_sparse(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, m0, d0, 1.0, S, 0, 0, A, 0.0, B_split.data(), d, ExecPolicy{}, 0.5);
+    RandBLAS::sketch_sparse(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, m0, d0, 1.0, S, 0, 0, A, 0.0, B_plain.data(), d);
+    test::comparison::buffs_approx_equal(B_split.data(), B_plain.data(), d * m0,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-12, 1e-12
+    );
+    // Right: C = A^T * S^T is m0-by-d.
+    std::vector<double> C_split(m0 * d), C_plain(m0 * d);
+    RandBLAS::sketch_sparse(Layout::RowMajor, Op::Trans, Op::Trans, m0, d, d0, 1.0, A, S, 0, 0, 0.0, C_split.data(), d, ExecPolicy{}, 0.5);
+    RandBLAS::sketch_sparse(Layout::RowMajor, Op::Trans, Op::Trans, m0, d, d0, 1.0, A, S, 0, 0, 0.0, C_plain.data(), d);
+    test::comparison::buffs_approx_equal(C_split.data(), C_plain.data(), m0 * d,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-12, 1e-12
+    );
+}
@@ -0,0 +1,264 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/features.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::ExecPolicy;
+using RandBLAS::FourierFeatureMap;
+using RandBLAS::RNGState;
+using RandBLAS::ScalarDist;
+
+
+class TestFourierFeatures : public ::testing::Test
+{
+    protected:
+
+    // Return Z = sqrt(2/D) cos(S X / sigma + b) as a column-major D-by-n matrix, for
+    // column-major X, computed one entry at a time.
+    template <typename T, typename RNG>
+    static std::vector<T> reference(FourierFeatureMap<T,RNG> &F, int64_t n, const std::vector<T> &X) {
+        int64_t D = F.num_features, m = F.dim;
+        auto [s_row, s_col] = RandBLAS::layout_to_strides(F.S.layout, D, m);
+        std::vector<T> Z(D * n);
+        for (int64_t j = 0; j < n; ++j) {
+            for (int64_t i = 0; i < D; ++i) {
+                T acc = 0;
+                for (int64_t k = 0; k < m; ++k)
+                    acc += F.S.buff[i * s_row + k * s_col] * X[k + j * m];
+                Z[i + j * D] = std::sqrt((T) 2 / (T) D) * std::cos(acc / F.bandwidth + F.phases[i]);
+            }
+        }
+        return Z;
+    }
+
+    template <typename T>
+    static void matches_reference(int64_t dim, int64_t D, int64_t n, blas::Layout layout, ScalarDist family) {
+        FourierFeatureMap<T> F(dim, D, (T) 1.5, RNGState<>(11), family);
+        for (int64_t i = 0; i < D; ++i) {
+            ASSERT_GE(F.phases[i], (T) 0);
+            ASSERT_LE(F.phases[i], (T) (2 * M_PI));
+        }
+        std::vector<T> X(dim * n);
+        RandBLAS::DenseDist DX(dim, n, ScalarDist::Uniform);
+        RandBLAS::fill_dense_unpacked(blas::Layout::ColMajor, DX, dim, n, 0, 0, X.data(), RNGState<>(3));
+        auto Z_expect = reference(F, n, X);
+
+        std::vector<T> X_in(X);
+        if (layout == blas::Layout::RowMajor) {
+            for (int64_t k = 0; k < dim; ++k) {
+                for (int64_t j = 0; j < n; ++j)
+                    X_in[j + k * n] = X[k + j * dim];
+            }
+        }
+        int64_t ldx = (layout == blas::Layout::ColMajor) ? dim : n;
+        int64_t ldz = (layout == blas::Layout::ColMajor) ? D : n;
+        std::vector<T> Z(D * n);
+        RandBLAS::fourier_features(layout, n, F, X_in.data(), ldx, Z.data(), ldz);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * dim;
+        test::comparison::matrices_approx_equal(
+            layout, blas::Layout::ColMajor, blas::Op::NoTrans, D, n, Z.data(), ldz, Z_expect.data(), D,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+};
+
+TEST_F(TestFourierFeatures, matches_reference_one_tile) {
+    matches_reference<double>(7, 20, 13, blas::Layout::ColMajor, ScalarDist::Gaussian);
+    matches_reference<double>(7, 20, 13, blas::Layout::RowMajor, ScalarDist::Gaussian);
+    matches_reference<float>(7, 20, 13, blas::Layout::ColMajor, ScalarDist::Gaussian);
+}
+
+TEST_F(TestFourierFeatures, matches_reference_many_tiles) {
+    // 600 features and 150 points split Z into 2-by-3 tiles.
+    matches_reference<double>(9, 600, 150, blas::Layout::ColMajor, ScalarDist::Gaussian);
+    matches_reference<double>(9, 600, 150, blas::Layout::RowMajor, ScalarDist::GaussianZiggurat);
+}
+
+TEST_F(TestFourierFeatures, batches_match_single_call) {
+    int64_t dim = 5, D = 64, n = 40, n1 = 17;
+    FourierFeatureMap<double> F(dim, D, 2.0, RNGState<>(0));
+    std::vector<double> X(dim * n);
+    DenseDist DX(dim, n);
+    RandBLAS::fill_dense_unpacked(blas::Layout::ColMajor, DX, dim, n, 0, 0, X.data(), RNGState<>(1));
+    std::vector<double> Z_all(D * n), Z_batched(D * n);
+    RandBLAS::fourier_features(blas::Layout::ColMajor, n, F, X.data(), dim, Z_all.data(), D);
+    RandBLAS::fourier_features(blas::Layout::ColMajor, n1, F, X.data(), dim, Z_batched.data(), D);
+    RandBLAS::fourier_features(blas::Layout::ColMajor, n - n1, F, X.data() + n1 * dim, dim, Z_batched.data() + n1 * D, D, ExecPolicy{0, true});
+    for (int64_t i = 0; i < D * n; ++i)
+        ASSERT_EQ(Z_all[i], Z_batched[i]) << "i = " << i;
+}
+
+TEST_F(TestFourierFeatures, approximates_gaussian_kernel) {
+    int64_t dim = 4, D = 20000, n = 3;
+    double sigma = 1.3;
+    FourierFeatureMap<double> F(dim, D, sigma, RNGState<>(5));
+    // Three points at increasing distances from the first.
+    std::vector<double> X = {0, 0, 0, 0,  0.5, 0, 0, 0,  1, 1, 0, 1};
+    std::vector<double> Z(D * n);
+    RandBLAS::fourier_features(blas::Layout::ColMajor, n, F, X.data(), dim, Z.data(), D);
+    for (int64_t j = 0; j < n; ++j) {
+        double dist2 = 0, approx = 0;
+        for (int64_t k = 0; k < dim; ++k)
+            dist2 += std::pow(X[k + j * dim] - X[k], 2);
+        for (int64_t i = 0; i < D; ++i)
+            approx += Z[i] * Z[i + j * D];
+        // The estimate is an average of D terms bounded by 2 in absolute value.
+        EXPECT_NEAR(approx, std::exp(-dist2 / (2 * sigma * sigma)), 0.05) << "j = " << j;
+    }
+}
+
+TEST_F(TestFourierFeatures, next_state_follows_phases) {
+    FourierFeatureMap<double> F(3, 10, 1.0, RNGState<>(2));
+    EXPECT_EQ(F.seed_state, F.S.seed_state);
+    EXPECT_NE(F.next_state, F.S.next_state);
+    EXPECT_THROW(FourierFeatureMap<double>(3, 10, 1.0, RNGState<>(2), ScalarDist::Uniform), RandBLAS::Error);
+    EXPECT_THROW(FourierFeatureMap<double>(3, 10, 0.0, RNGState<>(2)), RandBLAS::Error);
+}
+
+
+class TestSimHash : public ::testing::Test
+{
+    protected:
+
+    // Compare simhash_signatures against the signs of a full sketch_general, for data in "layout".
+    template <typename T, typename SKOP>
+    static void check_against_full_sketch(blas::Layout layout, SKOP &S, int64_t n, int64_t ldsig) {
+        int64_t D = S.n_rows, m = S.n_cols;
+        int64_t words = (D + 63) / 64;
+        std::vector<T> X(m * n);
+        RandBLAS::fill_dense(DenseDist(m, n), X.data(), RNGState<>(61));
+        int64_t ldx = (layout == blas::Layout::ColMajor) ? m : n;
+        std::vector<T> P(D * n);
+        RandBLAS::sketch_general(layout, blas::Op::NoTrans, blas::Op::NoTrans, D, n, m, (T) 1.0, S, X.data(), ldx, (T) 0.0, P.data(), (layout == blas::Layout::ColMajor) ? D : n);
+        auto [p_row, p_col] = RandBLAS::layout_to_strides(layout, (layout == blas::Layout::ColMajor) ? D : n);
+
+        std::vector<uint64_t> sigs(n * ldsig, ~((uint64_t) 0));
+        RandBLAS::simhash_signatures(layout, n, S, X.data(), ldx, sigs.data(), ldsig);
+        for (int64_t j = 0; j < n; ++j) {
+            for (int64_t w = 0; w < words; ++w) {
+                uint64_t word = sigs[j * ldsig + w];
+                for (int64_t b = 0; b < 64; ++b) {
+                    int64_t i = 64 * w + b;
+                    bool bit = (word >> b) & 1;
+                    bool expect = (i < D) && (P[i * p_row + j * p_col] >= (T) 0);
+                    ASSERT_EQ(bit, expect) << "point " << j << ", bit " << i;
+                }
+            }
+            // Padding words past the signature are left alone.
+            for (int64_t w = words; w < ldsig; ++w)
+                ASSERT_EQ(sigs[j * ldsig + w], ~((uint64_t) 0));
+        }
+    }
+};
+
+TEST_F(TestSimHash, matches_signs_of_sketch_one_tile) {
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        DenseSkOp<double> S(DenseDist(130, 7), 62);
+        check_against_full_sketch<double>(layout, S, 20, 3);
+        check_against_full_sketch<double>(layout, S, 20, 5);
+    }
+}
+
+TEST_F(TestSimHash, matches_signs_of_sketch_many_tiles) {
+    // 700 bits need two row tiles, and 150 points need three column tiles.
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        DenseSkOp<float> S(DenseDist(700, 9), 63);
+        check_against_full_sketch<float>(layout, S, 150, 11);
+    }
+}
+
+TEST_F(TestSimHash, sparse_operator) {
+    SparseSkOp<double> S(SparseDist(100, 40, 4), 64);
+    check_against_full_sketch<double>(blas::Layout::ColMajor, S, 30, 2);
+}
+
+TEST_F(TestSimHash, sparse_operator_many_tiles) {
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        SparseSkOp<float> S(SparseDist(700, 9, 3), 66);
+        check_against_full_sketch<float>(layout, S, 150, 11);
+    }
+}
+
+TEST_F(TestSimHash, hamming_matches_naive) {
+    int64_t words = 3, n_q = 70, n_d = 45, ldq = 4, ldd = 3, lddist = 50;
+    std::vector<uint64_t> Q(n_q * ldq), Dsig(n_d * ldd);
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (auto &q : Q) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; q = x; }
+    for (auto &d : Dsig) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; d = x; }
+    std::vector<int64_t> dist(n_q * lddist, -1);
+    RandBLAS::hamming_distances(words, n_q, Q.data(), ldq, n_d, Dsig.data(), ldd, dist.data(), lddist);
+    for (int64_t i = 0; i < n_q; ++i) {
+        for (int64_t j = 0; j < n_d; ++j) {
+            int64_t expect = 0;
+            for (int64_t w = 0; w < words; ++w) {
+                uint64_t v = Q[i * ldq + w] ^ Dsig[j * ldd + w];
+                for (int b = 0; b < 64; ++b)
+                    expect += (v >> b) & 1;
+            }
+            ASSERT_EQ(dist[i * lddist + j], expect);
+        }
+        for (int64_t j = n_d; j < lddist; ++j)
+            ASSERT_EQ(dist[i * lddist + j], -1);
+    }
+}
+
+TEST_F(TestSimHash, hamming_distance_estimates_angle) {
+    // Three points in the plane (embedded in R^5) at angles 0, pi/4, and pi/2 from the first.
+    int64_t m = 5, n = 3, D = 4096;
+    std::vector<double> X(m * n, 0.0);
+    X[0] = 1.0;
+    X[m + 0] = 1.0; X[m + 1] = 1.0;
+    X[2 * m + 1] = 2.0;
+    DenseSkOp<double> S(DenseDist(D, m), 65);
+    int64_t words = D / 64;
+    std::vector<uint64_t> sigs(n * words);
+    RandBLAS::simhash_signatures(blas::Layout::ColMajor, n, S, X.data(), m, sigs.data(), words);
+    std::vector<int64_t> dist(n * n);
+    RandBLAS::hamming_distances(words, n, sigs.data(), words, n, sigs.data(), words, dist.data(), n);
+    EXPECT_EQ(dist[0], 0);
+    EXPECT_NEAR((double) dist[1] / (double) D, 0.25, 0.03);
+    EXPECT_NEAR((double) dist[2] / (double) D, 0.5, 0.03);
+    EXPECT_EQ(dist[1], dist[n]);
+}
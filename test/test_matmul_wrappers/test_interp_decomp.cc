@@ -0,0 +1,259 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/interp_decomp.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::RNGState;
+using namespace RandBLAS::sparse_data;
+using blas::Layout;
+using blas::Op;
+
+
+class TestColumnID : public ::testing::Test
+{
+    protected:
+
+    // A column-major m-by-n matrix G H + noise * E, where G is m-by-r and H is r-by-n.
+    template <typename T>
+    static std::vector<T> make_low_rank(int64_t m, int64_t n, int64_t r, T noise, uint32_t key) {
+        std::vector<T> G(m * r), H(r * n), A(m * n);
+        auto state = RandBLAS::fill_dense(DenseDist(m, r), G.data(), RNGState<>(key));
+        state = RandBLAS::fill_dense(DenseDist(r, n), H.data(), state);
+        RandBLAS::fill_dense(DenseDist(m, n), A.data(), state);
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, n, r, (T) 1.0, G.data(), m, H.data(), r, noise, A.data(), m);
+        return A;
+    }
+
+    // Check that J has k distinct entries in [0, n), that columns J of X are the identity,
+    // and return the Frobenius norm of A - A[:, J] X. A is column-major, X is in "layout".
+    template <typename T>
+    static T id_error(Layout layout, int64_t m, int64_t n, int64_t k, const T *A, const int64_t *J, const T *X, int64_t ldx) {
+        std::set<int64_t> distinct(J, J + k);
+        EXPECT_EQ((int64_t) distinct.size(), k);
+        for (int64_t t = 0; t < k; ++t) {
+            EXPECT_GE(J[t], 0);
+            EXPECT_LT(J[t], n);
+        }
+        auto [x_row, x_col] = RandBLAS::layout_to_strides(layout, ldx);
+        std::vector<T> X_cm(k * n);
+        RandBLAS::util::omatcopy(k, n, X, x_row, x_col, X_cm.data(), 1, k);
+        for (int64_t t = 0; t < k; ++t)
+            for (int64_t i = 0; i < k; ++i)
+                EXPECT_EQ(X_cm[i + J[t] * k], (i == t) ? (T) 1.0 : (T) 0.0);
+        std::vector<T> C(m * k);
+        for (int64_t t = 0; t < k; ++t)
+            blas::copy(m, A + J[t] * m, 1, C.data() + t * m, 1);
+        std::vector<T> E(A, A + m * n);
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, n, k, (T) -1.0, C.data(), m, X_cm.data(), k, (T) 1.0, E.data(), m);
+        return blas::nrm2(m * n, E.data(), 1);
+    }
+
+    template <typename T>
+    static void check_dense(Layout layout, int64_t m, int64_t n, int64_t k, int64_t r, T noise, T tol) {
+        std::vector<T> A = make_low_rank<T>(m, n, r, noise, 41);
+        std::vector<T> A_layout(A);
+        int64_t lda = m;
+        if (layout == Layout::RowMajor) {
+            lda = n;
+            RandBLAS::util::omatcopy(m, n, A.data(), 1, m, A_layout.data(), n, 1);
+        }
+        int64_t ldx = (layout == Layout::ColMajor) ? k : n;
+        std::vector<int64_t> J(k);
+        std::vector<T> X(k * n);
+        RNGState<> state(42);
+        auto next = RandBLAS::column_id(layout, m, n, A_layout.data(), lda, k, J.data(), X.data(), ldx, state);
+        EXPECT_GT(next.counter[0], state.counter[0]);
+        T err = id_error(layout, m, n, k, A.data(), J.data(), X.data(), ldx);
+        EXPECT_LT(err, tol * blas::nrm2(m * n, A.data(), 1));
+    }
+
+    // A column-major m-by-n matrix U diag(s) V^T of rank r, where U and V have orthonormal
+    // columns and the singular values s decay geometrically from 1 to s_min.
+    template <typename T>
+    static std::vector<T> make_decaying(int64_t m, int64_t n, int64_t r, T s_min, uint32_t key) {
+        std::vector<T> U(m * r), V(n * r), R(r * r), A(m * n);
+        auto state = RandBLAS::fill_dense(DenseDist(m, r), U.data(), RNGState<>(key));
+        RandBLAS::fill_dense(DenseDist(n, r), V.data(), state);
+        RandBLAS::interp_decomp::householder_qr(m, r, U.data(), m, R.data(), r);
+        RandBLAS::interp_decomp::householder_qr(n, r, V.data(), n, R.data(), r);
+        for (int64_t j = 0; j < r; ++j) {
+            T s_j = std::pow(s_min, (T) j / (T) (r - 1));
+            blas::scal(m, s_j, U.data() + j * m, 1);
+        }
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, m, n, r, (T) 1.0, U.data(), m, V.data(), n, (T) 0.0, A.data(), m);
+        return A;
+    }
+
+    // Run column_id on make_decaying(m, n, r, s_min) with k = r, and return the relative error.
+    template <typename T>
+    static T decaying_error(Layout layout, int64_t m, int64_t n, int64_t r, T s_min, int64_t &k) {
+        std::vector<T> A = make_decaying<T>(m, n, r, s_min, 47);
+        std::vector<T> A_layout(A);
+        int64_t lda = m;
+        if (layout == Layout::RowMajor) {
+            lda = n;
+            RandBLAS::util::omatcopy(m, n, A.data(), 1, m, A_layout.data(), n, 1);
+        }
+        k = r;
+        int64_t ldx = (layout == Layout::ColMajor) ? k : n;
+        std::vector<int64_t> J(k);
+        std::vector<T> X(k * n);
+        RandBLAS::column_id(layout, m, n, A_layout.data(), lda, k, J.data(), X.data(), ldx, RNGState<>(48));
+        T err = id_error(layout, m, n, k, A.data(), J.data(), X.data(), ldx);
+        return err / blas::nrm2(m * n, A.data(), 1);
+    }
+
+    // An m-by-n sparse matrix of rank r, whose columns are multiples of r sparse columns.
+    template <typename SpMat>
+    static void check_sparse(Layout layout, int64_t n) {
+        using T = typename SpMat::scalar_t;
+        using sint_t = typename SpMat::index_t;
+        int64_t m = 90, r = 5;
+        std::vector<T> base(m * r, (T) 0.0);
+        for (int64_t j = 0; j < r; ++j)
+            for (int64_t i = j; i < m; i += 7)
+                base[i + j * m] = (T) 1.0 + (T) ((i + 3 * j) % 5);
+        std::vector<T> A(m * n);
+        for (int64_t j = 0; j < n; ++j)
+            blas::axpy(m, (T) (1 + j % 3), base.data() + (j % r) * m, 1, A.data() + j * m, 1);
+        SpMat A_sp(m, n);
+        if constexpr (std::is_same_v<SpMat, COOMatrix<T, sint_t>>) {
+            coo::dense_to_coo<T>(Layout::ColMajor, A.data(), 0.0, A_sp);
+        } else if constexpr (std::is_same_v<SpMat, CSRMatrix<T, sint_t>>) {
+            csr::dense_to_csr<T>(Layout::ColMajor, A.data(), 0.0, A_sp);
+        } else {
+            csc::dense_to_csc<T>(Layout::ColMajor, A.data(), 0.0, A_sp);
+        }
+        int64_t ldx = (layout == Layout::ColMajor) ? r : n;
+        std::vector<int64_t> J(r);
+        std::vector<T> X(r * n);
+        int64_t k = r;
+        RandBLAS::column_id(layout, A_sp, k, J.data(), X.data(), ldx, RNGState<>(43));
+        EXPECT_EQ(k, r);
+        T err = id_error(layout, m, n, k, A.data(), J.data(), X.data(), ldx);
+        EXPECT_LT(err, 1e-10 * blas::nrm2(m * n, A.data(), 1));
+    }
+};
+
+TEST_F(TestColumnID, dense_exact_low_rank) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        // More than 256 columns, so the pass over A has more than one block.
+        check_dense<double>(layout, 80, 300, 6, 6, 0.0, 1e-10);
+        check_dense<float>(layout, 60, 40, 4, 4, 0.0f, 1e-4f);
+    }
+}
+
+TEST_F(TestColumnID, dense_noisy_low_rank) {
+    // The error of the best rank-k approximation is about noise * sqrt(m n).
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor})
+        check_dense<double>(layout, 100, 80, 8, 8, 1e-6, 1e-4);
+}
+
+TEST_F(TestColumnID, sparse_exact_low_rank) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        check_sparse<COOMatrix<double>>(layout, 70);
+        check_sparse<CSRMatrix<double>>(layout, 70);
+        check_sparse<CSCMatrix<double>>(layout, 70);
+    }
+}
+
+TEST_F(TestColumnID, sparse_more_than_one_block) {
+    // More than 256 columns, which is more than one block for the dense overload.
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        check_sparse<COOMatrix<double>>(layout, 300);
+        check_sparse<CSRMatrix<double>>(layout, 300);
+        check_sparse<CSCMatrix<double>>(layout, 300);
+    }
+}
+
+TEST_F(TestColumnID, decaying_spectrum) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        int64_t k;
+        // Singular values down to 1e-8 are all resolved in double precision, and
+        // the error doesn't grow with the condition number of the selected columns.
+        double err_d = decaying_error<double>(layout, 300, 200, 30, 1e-8, k);
+        EXPECT_EQ(k, 30);
+        EXPECT_LT(err_d, 1e-12);
+        // Same in single precision, with singular values down to 1e-4.
+        float err_f = decaying_error<float>(layout, 300, 200, 30, 1e-4f, k);
+        EXPECT_EQ(k, 30);
+        EXPECT_LT(err_f, 1e-5f);
+        // Down to 1e-6, the sketch runs out of rank before the last singular
+        // values, so fewer columns are selected, and they still capture A.
+        err_f = decaying_error<float>(layout, 300, 200, 30, 1e-6f, k);
+        EXPECT_LT(k, 30);
+        EXPECT_LT(err_f, 1e-4f);
+    }
+}
+
+TEST_F(TestColumnID, stops_at_numerical_rank) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        int64_t m = 60, n = 50, r = 4;
+        std::vector<double> A = make_low_rank<double>(m, n, r, 0.0, 49);
+        std::vector<double> A_layout(A);
+        int64_t lda = m;
+        if (layout == Layout::RowMajor) {
+            lda = n;
+            RandBLAS::util::omatcopy(m, n, A.data(), 1, m, A_layout.data(), n, 1);
+        }
+        int64_t k = 10;
+        int64_t ldx = (layout == Layout::ColMajor) ? k : n;
+        std::vector<int64_t> J(k);
+        std::vector<double> X(k * n);
+        RandBLAS::column_id(layout, m, n, A_layout.data(), lda, k, J.data(), X.data(), ldx, RNGState<>(50));
+        EXPECT_EQ(k, r);
+        double err = id_error(layout, m, n, k, A.data(), J.data(), X.data(), ldx);
+        EXPECT_LT(err, 1e-12 * blas::nrm2(m * n, A.data(), 1));
+    }
+}
+
+TEST_F(TestColumnID, invalid_rank_throws) {
+    std::vector<double> A(12, 1.0);
+    std::vector<int64_t> J(5);
+    std::vector<double> X(5 * 4);
+    int64_t k = 5;
+    EXPECT_THROW(
+        RandBLAS::column_id(Layout::ColMajor, 3, 4, A.data(), 3, k, J.data(), X.data(), 5, RNGState<>(0)),
+        RandBLAS::Error
+    );
+}
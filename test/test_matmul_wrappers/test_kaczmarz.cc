@@ -0,0 +1,100 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/kaczmarz.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::RNGState;
+using RandBLAS::ExecPolicy;
+using blas::Layout;
+using blas::Op;
+
+
+class TestBlockKaczmarz : public ::testing::Test
+{
+    protected:
+
+    // Run block Kaczmarz on a consistent m-by-n system A x = b with Gaussian A, and return
+    // ||x - x_true|| / ||x_true||.
+    template <typename T>
+    static T relative_error(Layout layout, int64_t m, int64_t n, int64_t block_size, int64_t num_iters, bool hogwild, const ExecPolicy &exec = {}) {
+        std::vector<T> A(m * n), x_true(n);
+        auto state = RandBLAS::fill_dense(DenseDist(m, n), A.data(), RNGState<>(51));
+        RandBLAS::fill_dense(DenseDist(n, 1), x_true.data(), state);
+        int64_t lda = (layout == Layout::ColMajor) ? m : n;
+        std::vector<T> b(m);
+        blas::gemv(layout, Op::NoTrans, m, n, (T) 1.0, A.data(), lda, x_true.data(), 1, (T) 0.0, b.data(), 1);
+        std::vector<T> x(n, (T) 0.0);
+        RNGState<> sampling_state(52);
+        auto next = RandBLAS::block_kaczmarz(layout, m, n, A.data(), lda, b.data(), x.data(), block_size, num_iters, sampling_state, hogwild, exec);
+        EXPECT_GT(next.counter.v[0], sampling_state.counter.v[0]);
+        blas::axpy(n, (T) -1.0, x_true.data(), 1, x.data(), 1);
+        return blas::nrm2(n, x.data(), 1) / blas::nrm2(n, x_true.data(), 1);
+    }
+};
+
+TEST_F(TestBlockKaczmarz, consistent_system_converges) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        EXPECT_LT(relative_error<double>(layout, 400, 20, 10, 200, false), 1e-8);
+        EXPECT_LT(relative_error<float>(layout, 300, 10, 8, 200, false), 1e-3f);
+    }
+}
+
+TEST_F(TestBlockKaczmarz, single_row_blocks) {
+    // Plain randomized Kaczmarz needs many more steps.
+    EXPECT_LT(relative_error<double>(Layout::ColMajor, 200, 10, 1, 3000, false), 1e-6);
+}
+
+TEST_F(TestBlockKaczmarz, blocks_with_repeated_rows) {
+    // With m = block_size, nearly every block has repeated indices.
+    EXPECT_LT(relative_error<double>(Layout::RowMajor, 12, 4, 12, 50, false), 1e-10);
+}
+
+TEST_F(TestBlockKaczmarz, hogwild_converges) {
+    for (int threads : {1, 4}) {
+        ExecPolicy exec{threads};
+        EXPECT_LT(relative_error<double>(Layout::ColMajor, 400, 20, 10, 400, true, exec), 1e-6);
+    }
+}
+
+TEST_F(TestBlockKaczmarz, hogwild_serial_matches_sequential) {
+    // With one worker, Hogwild steps run in order and see every earlier update.
+    double err_seq = relative_error<double>(Layout::RowMajor, 100, 8, 5, 30, false);
+    double err_hog = relative_error<double>(Layout::RowMajor, 100, 8, 5, 30, true, ExecPolicy{1});
+    EXPECT_NEAR(err_seq, err_hog, 1e-12);
+}
@@ -0,0 +1,150 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/util.hh"
+#include "RandBLAS/leverage.hh"
+
+#include "test/comparison.hh"
+#include "test/handrolled_lapack.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::RNGState;
+
+
+class TestLeverage : public ::testing::Test
+{
+    protected:
+
+    // A column-major m-by-n Gaussian matrix whose first num_heavy rows are scaled up by 100,
+    // so that those rows have leverage scores close to one.
+    template <typename T>
+    static std::vector<T> make_A(int64_t m, int64_t n, int64_t num_heavy, uint32_t key) {
+        std::vector<T> A(m * n);
+        RandBLAS::fill_dense(DenseDist(m, n), A.data(), RNGState<>(key));
+        for (int64_t i = 0; i < num_heavy; ++i)
+            blas::scal(n, (T) 100, A.data() + i, m);
+        return A;
+    }
+
+    template <typename T>
+    static std::vector<T> exact_leverage_scores(int64_t m, int64_t n, const std::vector<T> &A) {
+        std::vector<T> Q(A);
+        std::vector<T> R(2 * n * n);
+        hr_lapack::chol_qr(m, n, Q.data(), R.data(), 32, true);
+        std::vector<T> lev(m, (T) 0);
+        for (int64_t j = 0; j < n; ++j) {
+            for (int64_t i = 0; i < m; ++i)
+                lev[i] += Q[i + j * m] * Q[i + j * m];
+        }
+        return lev;
+    }
+
+    template <typename T>
+    static void check_ratios(const std::vector<T> &approx, const std::vector<T> &exact, T lo, T hi) {
+        for (size_t i = 0; i < exact.size(); ++i) {
+            ASSERT_GE(approx[i], lo * exact[i]) << "row " << i;
+            ASSERT_LE(approx[i], hi * exact[i]) << "row " << i;
+        }
+    }
+};
+
+TEST_F(TestLeverage, without_jl_projection) {
+    int64_t m = 2000, n = 10;
+    auto A = make_A<double>(m, n, 3, 0);
+    auto exact = exact_leverage_scores(m, n, A);
+    std::vector<double> lev(m);
+    // k >= n means we use R^{-1} itself, so the only error comes from the sparse sketch.
+    RandBLAS::approx_leverage_scores(blas::Layout::ColMajor, m, n, A.data(), m, lev.data(), RNGState<>(1), 8 * n, n);
+    check_ratios(lev, exact, 0.25, 4.0);
+    for (int64_t i = 0; i < 3; ++i)
+        EXPECT_GT(lev[i], 0.9);
+}
+
+TEST_F(TestLeverage, with_jl_projection) {
+    int64_t m = 3000, n = 40;
+    auto A = make_A<double>(m, n, 5, 2);
+    auto exact = exact_leverage_scores(m, n, A);
+    std::vector<double> lev(m);
+    auto next_state = RandBLAS::approx_leverage_scores(blas::Layout::ColMajor, m, n, A.data(), m, lev.data(), RNGState<>(3));
+    ASSERT_GT(next_state.counter.v[0], (uint32_t) 0);
+    double total_exact = std::accumulate(exact.begin(), exact.end(), 0.0);
+    double total = std::accumulate(lev.begin(), lev.end(), 0.0);
+    EXPECT_NEAR(total_exact, (double) n, 1e-8);
+    EXPECT_NEAR(total / total_exact, 1.0, 0.5);
+    for (int64_t i = 0; i < 5; ++i)
+        EXPECT_GT(lev[i], 0.3);
+    check_ratios(lev, exact, 0.05, 20.0);
+}
+
+TEST_F(TestLeverage, row_major_matches_col_major) {
+    int64_t m = 700, n = 12;
+    auto A = make_A<double>(m, n, 2, 4);
+    std::vector<double> A_rowmajor(m * n);
+    RandBLAS::util::omatcopy(m, n, A.data(), 1, m, A_rowmajor.data(), n, 1);
+    std::vector<double> lev_c(m), lev_r(m);
+    RandBLAS::approx_leverage_scores(blas::Layout::ColMajor, m, n, A.data(), m, lev_c.data(), RNGState<>(5));
+    RandBLAS::approx_leverage_scores(blas::Layout::RowMajor, m, n, A_rowmajor.data(), n, lev_r.data(), RNGState<>(5));
+    test::comparison::buffs_approx_equal(lev_r.data(), lev_c.data(), m,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-10, 1e-10
+    );
+}
+
+TEST_F(TestLeverage, feeds_row_sampling) {
+    int64_t m = 1000, n = 8, k = 50;
+    auto A = make_A<float>(m, n, 4, 6);
+    std::vector<float> lev(m);
+    auto state = RandBLAS::approx_leverage_scores(blas::Layout::ColMajor, m, n, A.data(), m, lev.data(), RNGState<>(7));
+    RandBLAS::weights_to_cdf(m, lev.data());
+    std::vector<int64_t> samples(k);
+    RandBLAS::sample_indices_iid(m, lev.data(), k, samples.data(), state);
+    // The four heavy rows carry about half of the total leverage.
+    int64_t num_heavy_samples = 0;
+    for (auto s : samples)
+        num_heavy_samples += (s < 4) ? 1 : 0;
+    EXPECT_GT(num_heavy_samples, 10);
+}
+
+TEST_F(TestLeverage, rank_deficient_is_rejected) {
+    int64_t m = 100, n = 4;
+    auto A = make_A<double>(m, n, 0, 8);
+    blas::copy(m, A.data(), 1, A.data() + 3 * m, 1);
+    std::vector<double> lev(m);
+    EXPECT_THROW(
+        RandBLAS::approx_leverage_scores(blas::Layout::ColMajor, m, n, A.data(), m, lev.data(), RNGState<>(9)),
+        RandBLAS::Error
+    );
+}
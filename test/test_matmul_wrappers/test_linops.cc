@@ -0,0 +1,243 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/linops.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using RandBLAS::ProductOperator;
+using RandBLAS::ProductOrder;
+using RandBLAS::CallbackOperator;
+
+
+class TestLinops : public ::testing::Test
+{
+    protected:
+
+    template <typename T>
+    static std::vector<T> make_matrix(int64_t len, int64_t salt) {
+        std::vector<T> A(len);
+        for (int64_t i = 0; i < len; ++i)
+            A[i] = (T) ((i * 31 + salt * 7) % 19) / (T) 9 - (T) 1;
+        return A;
+    }
+
+    // Sketch op(F1) * op(F2) from the left and from the right through a ProductOperator, and
+    // compare to sketch_general on the explicitly formed product.
+    template <typename T, typename SKOP>
+    static void check_product(
+        SKOP &S, blas::Layout layout_F, blas::Layout layout, blas::Op op1, blas::Op op2,
+        int64_t rows_A, int64_t inner, int64_t cols_A, ProductOrder order
+    ) {
+        auto [rows_F1, cols_F1] = RandBLAS::dims_before_op(rows_A, inner, op1);
+        auto [rows_F2, cols_F2] = RandBLAS::dims_before_op(inner, cols_A, op2);
+        bool colmajor_F = layout_F == blas::Layout::ColMajor;
+        int64_t ld1 = (colmajor_F) ? rows_F1 + 1 : cols_F1 + 1;
+        int64_t ld2 = (colmajor_F) ? rows_F2 : cols_F2;
+        auto F1 = make_matrix<T>(ld1 * ((colmajor_F) ? cols_F1 : rows_F1), 1);
+        auto F2 = make_matrix<T>(ld2 * ((colmajor_F) ? cols_F2 : rows_F2), 2);
+        ProductOperator<T> A(rows_A, cols_A, inner, layout_F, op1, F1.data(), ld1, op2, F2.data(), ld2, order);
+
+        // The explicit product, stored in "layout".
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A : cols_A;
+        std::vector<T> A_explicit(rows_A * cols_A);
+        blas::gemm(layout_F, op1, op2, rows_A, cols_A, inner, (T) 1.0, F1.data(), ld1, F2.data(), ld2, (T) 0.0,
+            A_explicit.data(), (colmajor_F) ? rows_A : cols_A);
+        if (layout_F != layout) {
+            std::vector<T> tmp(A_explicit);
+            auto [irs_in, ics_in] = RandBLAS::layout_to_strides(layout_F, rows_A, cols_A);
+            auto [irs_out, ics_out] = RandBLAS::layout_to_strides(layout, rows_A, cols_A);
+            RandBLAS::util::omatcopy(rows_A, cols_A, tmp.data(), irs_in, ics_in, A_explicit.data(), irs_out, ics_out);
+        }
+        T tol = 100 * std::numeric_limits<T>::epsilon() * (rows_A + cols_A + inner);
+
+        for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+            auto [m, n] = RandBLAS::dims_before_op(rows_A, cols_A, opA);
+            // Left: op(submat(S)) is d-by-m, starting at S[1, 2].
+            int64_t d = 4;
+            int64_t ldb = (layout == blas::Layout::ColMajor) ? d : n;
+            std::vector<T> B_actual(d * n, (T) 1), B_expect(d * n, (T) 1);
+            RandBLAS::sketch_general(layout, blas::Op::NoTrans, opA, d, n, m, (T) 1.5, S, 1, 2, A,
+                (T) -0.5, B_actual.data(), ldb);
+            RandBLAS::sketch_general(layout, blas::Op::NoTrans, opA, d, n, m, (T) 1.5, S, 1, 2, A_explicit.data(), lda,
+                (T) -0.5, B_expect.data(), ldb);
+            test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+                __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+            );
+            // Right: op(submat(S)) is n-by-d, with S transposed.
+            ldb = (layout == blas::Layout::ColMajor) ? m : d;
+            std::vector<T> C_actual(m * d, (T) 1), C_expect(m * d, (T) 1);
+            RandBLAS::sketch_general(layout, opA, blas::Op::Trans, m, d, n, (T) 0.5, A, S, 2, 1,
+                (T) 2.0, C_actual.data(), ldb);
+            RandBLAS::sketch_general(layout, opA, blas::Op::Trans, m, d, n, (T) 0.5, A_explicit.data(), lda, S, 2, 1,
+                (T) 2.0, C_expect.data(), ldb);
+            test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), m * d,
+                __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+            );
+        }
+    }
+
+    template <typename T, typename SKOP>
+    static void check_all_modes(SKOP &S) {
+        for (auto layout_F : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+            for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+                for (auto order : {ProductOrder::Auto, ProductOrder::Sequential, ProductOrder::FormFirst}) {
+                    check_product<T>(S, layout_F, layout, blas::Op::NoTrans, blas::Op::NoTrans, 9, 5, 11, order);
+                    check_product<T>(S, layout_F, layout, blas::Op::Trans, blas::Op::NoTrans, 9, 13, 11, order);
+                    check_product<T>(S, layout_F, layout, blas::Op::NoTrans, blas::Op::Trans, 11, 3, 9, order);
+                }
+            }
+        }
+    }
+};
+
+TEST_F(TestLinops, product_dense_filled) {
+    DenseSkOp<double> S(DenseDist(20, 20), RNGState<>(0));
+    RandBLAS::fill_dense(S);
+    check_all_modes<double>(S);
+    DenseSkOp<float> Sf(DenseDist(20, 20, RandBLAS::ScalarDist::Uniform), RNGState<>(1));
+    RandBLAS::fill_dense(Sf);
+    check_all_modes<float>(Sf);
+}
+
+TEST_F(TestLinops, product_dense_unfilled) {
+    DenseSkOp<double> S(DenseDist(20, 20), RNGState<>(2));
+    check_all_modes<double>(S);
+    EXPECT_EQ(S.buff, nullptr);
+}
+
+TEST_F(TestLinops, product_sparse) {
+    SparseSkOp<double> S(SparseDist(20, 20, 3, RandBLAS::Axis::Short), RNGState<>(3));
+    check_all_modes<double>(S);
+    RandBLAS::fill_sparse(S);
+    check_all_modes<double>(S);
+}
+
+TEST_F(TestLinops, product_sparse_many_panels) {
+    // Long enough that a SparseSkOp is densified in several panels.
+    int64_t d = 150, m = 20000, n = 4, inner = 3;
+    SparseSkOp<double> S(SparseDist(d, m, 4, RandBLAS::Axis::Short), RNGState<>(5));
+    auto F1 = make_matrix<double>(m * inner, 1);
+    auto F2 = make_matrix<double>(inner * n, 2);
+    auto NoTrans = blas::Op::NoTrans;
+    auto Trans = blas::Op::Trans;
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        bool colmajor = layout == blas::Layout::ColMajor;
+        ProductOperator<double> A(m, n, inner, layout, NoTrans, F1.data(), (colmajor) ? m : inner,
+            NoTrans, F2.data(), (colmajor) ? inner : n, ProductOrder::Sequential);
+        std::vector<double> A_explicit(m * n);
+        int64_t lda = (colmajor) ? m : n;
+        blas::gemm(layout, NoTrans, NoTrans, m, n, inner, 1.0, F1.data(), (colmajor) ? m : inner,
+            F2.data(), (colmajor) ? inner : n, 0.0, A_explicit.data(), lda);
+        double tol = 1e-12;
+        // Left: S * A is d-by-n.
+        int64_t ldb = (colmajor) ? d : n;
+        std::vector<double> B_actual(d * n, 1.0), B_expect(d * n, 1.0);
+        RandBLAS::sketch_general(layout, NoTrans, NoTrans, d, n, m, 2.0, S, A, 0.5, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, NoTrans, NoTrans, d, n, m, 2.0, S, A_explicit.data(), lda, 0.5, B_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+        // Right: A^T * S^T is n-by-d.
+        ldb = (colmajor) ? n : d;
+        std::vector<double> C_actual(n * d, 1.0), C_expect(n * d, 1.0);
+        RandBLAS::sketch_general(layout, Trans, Trans, n, d, m, 2.0, A, S, 0.5, C_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, Trans, Trans, n, d, m, 2.0, A_explicit.data(), lda, S, 0.5, C_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), n * d,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+}
+
+TEST_F(TestLinops, gram_operator) {
+    // A^T A for a 30-by-6 matrix A, sketched from the left with a 4-by-6 operator.
+    int64_t m = 30, n = 6, d = 4;
+    auto A = make_matrix<double>(m * n, 5);
+    ProductOperator<double> G(n, n, m, blas::Layout::ColMajor, blas::Op::Trans, A.data(), m, blas::Op::NoTrans, A.data(), m);
+    std::vector<double> G_explicit(n * n);
+    blas::gemm(blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans, n, n, m, 1.0, A.data(), m, A.data(), m, 0.0, G_explicit.data(), n);
+    DenseSkOp<double> S(DenseDist(d, n), RNGState<>(4));
+    std::vector<double> B_actual(d * n, 0.0), B_expect(d * n, 0.0);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, d, n, n, 1.0, S, G, 0.0, B_actual.data(), d);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, d, n, n, 1.0, S, G_explicit.data(), n, 0.0, B_expect.data(), d);
+    double tol = 1e-12 * m;
+    test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+    );
+}
+
+TEST_F(TestLinops, callback_operator) {
+    // A callback that applies a 7-by-5 dense matrix; the sketch should call it exactly once.
+    int64_t rows_A = 7, cols_A = 5, d = 3;
+    auto A = make_matrix<double>(rows_A * cols_A, 6);
+    int num_calls = 0;
+    CallbackOperator<double> L(rows_A, cols_A,
+        [&](blas::Layout layout, blas::Op opA, blas::Op opX, int64_t m, int64_t n, int64_t k,
+            double alpha, const double *X, int64_t ldx, double beta, double *C, int64_t ldc) {
+            ++num_calls;
+            // A is stored column-major; read in row-major order, the same buffer holds A^T.
+            if (layout == blas::Layout::RowMajor)
+                opA = (opA == blas::Op::NoTrans) ? blas::Op::Trans : blas::Op::NoTrans;
+            blas::gemm(layout, opA, opX, m, n, k, alpha, A.data(), rows_A, X, ldx, beta, C, ldc);
+        }
+    );
+    DenseSkOp<double> S(DenseDist(d, rows_A), RNGState<>(7));
+    std::vector<double> B_actual(d * cols_A, 0.0), B_expect(d * cols_A, 0.0);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, d, cols_A, rows_A, 1.0, S, L, 0.0, B_actual.data(), d);
+    RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, d, cols_A, rows_A, 1.0, S, A.data(), rows_A, 0.0, B_expect.data(), d);
+    EXPECT_EQ(num_calls, 1);
+    test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * cols_A,
+        __PRETTY_FUNCTION__, __FILE__, __LINE__, 1e-12, 1e-12
+    );
+}
+
+TEST_F(TestLinops, cost_model) {
+    // A thin sketch of B * C with a large inner dimension: (S B) C is far cheaper.
+    EXPECT_EQ(RandBLAS::resolve_product_order(ProductOrder::Auto, 1000, 50, 1000, 10), ProductOrder::Sequential);
+    // A wide block against a product with a large inner dimension: forming B * C first is cheaper.
+    EXPECT_EQ(RandBLAS::resolve_product_order(ProductOrder::Auto, 100, 10000, 100, 1000), ProductOrder::FormFirst);
+    EXPECT_EQ(RandBLAS::resolve_product_order(ProductOrder::Sequential, 100, 10000, 100, 1000), ProductOrder::Sequential);
+    EXPECT_EQ(RandBLAS::product_flops(ProductOrder::Sequential, 2, 3, 4, 5), 2 * 3 * 4 * 5 + 2 * 2 * 3 * 5);
+    EXPECT_EQ(RandBLAS::product_flops(ProductOrder::FormFirst, 2, 3, 4, 5), 2 * 2 * 3 * 4 + 2 * 2 * 4 * 5);
+    EXPECT_EQ(RandBLAS::product_flops(ProductOrder::Auto, 2, 3, 4, 5), 2 * 2 * 3 * 4 + 2 * 2 * 4 * 5);
+}
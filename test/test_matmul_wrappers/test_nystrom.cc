@@ -0,0 +1,198 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/nystrom.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::SparseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using namespace RandBLAS::sparse_data;
+using blas::Layout;
+using blas::Op;
+using blas::Uplo;
+
+
+class TestNystrom : public ::testing::Test
+{
+    protected:
+
+    // A column-major n-by-n PSD matrix G G^T, where G is n-by-r Gaussian.
+    template <typename T>
+    static std::vector<T> make_low_rank_psd(int64_t n, int64_t r, uint32_t key) {
+        std::vector<T> G(n * r);
+        RandBLAS::fill_dense(DenseDist(n, r), G.data(), RNGState<>(key));
+        std::vector<T> A(n * n);
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, n, n, r, (T) 1.0, G.data(), n, G.data(), n, (T) 0.0, A.data(), n);
+        return A;
+    }
+
+    // The symmetric tridiagonal matrix with 2 on the diagonal and -1 off it, which is positive definite.
+    template <typename T>
+    static std::vector<T> make_tridiagonal(int64_t n) {
+        std::vector<T> A(n * n, (T) 0.0);
+        for (int64_t i = 0; i < n; ++i) {
+            A[i + i * n] = (T) 2.0;
+            if (i + 1 < n) {
+                A[(i + 1) + i * n] = (T) -1.0;
+                A[i + (i + 1) * n] = (T) -1.0;
+            }
+        }
+        return A;
+    }
+
+    // Overwrite the strict triangle of mat(A) opposite to uplo with junk, so we can tell if
+    // it's read. Entry i + j * n of the buffer is mat(A)[i, j] if layout is ColMajor, and
+    // mat(A)[j, i] otherwise.
+    template <typename T>
+    static void spoil_other_triangle(Layout layout, Uplo uplo, int64_t n, T *A) {
+        for (int64_t j = 0; j < n; ++j) {
+            for (int64_t i = 0; i < n; ++i) {
+                bool in_upper = (layout == Layout::ColMajor) ? (i < j) : (i > j);
+                bool in_lower = (layout == Layout::ColMajor) ? (i > j) : (i < j);
+                if ((uplo == Uplo::Upper) ? in_lower : in_upper)
+                    A[i + j * n] = (T) 1e6;
+            }
+        }
+    }
+
+    // Return max_{ij} |(F F^T - A)_{ij}|, where A is column-major and F is in "layout".
+    template <typename T>
+    static T max_error(Layout layout, int64_t n, int64_t k, const T *F, int64_t ldf, const T *A) {
+        std::vector<T> FFt(n * n);
+        blas::gemm(Layout::ColMajor, (layout == Layout::ColMajor) ? Op::NoTrans : Op::Trans,
+            (layout == Layout::ColMajor) ? Op::Trans : Op::NoTrans, n, n, k, (T) 1.0, F, ldf, F, ldf, (T) 0.0, FFt.data(), n);
+        T err = 0;
+        for (int64_t i = 0; i < n * n; ++i)
+            err = std::max(err, std::abs(FFt[i] - A[i]));
+        return err;
+    }
+
+    template <typename T, typename SKOP>
+    static void check_low_rank_recovery(Layout layout, Uplo uplo, SKOP &S, int64_t n, int64_t k, int64_t r) {
+        std::vector<T> A = make_low_rank_psd<T>(n, r, 31);
+        std::vector<T> A_half(A);
+        spoil_other_triangle(layout, uplo, n, A_half.data());
+        int64_t ldf = (layout == Layout::ColMajor) ? n : k;
+        std::vector<T> F(n * k);
+        T nu = RandBLAS::nystrom_factor(layout, uplo, n, k, A_half.data(), n, S, F.data(), ldf);
+        T norm_A = blas::nrm2(n * n, A.data(), 1);
+        EXPECT_GT(nu, (T) 0.0);
+        EXPECT_LT(nu, 100 * std::numeric_limits<T>::epsilon() * norm_A * std::sqrt((T) n));
+        T err = max_error(layout, n, k, F.data(), ldf, A.data());
+        EXPECT_LT(err, std::sqrt(std::numeric_limits<T>::epsilon()) * norm_A);
+    }
+
+    template <typename SpMat>
+    static void check_sparse_matches_dense(Layout layout, Uplo uplo) {
+        using T = typename SpMat::scalar_t;
+        using sint_t = typename SpMat::index_t;
+        int64_t n = 30, k = 6;
+        std::vector<T> A = make_tridiagonal<T>(n);
+        // Keep one triangle of A, in column-major terms.
+        std::vector<T> A_tri(A);
+        for (int64_t j = 0; j < n; ++j)
+            for (int64_t i = 0; i < n; ++i)
+                if ((uplo == Uplo::Upper) ? (i > j) : (i < j))
+                    A_tri[i + j * n] = (T) 0.0;
+        SpMat A_sp(n, n);
+        if constexpr (std::is_same_v<SpMat, COOMatrix<T, sint_t>>) {
+            coo::dense_to_coo<T>(Layout::ColMajor, A_tri.data(), 0.0, A_sp);
+        } else if constexpr (std::is_same_v<SpMat, CSRMatrix<T, sint_t>>) {
+            csr::dense_to_csr<T>(Layout::ColMajor, A_tri.data(), 0.0, A_sp);
+        } else {
+            csc::dense_to_csc<T>(Layout::ColMajor, A_tri.data(), 0.0, A_sp);
+        }
+        int64_t ldf = (layout == Layout::ColMajor) ? n : k;
+        DenseSkOp<T> S(DenseDist(n, k), 32);
+        std::vector<T> F_expect(n * k);
+        T nu_expect = RandBLAS::nystrom_factor(layout, Uplo::Upper, n, k, A.data(), n, S, F_expect.data(), ldf);
+        std::vector<T> F_actual(n * k);
+        T nu_actual = RandBLAS::nystrom_factor(layout, A_sp, S, F_actual.data(), ldf);
+        T atol = 100 * std::numeric_limits<T>::epsilon();
+        EXPECT_NEAR(nu_actual, nu_expect, atol);
+        test::comparison::buffs_approx_equal(F_actual.data(), F_expect.data(), n * k, __PRETTY_FUNCTION__, __FILE__, __LINE__, atol, atol);
+    }
+};
+
+TEST_F(TestNystrom, dense_operator_recovers_low_rank) {
+    int64_t n = 40, k = 8, r = 5;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        for (auto uplo : {Uplo::Upper, Uplo::Lower}) {
+            DenseSkOp<double> S(DenseDist(n, k), 33);
+            check_low_rank_recovery<double>(layout, uplo, S, n, k, r);
+        }
+    }
+}
+
+TEST_F(TestNystrom, sparse_operator_recovers_low_rank) {
+    int64_t n = 50, k = 10, r = 4;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        SparseSkOp<double> S(SparseDist(n, k, 3), 34);
+        check_low_rank_recovery<double>(layout, Uplo::Lower, S, n, k, r);
+        SparseSkOp<double> S_long(SparseDist(n, k, 4, RandBLAS::Axis::Long), 35);
+        check_low_rank_recovery<double>(layout, Uplo::Upper, S_long, n, k, r);
+    }
+}
+
+TEST_F(TestNystrom, sparse_matrix_matches_dense) {
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        for (auto uplo : {Uplo::Upper, Uplo::Lower}) {
+            check_sparse_matches_dense<COOMatrix<double>>(layout, uplo);
+            check_sparse_matches_dense<CSRMatrix<double>>(layout, uplo);
+            check_sparse_matches_dense<CSCMatrix<double>>(layout, uplo);
+        }
+    }
+}
+
+TEST_F(TestNystrom, indefinite_matrix_throws) {
+    int64_t n = 10, k = 3;
+    std::vector<double> A(n * n, 0.0);
+    for (int64_t i = 0; i < n; ++i)
+        A[i + i * n] = -1.0;
+    DenseSkOp<double> S(DenseDist(n, k), 36);
+    std::vector<double> F(n * k);
+    EXPECT_THROW(
+        RandBLAS::nystrom_factor(Layout::ColMajor, Uplo::Upper, n, k, A.data(), n, S, F.data(), n),
+        RandBLAS::Error
+    );
+}
@@ -0,0 +1,160 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/gram.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::SparseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using blas::Layout;
+using blas::Op;
+
+
+class TestSketchCrossGram : public ::testing::Test
+{
+    protected:
+
+    // Compare sketch_cross_gram against two calls to sketch_general followed by GEMM.
+    // If keep_sketches is true then we also check the sketches that are written out.
+    template <typename T, typename SKOP>
+    static void check(
+        SKOP &S, int64_t ro_s, int64_t co_s, Layout layout, Op opS, Op opA, Op opB,
+        int64_t d, int64_t n_a, int64_t n_b, int64_t m, int64_t panel_rows, bool keep_sketches
+    ) {
+        bool colmajor = layout == Layout::ColMajor;
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n_a, opA);
+        int64_t lda = (colmajor) ? rows_A : cols_A;
+        std::vector<T> A(rows_A * cols_A);
+        RandBLAS::fill_dense(DenseDist(rows_A, cols_A), A.data(), RNGState<>(3));
+        auto [rows_B, cols_B] = RandBLAS::dims_before_op(m, n_b, opB);
+        int64_t ldb = (colmajor) ? rows_B : cols_B;
+        std::vector<T> B(rows_B * cols_B);
+        RandBLAS::fill_dense(DenseDist(rows_B, cols_B), B.data(), RNGState<>(4));
+
+        int64_t ldsa = (colmajor) ? d : n_a;
+        int64_t ldsb = (colmajor) ? d : n_b;
+        std::vector<T> SA_expect(d * n_a);
+        std::vector<T> SB_expect(d * n_b);
+        RandBLAS::sketch_general(layout, opS, opA, d, n_a, m, (T) 1.0, S, ro_s, co_s, A.data(), lda, (T) 0.0, SA_expect.data(), ldsa);
+        RandBLAS::sketch_general(layout, opS, opB, d, n_b, m, (T) 1.0, S, ro_s, co_s, B.data(), ldb, (T) 0.0, SB_expect.data(), ldsb);
+        int64_t ldc = (colmajor) ? n_a : n_b;
+        std::vector<T> C_expect(n_a * n_b);
+        for (int64_t i = 0; i < n_a * n_b; ++i)
+            C_expect[i] = (T) (i % 5);
+        std::vector<T> C_actual(C_expect);
+        blas::gemm(layout, Op::Trans, Op::NoTrans, n_a, n_b, d, (T) 0.5, SA_expect.data(), ldsa, SB_expect.data(), ldsb, (T) 2.0, C_expect.data(), ldc);
+
+        std::vector<T> SA_actual(d * n_a, (T) -1.0);
+        std::vector<T> SB_actual(d * n_b, (T) -1.0);
+        RandBLAS::sketch_cross_gram(
+            layout, opS, opA, opB, d, n_a, n_b, m, (T) 0.5, S, ro_s, co_s, A.data(), lda, B.data(), ldb,
+            (T) 2.0, C_actual.data(), ldc,
+            (keep_sketches) ? SA_actual.data() : nullptr, ldsa,
+            (keep_sketches) ? SB_actual.data() : nullptr, ldsb, panel_rows
+        );
+
+        T atol = 100 * (T) d * std::numeric_limits<T>::epsilon();
+        test::comparison::buffs_approx_equal(C_actual.data(), C_expect.data(), n_a * n_b, __PRETTY_FUNCTION__, __FILE__, __LINE__, atol, atol);
+        if (keep_sketches) {
+            atol = 100 * std::numeric_limits<T>::epsilon();
+            test::comparison::buffs_approx_equal(SA_actual.data(), SA_expect.data(), d * n_a, __PRETTY_FUNCTION__, __FILE__, __LINE__, atol, atol);
+            test::comparison::buffs_approx_equal(SB_actual.data(), SB_expect.data(), d * n_b, __PRETTY_FUNCTION__, __FILE__, __LINE__, atol, atol);
+        }
+    }
+};
+
+TEST_F(TestSketchCrossGram, dense_operator_all_options) {
+    int64_t d = 29, n_a = 5, n_b = 7, m = 40;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        for (auto opS : {Op::NoTrans, Op::Trans}) {
+            for (auto opA : {Op::NoTrans, Op::Trans}) {
+                for (auto opB : {Op::NoTrans, Op::Trans}) {
+                    auto [rows_S, cols_S] = RandBLAS::dims_before_op(d, m, opS);
+                    DenseSkOp<double> S(DenseDist(rows_S, cols_S), 21);
+                    RandBLAS::fill_dense(S);
+                    for (int64_t panel_rows : {1, 8, 29, 0}) {
+                        check<double>(S, 0, 0, layout, opS, opA, opB, d, n_a, n_b, m, panel_rows, false);
+                        check<double>(S, 0, 0, layout, opS, opA, opB, d, n_a, n_b, m, panel_rows, true);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TestSketchCrossGram, unfilled_dense_operator_submatrix) {
+    // Panels of an unfilled operator are generated on the fly, and S stays unfilled.
+    int64_t d = 18, n_a = 4, n_b = 3, m = 25;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        DenseSkOp<float> S(DenseDist(d + 3, m + 2), 22);
+        check<float>(S, 2, 1, layout, Op::NoTrans, Op::NoTrans, Op::Trans, d, n_a, n_b, m, 5, true);
+        DenseSkOp<float> St(DenseDist(m + 2, d + 3), 23);
+        check<float>(St, 1, 3, layout, Op::Trans, Op::Trans, Op::NoTrans, d, n_a, n_b, m, 7, false);
+        EXPECT_EQ(S.buff, nullptr);
+        EXPECT_EQ(St.buff, nullptr);
+    }
+}
+
+TEST_F(TestSketchCrossGram, sparse_operator) {
+    int64_t d = 20, n_a = 6, n_b = 4, m = 150;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        SparseSkOp<double> S(SparseDist(d, m, 4), 24);
+        RandBLAS::fill_sparse(S);
+        check<double>(S, 0, 0, layout, Op::NoTrans, Op::NoTrans, Op::NoTrans, d, n_a, n_b, m, 6, true);
+        SparseSkOp<double> S_long(SparseDist(d + 2, m, 3, RandBLAS::Axis::Long), 25);
+        check<double>(S_long, 1, 0, layout, Op::NoTrans, Op::Trans, Op::NoTrans, d, n_a, n_b, m, 0, false);
+        SparseSkOp<double> St(SparseDist(m, d, 2), 26);
+        check<double>(St, 0, 0, layout, Op::Trans, Op::NoTrans, Op::Trans, d, n_a, n_b, m, 3, true);
+    }
+}
+
+TEST_F(TestSketchCrossGram, empty_sketch_scales_C) {
+    int64_t n_a = 3, n_b = 2;
+    DenseSkOp<double> S(DenseDist(1, 4), 0);
+    std::vector<double> A(4 * n_a, 1.0);
+    std::vector<double> B(4 * n_b, 1.0);
+    std::vector<double> C(n_a * n_b, 2.0);
+    RandBLAS::sketch_cross_gram(Layout::ColMajor, Op::NoTrans, Op::NoTrans, Op::NoTrans, 0, n_a, n_b, 4, 1.0, S, 0, 0,
+        A.data(), 4, B.data(), 4, 0.5, C.data(), n_a);
+    for (auto c : C)
+        EXPECT_EQ(c, 1.0);
+}
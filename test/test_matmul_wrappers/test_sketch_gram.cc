@@ -0,0 +1,155 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/gram.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::SparseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using blas::Layout;
+using blas::Op;
+using blas::Uplo;
+
+
+class TestSketchGram : public ::testing::Test
+{
+    protected:
+
+    // Compare sketch_gram against sketch_general followed by GEMM, on the uplo triangle of G.
+    // The opposite triangle of G must be left alone.
+    template <typename T, typename SKOP>
+    static void check(
+        SKOP &S, int64_t ro_s, int64_t co_s, Layout layout, Uplo uplo, Op opS, Op opA,
+        int64_t d, int64_t n, int64_t m, int64_t panel_rows
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == Layout::ColMajor) ? rows_A : cols_A;
+        std::vector<T> A(rows_A * cols_A);
+        RandBLAS::fill_dense(DenseDist(rows_A, cols_A), A.data(), RNGState<>(3));
+
+        std::vector<T> B(d * n);
+        int64_t ldb = (layout == Layout::ColMajor) ? d : n;
+        RandBLAS::sketch_general(layout, opS, opA, d, n, m, (T) 1.0, S, ro_s, co_s, A.data(), lda, (T) 0.0, B.data(), ldb);
+        std::vector<T> G_expect(n * n);
+        for (int64_t i = 0; i < n * n; ++i)
+            G_expect[i] = (T) (i % 7);
+        std::vector<T> G_actual(G_expect);
+        blas::gemm(layout, Op::Trans, Op::NoTrans, n, n, d, (T) 0.5, B.data(), ldb, B.data(), ldb, (T) 2.0, G_expect.data(), n);
+
+        RandBLAS::sketch_gram(layout, uplo, opS, opA, d, n, m, (T) 0.5, S, ro_s, co_s, A.data(), lda, (T) 2.0, G_actual.data(), n, panel_rows);
+
+        T tol = 100 * (T) d * std::numeric_limits<T>::epsilon();
+        for (int64_t i = 0; i < n; ++i) {
+            for (int64_t j = 0; j < n; ++j) {
+                // (i, j) is in the upper triangle in column-major terms when i <= j.
+                int64_t pos = i + j * n;
+                bool in_upper = (layout == Layout::ColMajor) ? (i <= j) : (i >= j);
+                bool in_triangle = (uplo == Uplo::Upper) ? in_upper : (i == j || !in_upper);
+                if (in_triangle) {
+                    EXPECT_NEAR(G_actual[pos], G_expect[pos], tol * (1 + std::abs(G_expect[pos])));
+                } else {
+                    EXPECT_EQ(G_actual[pos], (T) (pos % 7));
+                }
+            }
+        }
+    }
+};
+
+TEST_F(TestSketchGram, dense_operator_all_options) {
+    int64_t d = 37, n = 6, m = 50;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        for (auto uplo : {Uplo::Upper, Uplo::Lower}) {
+            for (auto opS : {Op::NoTrans, Op::Trans}) {
+                for (auto opA : {Op::NoTrans, Op::Trans}) {
+                    auto [rows_S, cols_S] = RandBLAS::dims_before_op(d, m, opS);
+                    DenseSkOp<double> S(DenseDist(rows_S, cols_S), 11);
+                    RandBLAS::fill_dense(S);
+                    for (int64_t panel_rows : {1, 8, 37, 0})
+                        check<double>(S, 0, 0, layout, uplo, opS, opA, d, n, m, panel_rows);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TestSketchGram, unfilled_dense_operator_submatrix) {
+    // Panels of an unfilled operator are generated on the fly.
+    int64_t d = 20, n = 5, m = 30;
+    DenseSkOp<float> S(DenseDist(d + 4, m + 3), 12);
+    for (auto opS : {Op::NoTrans, Op::Trans}) {
+        int64_t ro_s = 2, co_s = 1;
+        if (opS == Op::Trans) {
+            DenseSkOp<float> St(DenseDist(m + 3, d + 4), 13);
+            check<float>(St, co_s, ro_s, Layout::ColMajor, Uplo::Upper, opS, Op::NoTrans, d, n, m, 6);
+        } else {
+            check<float>(S, ro_s, co_s, Layout::ColMajor, Uplo::Upper, opS, Op::NoTrans, d, n, m, 6);
+        }
+    }
+    EXPECT_EQ(S.buff, nullptr);
+}
+
+TEST_F(TestSketchGram, sparse_operator) {
+    int64_t d = 24, n = 7, m = 200;
+    for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+        SparseSkOp<double> S(SparseDist(d, m, 4), 14);
+        RandBLAS::fill_sparse(S);
+        check<double>(S, 0, 0, layout, Uplo::Lower, Op::NoTrans, Op::NoTrans, d, n, m, 5);
+        SparseSkOp<double> S_long(SparseDist(d + 2, m, 3, RandBLAS::Axis::Long), 15);
+        check<double>(S_long, 1, 0, layout, Uplo::Upper, Op::NoTrans, Op::Trans, d, n, m, 10);
+        // An unfilled operator is sampled into a temporary, and a lazy one is filled in place.
+        EXPECT_LT(S_long.nnz, 0);
+        SparseSkOp<double> S_lazy(SparseDist(d, m, 4), 16);
+        RandBLAS::enable_lazy_fill(S_lazy);
+        check<double>(S_lazy, 0, 0, layout, Uplo::Upper, Op::NoTrans, Op::NoTrans, d, n, m, 5);
+        EXPECT_EQ(S_lazy.nnz, S_lazy.dist.full_nnz);
+    }
+}
+
+TEST_F(TestSketchGram, empty_sketch_scales_G) {
+    int64_t n = 3;
+    DenseSkOp<double> S(DenseDist(1, 4), 0);
+    std::vector<double> A(4 * n, 1.0);
+    std::vector<double> G(n * n, 2.0);
+    RandBLAS::sketch_gram(Layout::ColMajor, Uplo::Upper, Op::NoTrans, Op::NoTrans, 0, n, 4, 1.0, S, 0, 0, A.data(), 4, 0.5, G.data(), n);
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t i = 0; i <= j; ++i)
+            EXPECT_EQ(G[i + j * n], 1.0);
+}
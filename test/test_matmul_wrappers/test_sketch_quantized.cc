@@ -0,0 +1,148 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/quantized.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using RandBLAS::ScaleAxis;
+
+
+class TestSketchQuantized : public ::testing::Test
+{
+    protected:
+
+    // Compare sketch_quantized against sketch_general applied to the dequantized matrix.
+    template <typename T, typename Q, typename SKOP>
+    static void check(
+        SKOP &S, blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+        int64_t ro_s, int64_t co_s, ScaleAxis scale_axis
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A + 3 : cols_A + 3;
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? d : n;
+        int64_t len_A = (layout == blas::Layout::ColMajor) ? lda * cols_A : lda * rows_A;
+        std::vector<Q> A(len_A);
+        for (int64_t i = 0; i < len_A; ++i)
+            A[i] = (Q) ((i * 37 + 11) % 256);
+        int64_t num_scales = (scale_axis == ScaleAxis::Rows) ? rows_A : cols_A;
+        std::vector<T> scales(num_scales);
+        for (int64_t i = 0; i < num_scales; ++i)
+            scales[i] = (T) 0.01 * (T) (1 + i % 7);
+        std::vector<T> A_deq(len_A, (T) 0);
+        auto [a_row, a_col] = RandBLAS::layout_to_strides(layout, lda);
+        for (int64_t i = 0; i < rows_A; ++i) {
+            for (int64_t j = 0; j < cols_A; ++j) {
+                int64_t idx = i * a_row + j * a_col;
+                A_deq[idx] = scales[(scale_axis == ScaleAxis::Rows) ? i : j] * (T) A[idx];
+            }
+        }
+        std::vector<T> B_actual(d * n, (T) 1), B_expect(d * n, (T) 1);
+        T alpha = (T) 1.5, beta = (T) 0.5;
+        RandBLAS::sketch_quantized(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A.data(), lda,
+            scales.data(), scale_axis, beta, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, A_deq.data(), lda,
+            beta, B_expect.data(), ldb);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * m;
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    template <typename T, typename Q, typename SKOP>
+    static void check_all_modes(SKOP &S, int64_t d, int64_t n, int64_t m) {
+        for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+            for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+                for (auto axis : {ScaleAxis::Rows, ScaleAxis::Cols}) {
+                    check<T, Q>(S, layout, blas::Op::NoTrans, opA, d, n, m, 0, 0, axis);
+                }
+            }
+        }
+    }
+};
+
+TEST_F(TestSketchQuantized, dense_small) {
+    DenseSkOp<double> S(DenseDist(4, 9), RNGState<>(0));
+    RandBLAS::fill_dense(S);
+    check_all_modes<double, int8_t>(S, 4, 6, 9);
+    check_all_modes<double, uint8_t>(S, 4, 6, 9);
+}
+
+TEST_F(TestSketchQuantized, dense_many_panels) {
+    // n = 300 and m = 1100 split op(A) into 2-by-2 panels.
+    DenseSkOp<double> S(DenseDist(5, 1100), RNGState<>(1));
+    RandBLAS::fill_dense(S);
+    check_all_modes<double, int8_t>(S, 5, 300, 1100);
+    DenseSkOp<float> Sf(DenseDist(5, 1100), RNGState<>(1));
+    RandBLAS::fill_dense(Sf);
+    check<float, uint8_t>(Sf, blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 5, 300, 1100, 0, 0, ScaleAxis::Rows);
+}
+
+TEST_F(TestSketchQuantized, dense_unfilled_submatrix_transposed) {
+    DenseSkOp<double> S(DenseDist(1200, 8), RNGState<>(2));
+    // op(submat(S)) is 6-by-1100, starting at S[50, 1].
+    check<double, int8_t>(S, blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans, 6, 40, 1100, 50, 1, ScaleAxis::Cols);
+    check<double, uint8_t>(S, blas::Layout::RowMajor, blas::Op::Trans, blas::Op::Trans, 6, 40, 1100, 50, 1, ScaleAxis::Rows);
+    EXPECT_EQ(S.buff, nullptr);
+}
+
+TEST_F(TestSketchQuantized, sparse) {
+    SparseSkOp<double> S(SparseDist(5, 1100, 3, RandBLAS::Axis::Short), RNGState<>(3));
+    RandBLAS::fill_sparse(S);
+    check_all_modes<double, int8_t>(S, 5, 300, 1100);
+    check_all_modes<double, uint8_t>(S, 5, 7, 1100);
+    SparseSkOp<double> S_unfilled(SparseDist(5, 1100, 3, RandBLAS::Axis::Short), RNGState<>(3));
+    check<double, int8_t>(S_unfilled, blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 4, 20, 1000, 1, 100, ScaleAxis::Rows);
+}
+
+TEST_F(TestSketchQuantized, empty_inner_dimension_scales_B) {
+    DenseSkOp<double> S(DenseDist(3, 4), RNGState<>(0));
+    std::vector<int8_t> A(1);
+    std::vector<double> scales(1, 1.0);
+    std::vector<double> B(6, 2.0);
+    RandBLAS::sketch_quantized(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 3, 2, 0,
+        1.0, S, 0, 0, A.data(), 1, scales.data(), ScaleAxis::Rows, 0.5, B.data(), 3);
+    for (double b : B)
+        EXPECT_EQ(b, 1.0);
+}
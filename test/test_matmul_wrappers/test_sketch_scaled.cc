@@ -0,0 +1,266 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS/config.h"
+#include "RandBLAS/base.hh"
+#include "RandBLAS/dense_skops.hh"
+#include "RandBLAS/sparse_skops.hh"
+#include "RandBLAS/skge.hh"
+#include "RandBLAS/sparse_data/coo_matrix.hh"
+#include "RandBLAS/sparse_data/sksp.hh"
+
+#include "test/comparison.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using RandBLAS::DenseDist;
+using RandBLAS::DenseSkOp;
+using RandBLAS::SparseDist;
+using RandBLAS::SparseSkOp;
+using RandBLAS::RNGState;
+using RandBLAS::sparse_data::COOMatrix;
+
+
+class TestSketchScaled : public ::testing::Test
+{
+    protected:
+
+    // A rows_A-by-cols_A matrix with every third entry zero, stored with leading dimension lda.
+    template <typename T>
+    static std::vector<T> make_A(blas::Layout layout, int64_t rows_A, int64_t cols_A, int64_t lda) {
+        int64_t len_A = (layout == blas::Layout::ColMajor) ? lda * cols_A : lda * rows_A;
+        std::vector<T> A(len_A, (T) 0);
+        auto [a_row, a_col] = RandBLAS::layout_to_strides(layout, lda);
+        for (int64_t i = 0; i < rows_A; ++i) {
+            for (int64_t j = 0; j < cols_A; ++j) {
+                int64_t k = i * cols_A + j;
+                A[i * a_row + j * a_col] = (k % 3 == 0) ? (T) 0 : (T) ((k * 29 + 7) % 17) / (T) 8 - (T) 1;
+            }
+        }
+        return A;
+    }
+
+    template <typename T>
+    static std::vector<T> make_D(int64_t len) {
+        std::vector<T> D(len);
+        for (int64_t i = 0; i < len; ++i)
+            D[i] = (T) 0.25 * (T) (1 + (i * 5) % 11) * ((i % 4 == 1) ? (T) -1 : (T) 1);
+        return D;
+    }
+
+    // Scale either the rows (scale_rows_of_opA = true) or the columns of op(A), in place.
+    template <typename T>
+    static void scale_opA(
+        blas::Layout layout, blas::Op opA, int64_t rows_A, int64_t cols_A, T *A, int64_t lda,
+        const T *D, bool scale_rows_of_opA
+    ) {
+        bool scale_rows_of_A = (scale_rows_of_opA == (opA == blas::Op::NoTrans));
+        auto [a_row, a_col] = RandBLAS::layout_to_strides(layout, lda);
+        for (int64_t i = 0; i < rows_A; ++i) {
+            for (int64_t j = 0; j < cols_A; ++j)
+                A[i * a_row + j * a_col] *= D[scale_rows_of_A ? i : j];
+        }
+    }
+
+    template <typename T, typename SKOP>
+    static void check_left(
+        SKOP &S, blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+        int64_t ro_s, int64_t co_s
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A + 2 : cols_A + 2;
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? d : n;
+        auto A = make_A<T>(layout, rows_A, cols_A, lda);
+        auto D = make_D<T>(m);
+        auto DA = A;
+        scale_opA(layout, opA, rows_A, cols_A, DA.data(), lda, D.data(), true);
+
+        std::vector<T> B_actual(d * n, (T) 1), B_expect(d * n, (T) 1);
+        T alpha = (T) 1.5, beta = (T) -0.5;
+        RandBLAS::sketch_general(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, D.data(), A.data(), lda,
+            beta, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opS, opA, d, n, m, alpha, S, ro_s, co_s, DA.data(), lda,
+            beta, B_expect.data(), ldb);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * m;
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    template <typename T, typename SKOP>
+    static void check_right(
+        SKOP &S, blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
+        int64_t ro_s, int64_t co_s
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A + 1 : cols_A + 1;
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? m : d;
+        auto A = make_A<T>(layout, rows_A, cols_A, lda);
+        auto D = make_D<T>(n);
+        auto AD = A;
+        scale_opA(layout, opA, rows_A, cols_A, AD.data(), lda, D.data(), false);
+
+        std::vector<T> B_actual(m * d, (T) 1), B_expect(m * d, (T) 1);
+        T alpha = (T) 0.75, beta = (T) 2.0;
+        RandBLAS::sketch_general(layout, opA, opS, m, d, n, alpha, A.data(), lda, D.data(), S, ro_s, co_s,
+            beta, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opA, opS, m, d, n, alpha, AD.data(), lda, S, ro_s, co_s,
+            beta, B_expect.data(), ldb);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * n;
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), m * d,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    // Compare sketch_sparse with a diagonal against sketch_general on an explicitly scaled dense copy.
+    template <typename T, typename SKOP>
+    static void check_sparse_data(
+        SKOP &S, blas::Layout layout, blas::Op opS, blas::Op opA, int64_t d, int64_t n, int64_t m,
+        int64_t ro_s, int64_t co_s
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A : cols_A;
+        auto A = make_A<T>(layout, rows_A, cols_A, lda);
+        COOMatrix<T> A_sp(rows_A, cols_A);
+        RandBLAS::sparse_data::coo::dense_to_coo(layout, A.data(), (T) 0, A_sp);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * (m + n);
+
+        // Left: B = op(submat(S)) * diag(D) * op(A).
+        auto D_left = make_D<T>(m);
+        auto DA = A;
+        scale_opA(layout, opA, rows_A, cols_A, DA.data(), lda, D_left.data(), true);
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? d : n;
+        std::vector<T> B_actual(d * n, (T) 1), B_expect(d * n, (T) 1);
+        RandBLAS::sketch_sparse(layout, opS, opA, d, n, m, (T) 1.0, S, ro_s, co_s, D_left.data(), A_sp,
+            (T) 0.5, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opS, opA, d, n, m, (T) 1.0, S, ro_s, co_s, DA.data(), lda,
+            (T) 0.5, B_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), d * n,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    template <typename T, typename SKOP>
+    static void check_sparse_data_right(
+        SKOP &S, blas::Layout layout, blas::Op opA, blas::Op opS, int64_t m, int64_t d, int64_t n,
+        int64_t ro_s, int64_t co_s
+    ) {
+        auto [rows_A, cols_A] = RandBLAS::dims_before_op(m, n, opA);
+        int64_t lda = (layout == blas::Layout::ColMajor) ? rows_A : cols_A;
+        auto A = make_A<T>(layout, rows_A, cols_A, lda);
+        COOMatrix<T> A_sp(rows_A, cols_A);
+        RandBLAS::sparse_data::coo::dense_to_coo(layout, A.data(), (T) 0, A_sp);
+        T tol = 100 * std::numeric_limits<T>::epsilon() * (m + n);
+
+        // Right: B = op(A) * diag(D) * op(submat(S)).
+        auto D_right = make_D<T>(n);
+        auto AD = A;
+        scale_opA(layout, opA, rows_A, cols_A, AD.data(), lda, D_right.data(), false);
+        int64_t ldb = (layout == blas::Layout::ColMajor) ? m : d;
+        std::vector<T> B_actual(m * d, (T) 1), B_expect(m * d, (T) 1);
+        RandBLAS::sketch_sparse(layout, opA, opS, m, d, n, (T) 2.0, A_sp, D_right.data(), S, ro_s, co_s,
+            (T) 0.0, B_actual.data(), ldb);
+        RandBLAS::sketch_general(layout, opA, opS, m, d, n, (T) 2.0, AD.data(), lda, S, ro_s, co_s,
+            (T) 0.0, B_expect.data(), ldb);
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), m * d,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    // S is assumed to be at least 30-by-30; op(submat(S)) starts at S[3, 2].
+    template <typename T, typename SKOP>
+    static void check_all_modes(SKOP &S) {
+        for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+            for (auto opS : {blas::Op::NoTrans, blas::Op::Trans}) {
+                for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+                    check_left<T>(S, layout, opS, opA, 7, 9, 20, 3, 2);
+                    check_right<T>(S, layout, opA, opS, 9, 7, 20, 3, 2);
+                }
+            }
+        }
+    }
+};
+
+TEST_F(TestSketchScaled, dense_filled) {
+    DenseSkOp<double> S(DenseDist(30, 30), RNGState<>(0));
+    RandBLAS::fill_dense(S);
+    check_all_modes<double>(S);
+    DenseSkOp<float> Sf(DenseDist(30, 40, RandBLAS::ScalarDist::Uniform), RNGState<>(1));
+    RandBLAS::fill_dense(Sf);
+    check_all_modes<float>(Sf);
+}
+
+TEST_F(TestSketchScaled, dense_unfilled) {
+    DenseSkOp<double> S(DenseDist(30, 30), RNGState<>(2));
+    check_all_modes<double>(S);
+    EXPECT_EQ(S.buff, nullptr);
+}
+
+TEST_F(TestSketchScaled, sparse_filled) {
+    SparseSkOp<double> S(SparseDist(30, 30, 4, RandBLAS::Axis::Short), RNGState<>(3));
+    RandBLAS::fill_sparse(S);
+    check_all_modes<double>(S);
+    SparseSkOp<double> S_long(SparseDist(30, 35, 2, RandBLAS::Axis::Long), RNGState<>(4));
+    RandBLAS::fill_sparse(S_long);
+    check_all_modes<double>(S_long);
+}
+
+TEST_F(TestSketchScaled, sparse_unfilled) {
+    SparseSkOp<double> S(SparseDist(30, 30, 4, RandBLAS::Axis::Short), RNGState<>(5));
+    check_all_modes<double>(S);
+}
+
+TEST_F(TestSketchScaled, sparse_data_dense_skop) {
+    DenseSkOp<double> S(DenseDist(30, 30), RNGState<>(6));
+    for (auto layout : {blas::Layout::ColMajor, blas::Layout::RowMajor}) {
+        for (auto opS : {blas::Op::NoTrans, blas::Op::Trans}) {
+            for (auto opA : {blas::Op::NoTrans, blas::Op::Trans}) {
+                check_sparse_data<double>(S, layout, opS, opA, 7, 9, 20, 3, 2);
+                check_sparse_data_right<double>(S, layout, opA, opS, 9, 7, 20, 3, 2);
+            }
+        }
+    }
+    RandBLAS::fill_dense(S);
+    check_sparse_data<double>(S, blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans, 7, 9, 20, 3, 2);
+    check_sparse_data_right<double>(S, blas::Layout::RowMajor, blas::Op::NoTrans, blas::Op::Trans, 9, 7, 20, 3, 2);
+}
+
+TEST_F(TestSketchScaled, null_diagonal_is_rejected) {
+    DenseSkOp<double> S(DenseDist(3, 4), RNGState<>(0));
+    std::vector<double> A(4 * 2, 1.0), B(3 * 2, 0.0);
+    const double *D = nullptr;
+    EXPECT_THROW(
+        RandBLAS::sketch_general(blas::Layout::ColMajor, blas::Op::NoTrans, blas::Op::NoTrans, 3, 2, 4,
+            1.0, S, 0, 0, D, A.data(), 4, 0.0, B.data(), 3),
+        RandBLAS::Error
+    );
+}
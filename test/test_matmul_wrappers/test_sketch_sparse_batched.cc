@@ -0,0 +1,164 @@
+// Copyright, 2024. See LICENSE for copyright holder information.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// (1) Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// (2) Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// (3) Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RandBLAS.hh"
+#include "test/comparison.hh"
+#include "test/test_datastructures/test_spmats/common.hh"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace RandBLAS;
+using namespace RandBLAS::sparse_data;
+using blas::Layout;
+using blas::Op;
+using test::test_datastructures::test_spmats::iid_sparsify_random_dense;
+
+
+class TestSketchSparseBatched : public ::testing::Test {
+    protected:
+
+    static inline int64_t batch_size = 3;
+
+    // Values of the b-th matrix in a batch, given the values of a base matrix.
+    template <typename T>
+    static T member_value(T base, int64_t b, int64_t ell) {
+        return base * (T) (b + 1) + (T) ((ell + b) % 4) / (T) 4;
+    }
+
+    // Check every member of a batch that shares the pattern of A0 against sketch_sparse.
+    template <typename T, typename SpMat, typename MultiSpMat>
+    static void check(SpMat &A0, MultiSpMat &A, Layout layout, Op opS, Op opA, bool left, bool fill_S) {
+        int64_t rows_A = A0.n_rows, cols_A = A0.n_cols, d = 5;
+        auto [rows_opA, cols_opA] = dims_before_op(rows_A, cols_A, opA);
+        // Left: B_b = op(S) * op(A_b), op(S) is d-by-rows_opA. Right: B_b = op(A_b) * op(S), op(S) is cols_opA-by-d.
+        int64_t m_out = (left) ? d : rows_opA;
+        int64_t n_out = (left) ? cols_opA : d;
+        auto [rows_S, cols_S] = (left) ? dims_before_op(d, rows_opA, opS) : dims_before_op(cols_opA, d, opS);
+        DenseSkOp<T> S(DenseDist(rows_S + 2, cols_S + 1), 17);
+        if (fill_S)
+            fill_dense(S);
+        int64_t ldb = (layout == Layout::ColMajor) ? m_out : n_out;
+        int64_t strideb = m_out * n_out + 3;
+        std::vector<T> B_actual(strideb * batch_size, (T) 1), B_expect(strideb * batch_size, (T) 1);
+        if (left) {
+            sketch_sparse_batched(layout, opS, opA, d, cols_opA, rows_opA, (T) 2, S, 1, 1, A, (T) 0.5, B_actual.data(), ldb, strideb);
+        } else {
+            sketch_sparse_batched(layout, opA, opS, rows_opA, d, cols_opA, (T) 2, A, S, 1, 1, (T) 0.5, B_actual.data(), ldb, strideb);
+        }
+        std::vector<T> vals_b(A0.nnz);
+        for (int64_t b = 0; b < batch_size; ++b) {
+            for (int64_t ell = 0; ell < A0.nnz; ++ell)
+                vals_b[ell] = A.vals[ell * batch_size + b];
+            T *B_b = B_expect.data() + b * strideb;
+            if constexpr (std::is_same_v<SpMat, CSRMatrix<T>>) {
+                CSRMatrix<T> A_b(rows_A, cols_A, A0.nnz, vals_b.data(), A0.rowptr, A0.colidxs);
+                if (left) {
+                    sketch_sparse(layout, opS, opA, d, cols_opA, rows_opA, (T) 2, S, 1, 1, A_b, (T) 0.5, B_b, ldb);
+                } else {
+                    sketch_sparse(layout, opA, opS, rows_opA, d, cols_opA, (T) 2, A_b, S, 1, 1, (T) 0.5, B_b, ldb);
+                }
+            } else {
+                CSCMatrix<T> A_b(rows_A, cols_A, A0.nnz, vals_b.data(), A0.rowidxs, A0.colptr);
+                if (left) {
+                    sketch_sparse(layout, opS, opA, d, cols_opA, rows_opA, (T) 2, S, 1, 1, A_b, (T) 0.5, B_b, ldb);
+                } else {
+                    sketch_sparse(layout, opA, opS, rows_opA, d, cols_opA, (T) 2, A_b, S, 1, 1, (T) 0.5, B_b, ldb);
+                }
+            }
+        }
+        T tol = 100 * std::numeric_limits<T>::epsilon();
+        test::comparison::buffs_approx_equal(B_actual.data(), B_expect.data(), strideb * batch_size,
+            __PRETTY_FUNCTION__, __FILE__, __LINE__, tol, tol
+        );
+    }
+
+    template <typename T>
+    static void run_csr_and_csc(bool fill_S) {
+        int64_t rows_A = 23, cols_A = 17;
+        std::vector<T> dense(rows_A * cols_A);
+        RNGState s(4);
+        iid_sparsify_random_dense<T>(rows_A, cols_A, Layout::ColMajor, dense.data(), (T) 0.7, s);
+
+        CSRMatrix<T> A_csr(rows_A, cols_A);
+        csr::dense_to_csr<T>(Layout::ColMajor, dense.data(), 0.0, A_csr);
+        MultiCSRMatrix<T> M_csr(rows_A, cols_A, batch_size);
+        reserve_csr(A_csr.nnz, M_csr);
+        std::copy(A_csr.rowptr, A_csr.rowptr + rows_A + 1, M_csr.rowptr);
+        std::copy(A_csr.colidxs, A_csr.colidxs + A_csr.nnz, M_csr.colidxs);
+        for (int64_t ell = 0; ell < A_csr.nnz; ++ell)
+            for (int64_t b = 0; b < batch_size; ++b)
+                M_csr.vals[ell * batch_size + b] = member_value(A_csr.vals[ell], b, ell);
+
+        CSCMatrix<T> A_csc(rows_A, cols_A);
+        csc::dense_to_csc<T>(Layout::ColMajor, dense.data(), 0.0, A_csc);
+        MultiCSCMatrix<T> M_csc(rows_A, cols_A, batch_size);
+        reserve_csc(A_csc.nnz, M_csc);
+        std::copy(A_csc.colptr, A_csc.colptr + cols_A + 1, M_csc.colptr);
+        std::copy(A_csc.rowidxs, A_csc.rowidxs + A_csc.nnz, M_csc.rowidxs);
+        for (int64_t ell = 0; ell < A_csc.nnz; ++ell)
+            for (int64_t b = 0; b < batch_size; ++b)
+                M_csc.vals[ell * batch_size + b] = member_value(A_csc.vals[ell], b, ell);
+
+        for (auto layout : {Layout::ColMajor, Layout::RowMajor}) {
+            for (auto opS : {Op::NoTrans, Op::Trans}) {
+                for (auto opA : {Op::NoTrans, Op::Trans}) {
+                    for (bool left : {true, false}) {
+                        check<T>(A_csr, M_csr, layout, opS, opA, left, fill_S);
+                        check<T>(A_csc, M_csc, layout, opS, opA, left, fill_S);
+                    }
+                }
+            }
+        }
+    }
+};
+
+TEST_F(TestSketchSparseBatched, matches_sketch_sparse_double) {
+    run_csr_and_csc<double>(true);
+}
+
+TEST_F(TestSketchSparseBatched, matches_sketch_sparse_single) {
+    run_csr_and_csc<float>(true);
+}
+
+TEST_F(TestSketchSparseBatched, unfilled_operator) {
+    run_csr_and_csc<double>(false);
+}
+
+TEST_F(TestSketchSparseBatched, transpose_view_shares_data) {
+    MultiCSRMatrix<double> A(4, 6, 2);
+    reserve_csr(5, A);
+    auto At = multi::transpose(A);
+    EXPECT_EQ(At.n_rows, 6);
+    EXPECT_EQ(At.n_cols, 4);
+    EXPECT_EQ(At.batch_size, 2);
+    EXPECT_EQ(At.colptr, A.rowptr);
+    EXPECT_EQ(At.rowidxs, A.colidxs);
+    EXPECT_EQ(At.vals, A.vals);
+    EXPECT_FALSE(At.own_memory);
+}